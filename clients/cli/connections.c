@@ -16,6 +16,7 @@
 #include <readline/history.h>
 #include <fcntl.h>
 
+#include "nm-glib-aux/nm-io-utils.h"
 #include "nm-client-utils.h"
 #include "nm-vpn-helpers.h"
 #include "nm-meta-setting-access.h"
@@ -1190,11 +1191,18 @@ usage_connection_import (void)
 	g_printerr (_("Usage: nmcli connection import { ARGUMENTS | help }\n"
 	              "\n"
 	              "ARGUMENTS := [--temporary] type <type> file <file to import>\n"
+	              "ARGUMENTS := [--temporary] type batch [file <file to import>]\n"
 	              "\n"
 	              "Import an external/foreign configuration as a NetworkManager connection profile.\n"
 	              "The type of the input file is specified by type option.\n"
 	              "Only VPN configurations are supported at the moment. The configuration\n"
-	              "is imported by NetworkManager VPN plugins.\n\n"));
+	              "is imported by NetworkManager VPN plugins.\n"
+	              "\n"
+	              "With type \"batch\", many profiles are added at once. Every line of the\n"
+	              "file (or standard input, if no file or \"-\" is given) contains the\n"
+	              "properties of one profile, like for \"nmcli connection add\". Empty lines\n"
+	              "and lines starting with '#' are ignored. Either all profiles are added\n"
+	              "or none.\n\n"));
 }
 
 static void
@@ -8908,6 +8916,179 @@ do_connection_load (NmCli *nmc, int argc, char **argv)
 
 #define PROMPT_IMPORT_FILE N_("File to import: ")
 
+#define IMPORT_TYPE_BATCH "batch"
+
+static NMConnection *
+import_batch_read_connection (NmCli *nmc,
+                              const char *line,
+                              GHashTable *ids,
+                              GError **error)
+{
+	gs_unref_object NMConnection *connection = NULL;
+	gs_strfreev char **arg_arr = NULL;
+	NMSettingConnection *s_con;
+	gboolean success;
+	char **argv;
+	int argc;
+	guint i;
+
+	if (!g_shell_parse_argv (line, &argc, &arg_arr, error))
+		return NULL;
+
+	connection = nm_simple_connection_new ();
+	s_con = (NMSettingConnection *) nm_setting_connection_new ();
+	nm_connection_add_setting (connection, NM_SETTING (s_con));
+
+	/* every line has the same properties as "nmcli connection add" */
+	argv = arg_arr;
+	success = nmc_read_connection_properties (nmc, connection, &argc, &argv, error);
+	reset_options ();
+	if (!success)
+		return NULL;
+
+	if (!nm_setting_connection_get_id (s_con)) {
+		const char *ifname = nm_setting_connection_get_interface_name (s_con);
+		const char *type = nm_setting_connection_get_connection_type (s_con);
+		const char *slave_type = nm_setting_connection_get_slave_type (s_con);
+
+		if (type) {
+			gs_free char *try_name = NULL;
+			gs_free char *default_name = NULL;
+
+			try_name = ifname
+			           ? g_strdup_printf ("%s-%s", get_name_alias_toplevel (type, slave_type), ifname)
+			           : g_strdup (get_name_alias_toplevel (type, slave_type));
+
+			/* like nmc_unique_connection_name(), but also unique within the batch. */
+			default_name = g_strdup (try_name);
+			for (i = 1; g_hash_table_contains (ids, default_name); i++) {
+				g_free (default_name);
+				default_name = g_strdup_printf ("%s-%u", try_name, i);
+			}
+			g_object_set (s_con, NM_SETTING_CONNECTION_ID, default_name, NULL);
+		}
+	}
+
+	if (nm_setting_connection_get_id (s_con))
+		g_hash_table_add (ids, g_strdup (nm_setting_connection_get_id (s_con)));
+
+	set_default_interface_name (nmc, s_con);
+
+	if (!nm_connection_normalize (connection, NULL, NULL, error))
+		return NULL;
+
+	return g_steal_pointer (&connection);
+}
+
+static NMCResultCode
+do_connection_import_batch (NmCli *nmc,
+                            const char *filename,
+                            gboolean temporary)
+{
+	gs_free_error GError *error = NULL;
+	gs_unref_ptrarray GPtrArray *connections = NULL;
+	gs_unref_hashtable GHashTable *ids = NULL;
+	gs_unref_variant GVariant *ret = NULL;
+	gs_unref_variant GVariant *paths = NULL;
+	gs_free const char **lines = NULL;
+	gs_free char *contents = NULL;
+	const GPtrArray *client_connections;
+	GVariantBuilder builder;
+	gsize i;
+
+	if (!filename || nm_streq (filename, "-")) {
+		if (!nm_utils_fd_get_contents (STDIN_FILENO,
+		                               FALSE,
+		                               100 * 1024 * 1024,
+		                               NM_UTILS_FILE_GET_CONTENTS_FLAG_NONE,
+		                               &contents,
+		                               NULL,
+		                               NULL,
+		                               &error)) {
+			g_string_printf (nmc->return_text, _("Error: failed to read standard input: %s."),
+			                 error->message);
+			return NMC_RESULT_ERROR_UNKNOWN;
+		}
+	} else if (!g_file_get_contents (filename, &contents, NULL, &error)) {
+		g_string_printf (nmc->return_text, _("Error: failed to read '%s': %s."),
+		                 filename, error->message);
+		return NMC_RESULT_ERROR_UNKNOWN;
+	}
+
+	connections = g_ptr_array_new_with_free_func (g_object_unref);
+
+	/* the IDs of the existing profiles and of the profiles in the batch,
+	 * for choosing unique default names. */
+	ids = g_hash_table_new_full (nm_str_hash, g_str_equal, g_free, NULL);
+	client_connections = nm_client_get_connections (nmc->client);
+	for (i = 0; i < client_connections->len; i++) {
+		const char *id = nm_connection_get_id (client_connections->pdata[i]);
+
+		if (id)
+			g_hash_table_add (ids, g_strdup (id));
+	}
+
+	lines = nm_utils_strsplit_set_with_empty (contents, "\n");
+	for (i = 0; lines && lines[i]; i++) {
+		const char *line = nm_str_skip_leading_spaces (lines[i]);
+		NMConnection *connection;
+
+		if (NM_IN_SET (line[0], '\0', '#'))
+			continue;
+
+		connection = import_batch_read_connection (nmc, line, ids, &error);
+		if (!connection) {
+			g_string_printf (nmc->return_text, _("Error: invalid profile on line %u: %s"),
+			                 (guint) (i + 1), error->message);
+			return NMC_RESULT_ERROR_USER_INPUT;
+		}
+		g_ptr_array_add (connections, connection);
+	}
+
+	if (connections->len == 0) {
+		g_string_printf (nmc->return_text, _("Error: no profiles to import."));
+		return NMC_RESULT_ERROR_USER_INPUT;
+	}
+
+	/* add all profiles with one request. The server authorizes them once
+	 * and either adds all of them or none. */
+	g_variant_builder_init (&builder, G_VARIANT_TYPE ("aa{sa{sv}}"));
+	for (i = 0; i < connections->len; i++) {
+		g_variant_builder_add_value (&builder,
+		                             nm_connection_to_dbus (connections->pdata[i],
+		                                                    NM_CONNECTION_SERIALIZE_ALL));
+	}
+
+	ret = nmc_dbus_call_sync (nmc,
+	                          NM_DBUS_PATH_SETTINGS,
+	                          NM_DBUS_INTERFACE_SETTINGS,
+	                          "AddConnections",
+	                          g_variant_new ("(aa{sa{sv}}u@a{sv})",
+	                                         &builder,
+	                                           temporary
+	                                         ? (guint32) NM_SETTINGS_ADD_CONNECTION2_FLAG_IN_MEMORY
+	                                         : (guint32) NM_SETTINGS_ADD_CONNECTION2_FLAG_TO_DISK,
+	                                         g_variant_new_array (G_VARIANT_TYPE ("{sv}"), NULL, 0)),
+	                          G_VARIANT_TYPE ("(aoa{sv})"),
+	                          &error);
+	if (!ret) {
+		g_string_printf (nmc->return_text, _("Error: failed to add connections: %s."),
+		                 nmc_error_get_simple_message (error));
+		return NMC_RESULT_ERROR_CON_ACTIVATION;
+	}
+
+	g_variant_get (ret, "(@aoa{sv})", &paths, NULL);
+	nm_assert (g_variant_n_children (paths) == connections->len);
+
+	for (i = 0; i < connections->len; i++) {
+		g_print (_("Connection '%s' (%s) successfully added.\n"),
+		         nm_connection_get_id (connections->pdata[i]),
+		         nm_connection_get_uuid (connections->pdata[i]));
+	}
+
+	return nmc->return_value;
+}
+
 static NMCResultCode
 do_connection_import (NmCli *nmc, int argc, char **argv)
 {
@@ -8961,7 +9142,7 @@ do_connection_import (NmCli *nmc, int argc, char **argv)
 
 			if (   argc == 1
 			    && nmc->complete) {
-				nmc_complete_strings (*argv, "wireguard");
+				nmc_complete_strings (*argv, "wireguard", IMPORT_TYPE_BATCH);
 				complete_option (nmc, (const NMMetaAbstractInfo *) nm_meta_property_info_vpn_service_type,
 				                 *argv,
 				                 NULL);
@@ -9000,6 +9181,8 @@ do_connection_import (NmCli *nmc, int argc, char **argv)
 		g_string_printf (nmc->return_text, _("Error: 'type' argument is required."));
 		return NMC_RESULT_ERROR_USER_INPUT;
 	}
+	if (nm_streq (type, IMPORT_TYPE_BATCH))
+		return do_connection_import_batch (nmc, filename, temporary);
 	if (!filename) {
 		g_string_printf (nmc->return_text, _("Error: 'file' argument is required."));
 		return NMC_RESULT_ERROR_USER_INPUT;
@@ -224,8 +224,12 @@ NM_GOBJECT_PROPERTIES_DEFINE (NMDevice,
 	PROP_RX_BYTES,
 	PROP_IP4_CONNECTIVITY,
 	PROP_IP6_CONNECTIVITY,
+	PROP_STATE_DURATIONS,
 );
 
+/* the device states are multiples of 10, from UNKNOWN (0) to FAILED (120). */
+#define STATE_IDX_N 13
+
 typedef struct _NMDevicePrivate {
 	bool in_state_changed;
 
@@ -234,6 +238,13 @@ typedef struct _NMDevicePrivate {
 
 	NMDeviceState state;
 	NMDeviceStateReason state_reason;
+
+	struct {
+		gint64 entered_ns;
+		guint32 last_duration_ms[STATE_IDX_N];
+		guint16 has_last_duration;
+	} state_trace;
+
 	struct {
 		guint id;
 
@@ -1247,6 +1258,33 @@ nm_device_sysctl_ip_conf_set (NMDevice *self,
 	                                       value);
 }
 
+/* Like nm_device_sysctl_ip_conf_set(), but only queue the write. Use this
+ * for settings whose result we don't care about, to not block the main
+ * loop when many devices are activated at once. */
+static void
+sysctl_ip_conf_set_batched (NMDevice *self,
+                            int addr_family,
+                            const char *property,
+                            const char *value)
+{
+	const char *ifname;
+
+	nm_assert_addr_family (addr_family);
+	nm_assert (value);
+
+	ifname = nm_device_get_ip_iface_from_platform (self);
+	if (!ifname)
+		return;
+
+	nm_platform_sysctl_ip_conf_set_batched (nm_device_get_platform (self),
+	                                        addr_family,
+	                                        ifname,
+	                                        property,
+	                                        value,
+	                                        NULL,
+	                                        NULL);
+}
+
 /*****************************************************************************/
 
 gboolean
@@ -5947,6 +5985,22 @@ nm_device_check_connection_compatible (NMDevice *self, NMConnection *connection,
 	return NM_DEVICE_GET_CLASS (self)->check_connection_compatible (self, connection, error);
 }
 
+/**
+ * nm_device_get_connection_type_check_compatible:
+ * @self: an #NMDevice
+ *
+ * Returns: the only connection type that nm_device_check_connection_compatible()
+ *   accepts for @self, or %NULL if the device type supports profiles of
+ *   several types.
+ */
+const char *
+nm_device_get_connection_type_check_compatible (NMDevice *self)
+{
+	g_return_val_if_fail (NM_IS_DEVICE (self), NULL);
+
+	return NM_DEVICE_GET_CLASS (self)->connection_type_check_compatible;
+}
+
 gboolean
 nm_device_check_slave_connection_compatible (NMDevice *self, NMConnection *slave)
 {
@@ -9917,11 +9971,13 @@ restore_ip6_properties (NMDevice *self)
 
 	g_hash_table_iter_init (&iter, priv->ip6_saved_properties);
 	while (g_hash_table_iter_next (&iter, &key, &value)) {
-		/* Don't touch "disable_ipv6" if we're doing userland IPv6LL */
-		if (   priv->ipv6ll_handle
-		    && nm_streq (key, "disable_ipv6"))
+		if (nm_streq (key, "disable_ipv6")) {
+			/* Don't touch "disable_ipv6" if we're doing userland IPv6LL */
+			if (!priv->ipv6ll_handle)
+				nm_device_sysctl_ip_conf_set (self, AF_INET6, key, value);
 			continue;
-		nm_device_sysctl_ip_conf_set (self, AF_INET6, key, value);
+		}
+		sysctl_ip_conf_set_batched (self, AF_INET6, key, value);
 	}
 }
 
@@ -15122,9 +15178,9 @@ ip6_managed_setup (NMDevice *self)
 {
 	set_nm_ipv6ll (self, TRUE);
 	set_disable_ipv6 (self, "1");
-	nm_device_sysctl_ip_conf_set (self, AF_INET6, "accept_ra", "0");
-	nm_device_sysctl_ip_conf_set (self, AF_INET6, "use_tempaddr", "0");
-	nm_device_sysctl_ip_conf_set (self, AF_INET6, "forwarding", "0");
+	sysctl_ip_conf_set_batched (self, AF_INET6, "accept_ra", "0");
+	sysctl_ip_conf_set_batched (self, AF_INET6, "use_tempaddr", "0");
+	sysctl_ip_conf_set_batched (self, AF_INET6, "forwarding", "0");
 }
 
 static void
@@ -15208,6 +15264,178 @@ deactivate_dispatcher_complete (NMDispatcherCallId *call_id, gpointer user_data)
 		deactivate_ready (self, reason);
 }
 
+/*****************************************************************************/
+
+/* Tracing of the time spent in each device state.
+ *
+ * For each device, we remember how long it stayed in each state the last time
+ * (exposed on D-Bus as "StateDurations"). Additionally, the durations are
+ * aggregated by NMManager into histograms per device type. With
+ * "logging.activation-trace-file" set, each state is also written as a complete
+ * event in Chrome's trace event format, which can be loaded into chrome://tracing
+ * or Perfetto. */
+
+static struct {
+	FILE *file;
+	bool initialized:1;
+} _state_trace_file;
+
+/* state transitions come in bursts. Flush the trace file once on idle. */
+static guint _state_trace_idle_id;
+
+static guint
+_state_idx (NMDeviceState state)
+{
+	nm_assert (state % 10 == 0 && state / 10 < STATE_IDX_N);
+	return NM_MIN ((guint) state / 10u, (guint) (STATE_IDX_N - 1));
+}
+
+static void
+_state_trace_json_append_str (GString *str, const char *s)
+{
+	g_string_append_c (str, '"');
+	for (; s && *s; s++) {
+		if (NM_IN_SET (*s, '"', '\\'))
+			g_string_append_printf (str, "\\%c", *s);
+		else if ((guchar) *s < 0x20)
+			g_string_append_printf (str, "\\u%04x", (guint) *s);
+		else
+			g_string_append_c (str, *s);
+	}
+	g_string_append_c (str, '"');
+}
+
+static FILE *
+_state_trace_file_get (void)
+{
+	gs_free char *filename = NULL;
+
+	if (G_LIKELY (_state_trace_file.initialized))
+		return _state_trace_file.file;
+
+	_state_trace_file.initialized = TRUE;
+
+	filename = nm_config_data_get_value (NM_CONFIG_GET_DATA_ORIG,
+	                                     NM_CONFIG_KEYFILE_GROUP_LOGGING,
+	                                     NM_CONFIG_KEYFILE_KEY_LOGGING_ACTIVATION_TRACE_FILE,
+	                                     NM_CONFIG_GET_VALUE_STRIP | NM_CONFIG_GET_VALUE_NO_EMPTY);
+	if (!filename)
+		return NULL;
+
+	_state_trace_file.file = fopen (filename, "we");
+	if (!_state_trace_file.file) {
+		int errsv = errno;
+
+		nm_log_warn (LOGD_DEVICE, "device: failed to open activation trace file \"%s\": %s",
+		             filename, nm_strerror_native (errsv));
+		return NULL;
+	}
+
+	/* the trace event format allows to omit the closing bracket. */
+	fputs ("[\n", _state_trace_file.file);
+	return _state_trace_file.file;
+}
+
+static void
+_state_trace_write (NMDevice *self,
+                    NMDeviceState state,
+                    NMDeviceStateReason reason,
+                    gint64 start_ns,
+                    gint64 duration_ns)
+{
+	nm_auto_free_gstring GString *str = NULL;
+	FILE *f;
+
+	f = _state_trace_file_get ();
+	if (!f)
+		return;
+
+	str = g_string_sized_new (256);
+	g_string_append (str, "{\"name\":");
+	_state_trace_json_append_str (str, nm_device_state_to_str (state));
+	g_string_append (str, ",\"cat\":");
+	_state_trace_json_append_str (str, nm_device_get_type_desc (self));
+	g_string_append_printf (str,
+	                        ",\"ph\":\"X\",\"ts\":%"G_GINT64_FORMAT",\"dur\":%"G_GINT64_FORMAT",\"pid\":%d,\"tid\":%d,\"args\":{\"iface\":",
+	                        start_ns / 1000,
+	                        duration_ns / 1000,
+	                        (int) getpid (),
+	                        nm_device_get_ifindex (self));
+	_state_trace_json_append_str (str, nm_device_get_iface (self));
+	g_string_append (str, ",\"reason\":");
+	_state_trace_json_append_str (str, nm_device_state_reason_to_str (reason));
+	g_string_append (str, "}},\n");
+
+	fputs (str->str, f);
+}
+
+static gboolean
+_state_trace_idle_cb (gpointer user_data)
+{
+	_state_trace_idle_id = 0;
+
+	if (_state_trace_file.file)
+		fflush (_state_trace_file.file);
+	return G_SOURCE_REMOVE;
+}
+
+static void
+_state_trace (NMDevice *self,
+              NMDeviceState old_state,
+              NMDeviceStateReason reason)
+{
+	NMDevicePrivate *priv = NM_DEVICE_GET_PRIVATE (self);
+	gint64 now_ns = nm_utils_get_monotonic_timestamp_ns ();
+	gint64 duration_ns;
+	guint32 duration_ms;
+	guint idx;
+
+	if (priv->state_trace.entered_ns > 0) {
+		duration_ns = now_ns - priv->state_trace.entered_ns;
+		duration_ms = (guint32) NM_MIN (duration_ns / NM_UTILS_NS_PER_MSEC, (gint64) G_MAXUINT32);
+		idx = _state_idx (old_state);
+
+		priv->state_trace.last_duration_ms[idx] = duration_ms;
+		priv->state_trace.has_last_duration |= (1u << idx);
+		_notify (self, PROP_STATE_DURATIONS);
+
+		nm_manager_device_state_duration_add (NM_MANAGER_GET,
+		                                      nm_device_get_device_type (self),
+		                                      old_state,
+		                                      duration_ms);
+
+		if (_state_trace_file_get ()) {
+			_state_trace_write (self, old_state, reason, priv->state_trace.entered_ns, duration_ns);
+			if (!_state_trace_idle_id)
+				_state_trace_idle_id = g_idle_add (_state_trace_idle_cb, NULL);
+		}
+	}
+
+	priv->state_trace.entered_ns = now_ns;
+}
+
+static GVariant *
+_state_durations_to_variant (NMDevice *self)
+{
+	NMDevicePrivate *priv = NM_DEVICE_GET_PRIVATE (self);
+	GVariantBuilder builder;
+	guint idx;
+
+	g_variant_builder_init (&builder, G_VARIANT_TYPE ("a(uu)"));
+	for (idx = 0; idx < STATE_IDX_N; idx++) {
+		if (!NM_FLAGS_ANY (priv->state_trace.has_last_duration, (1u << idx)))
+			continue;
+
+		g_variant_builder_add (&builder,
+		                       "(uu)",
+		                       (guint32) (idx * 10),
+		                       priv->state_trace.last_duration_ms[idx]);
+	}
+	return g_variant_builder_end (&builder);
+}
+
+/*****************************************************************************/
+
 static void
 _set_state_full (NMDevice *self,
                  NMDeviceState state,
@@ -15255,6 +15483,8 @@ _set_state_full (NMDevice *self,
 
 	priv->in_state_changed = TRUE;
 
+	_state_trace (self, old_state, reason);
+
 	priv->state = state;
 	priv->state_reason = reason;
 
@@ -17117,6 +17347,9 @@ get_property (GObject *object, guint prop_id,
 	case PROP_IP6_CONNECTIVITY:
 		g_value_set_uint (value, priv->concheck_x[0].state);
 		break;
+	case PROP_STATE_DURATIONS:
+		g_value_take_variant (value, _state_durations_to_variant (self));
+		break;
 	default:
 		G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
 		break;
@@ -17205,6 +17438,7 @@ static const NMDBusInterfaceInfoExtended interface_info_device = {
 			NM_DEFINE_DBUS_PROPERTY_INFO_EXTENDED_READABLE_L     ("Real",                 "b",      NM_DEVICE_REAL),
 			NM_DEFINE_DBUS_PROPERTY_INFO_EXTENDED_READABLE       ("Ip4Connectivity",      "u",      NM_DEVICE_IP4_CONNECTIVITY),
 			NM_DEFINE_DBUS_PROPERTY_INFO_EXTENDED_READABLE       ("Ip6Connectivity",      "u",      NM_DEVICE_IP6_CONNECTIVITY),
+			NM_DEFINE_DBUS_PROPERTY_INFO_EXTENDED_READABLE       ("StateDurations",       "a(uu)",  NM_DEVICE_STATE_DURATIONS),
 		),
 	),
 };
@@ -17488,6 +17722,12 @@ nm_device_class_init (NMDeviceClass *klass)
 	                        NM_CONNECTIVITY_UNKNOWN, NM_CONNECTIVITY_FULL, NM_CONNECTIVITY_UNKNOWN,
 	                        G_PARAM_READABLE |
 	                        G_PARAM_STATIC_STRINGS);
+	obj_properties[PROP_STATE_DURATIONS] =
+	     g_param_spec_variant (NM_DEVICE_STATE_DURATIONS, "", "",
+	                           G_VARIANT_TYPE ("a(uu)"),
+	                           NULL,
+	                           G_PARAM_READABLE |
+	                           G_PARAM_STATIC_STRINGS);
 
 	g_object_class_install_properties (object_class, _PROPERTY_ENUMS_LAST, obj_properties);
 
@@ -133,6 +133,8 @@ nm_device_state_reason_check (NMDeviceStateReason reason)
 #define NM_DEVICE_IP4_CONNECTIVITY           "ip4-connectivity"
 #define NM_DEVICE_IP6_CONNECTIVITY           "ip6-connectivity"
 
+#define NM_DEVICE_STATE_DURATIONS            "state-durations"
+
 #define NM_TYPE_DEVICE            (nm_device_get_type ())
 #define NM_DEVICE(obj)            (G_TYPE_CHECK_INSTANCE_CAST ((obj), NM_TYPE_DEVICE, NMDevice))
 #define NM_DEVICE_CLASS(klass)    (G_TYPE_CHECK_CLASS_CAST ((klass),  NM_TYPE_DEVICE, NMDeviceClass))
@@ -573,6 +575,8 @@ gboolean nm_device_check_connection_compatible (NMDevice *device,
                                                 NMConnection *connection,
                                                 GError **error);
 
+const char *nm_device_get_connection_type_check_compatible (NMDevice *self);
+
 gboolean nm_device_check_slave_connection_compatible (NMDevice *device, NMConnection *connection);
 
 gboolean nm_device_unmanage_on_quit (NMDevice *self);
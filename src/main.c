@@ -406,7 +406,26 @@ main (int argc, char *argv[])
 	if (!_dbus_manager_init (config))
 		goto done_no_manager;
 
-	nm_linux_platform_setup ();
+	{
+		gs_free char *cache_route_tables = NULL;
+		gs_free char *cache_route_protocols = NULL;
+
+		cache_route_tables = nm_config_data_get_value (NM_CONFIG_GET_DATA_ORIG,
+		                                               NM_CONFIG_KEYFILE_GROUP_MAIN,
+		                                               NM_CONFIG_KEYFILE_KEY_MAIN_CACHE_ROUTE_TABLES,
+		                                               NM_CONFIG_GET_VALUE_STRIP | NM_CONFIG_GET_VALUE_NO_EMPTY);
+		cache_route_protocols = nm_config_data_get_value (NM_CONFIG_GET_DATA_ORIG,
+		                                                  NM_CONFIG_KEYFILE_GROUP_MAIN,
+		                                                  NM_CONFIG_KEYFILE_KEY_MAIN_CACHE_ROUTE_PROTOCOLS,
+		                                                  NM_CONFIG_GET_VALUE_STRIP | NM_CONFIG_GET_VALUE_NO_EMPTY);
+		nm_linux_platform_setup_full (cache_route_tables, cache_route_protocols);
+
+		if (nm_config_data_get_value_boolean (NM_CONFIG_GET_DATA_ORIG,
+		                                      NM_CONFIG_KEYFILE_GROUP_MAIN,
+		                                      NM_CONFIG_KEYFILE_KEY_MAIN_SYSCTL_READ_CACHE,
+		                                      FALSE))
+			nm_linux_platform_set_sysctl_read_cache (NM_PLATFORM_GET, TRUE);
+	}
 
 	NM_UTILS_KEEP_ALIVE (config, nm_netns_get (), "NMConfig-depends-on-NMNetns");
 
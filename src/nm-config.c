@@ -761,7 +761,10 @@ static const ConfigGroup config_groups[] = {
 		.keys = NM_MAKE_STRV (
 			NM_CONFIG_KEYFILE_KEY_MAIN_ASSUME_IPV6LL_ONLY,
 			NM_CONFIG_KEYFILE_KEY_MAIN_AUTH_POLKIT,
+			NM_CONFIG_KEYFILE_KEY_MAIN_AUTOCONNECT_CONCURRENCY,
 			NM_CONFIG_KEYFILE_KEY_MAIN_AUTOCONNECT_RETRIES_DEFAULT,
+			NM_CONFIG_KEYFILE_KEY_MAIN_CACHE_ROUTE_PROTOCOLS,
+			NM_CONFIG_KEYFILE_KEY_MAIN_CACHE_ROUTE_TABLES,
 			NM_CONFIG_KEYFILE_KEY_MAIN_CONFIGURE_AND_QUIT,
 			NM_CONFIG_KEYFILE_KEY_MAIN_DEBUG,
 			NM_CONFIG_KEYFILE_KEY_MAIN_DHCP,
@@ -773,12 +776,15 @@ static const ConfigGroup config_groups[] = {
 			NM_CONFIG_KEYFILE_KEY_MAIN_PLUGINS,
 			NM_CONFIG_KEYFILE_KEY_MAIN_RC_MANAGER,
 			NM_CONFIG_KEYFILE_KEY_MAIN_SLAVES_ORDER,
+			NM_CONFIG_KEYFILE_KEY_MAIN_STATE_SNAPSHOT,
+			NM_CONFIG_KEYFILE_KEY_MAIN_SYSCTL_READ_CACHE,
 			NM_CONFIG_KEYFILE_KEY_MAIN_SYSTEMD_RESOLVED,
 		),
 	},
 	{
 		.group = NM_CONFIG_KEYFILE_GROUP_LOGGING,
 		.keys = NM_MAKE_STRV (
+			NM_CONFIG_KEYFILE_KEY_LOGGING_ACTIVATION_TRACE_FILE,
 			NM_CONFIG_KEYFILE_KEY_LOGGING_AUDIT,
 			NM_CONFIG_KEYFILE_KEY_LOGGING_BACKEND,
 			NM_CONFIG_KEYFILE_KEY_LOGGING_DOMAINS,
@@ -44,7 +44,10 @@
 
 #define NM_CONFIG_KEYFILE_KEY_MAIN_ASSUME_IPV6LL_ONLY       "assume-ipv6ll-only"
 #define NM_CONFIG_KEYFILE_KEY_MAIN_AUTH_POLKIT              "auth-polkit"
+#define NM_CONFIG_KEYFILE_KEY_MAIN_AUTOCONNECT_CONCURRENCY  "autoconnect-concurrency"
 #define NM_CONFIG_KEYFILE_KEY_MAIN_AUTOCONNECT_RETRIES_DEFAULT "autoconnect-retries-default"
+#define NM_CONFIG_KEYFILE_KEY_MAIN_CACHE_ROUTE_PROTOCOLS    "cache-route-protocols"
+#define NM_CONFIG_KEYFILE_KEY_MAIN_CACHE_ROUTE_TABLES       "cache-route-tables"
 #define NM_CONFIG_KEYFILE_KEY_MAIN_CONFIGURE_AND_QUIT       "configure-and-quit"
 #define NM_CONFIG_KEYFILE_KEY_MAIN_DEBUG                    "debug"
 #define NM_CONFIG_KEYFILE_KEY_MAIN_DHCP                     "dhcp"
@@ -56,8 +59,11 @@
 #define NM_CONFIG_KEYFILE_KEY_MAIN_PLUGINS                  "plugins"
 #define NM_CONFIG_KEYFILE_KEY_MAIN_RC_MANAGER               "rc-manager"
 #define NM_CONFIG_KEYFILE_KEY_MAIN_SLAVES_ORDER             "slaves-order"
+#define NM_CONFIG_KEYFILE_KEY_MAIN_STATE_SNAPSHOT           "state-snapshot"
+#define NM_CONFIG_KEYFILE_KEY_MAIN_SYSCTL_READ_CACHE        "sysctl-read-cache"
 #define NM_CONFIG_KEYFILE_KEY_MAIN_SYSTEMD_RESOLVED         "systemd-resolved"
 
+#define NM_CONFIG_KEYFILE_KEY_LOGGING_ACTIVATION_TRACE_FILE "activation-trace-file"
 #define NM_CONFIG_KEYFILE_KEY_LOGGING_AUDIT                 "audit"
 #define NM_CONFIG_KEYFILE_KEY_LOGGING_BACKEND               "backend"
 #define NM_CONFIG_KEYFILE_KEY_LOGGING_DOMAINS               "domains"
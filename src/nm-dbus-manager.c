@@ -27,6 +27,12 @@
  */
 #define OBJECT_MANAGER_SERVER_BASE_PATH "/org/freedesktop"
 
+/* PropertiesChanged signals of one object are emitted at most once during
+ * this interval. Additional changes are collected and sent together with
+ * the next batch. Emitting any other signal on the object flushes the
+ * pending properties right away, so that the ordering of signals is kept. */
+#define NOTIFY_MIN_INTERVAL_MSEC 50
+
 /*****************************************************************************/
 
 typedef struct {
@@ -50,6 +56,11 @@ typedef struct {
 	NMDBusObjectClass *klass;
 	guint info_idx;
 	guint registration_id;
+
+	/* the a{sv} dictionary with all properties of the interface. It is
+	 * dropped together with any of the cached property values. */
+	GVariant *properties_cache;
+
 	PropertyCacheData property_cache[];
 } RegistrationData;
 
@@ -79,6 +90,11 @@ typedef struct {
 
 	CList caller_info_lst_head;
 
+	/* exported objects with pending PropertiesChanged notifications. */
+	CList notify_lst_head;
+	guint notify_idle_id;
+	guint notify_timeout_id;
+
 	guint objmgr_registration_id;
 	bool started:1;
 	bool shutting_down:1;
@@ -106,11 +122,12 @@ NM_DEFINE_SINGLETON_GETTER (NMDBusManager, nm_dbus_manager_get, NM_TYPE_DBUS_MAN
 
 /*****************************************************************************/
 
+static void _obj_notify_flush_all (NMDBusManager *self, gboolean force);
+
 static const GDBusInterfaceInfo interface_info_objmgr;
 static const GDBusSignalInfo signal_info_objmgr_interfaces_added;
 static const GDBusSignalInfo signal_info_objmgr_interfaces_removed;
-static GVariantBuilder *_obj_collect_properties_all (NMDBusObject *obj,
-                                                     GVariantBuilder *builder);
+static GVariant *_obj_collect_properties_all (NMDBusObject *obj);
 
 /*****************************************************************************/
 
@@ -864,10 +881,18 @@ dbus_vtable_method_call (GDBusConnection *connection,
 	                     parameters);
 }
 
+static void
+_obj_invalidate_property (RegistrationData *reg_data,
+                          guint property_idx)
+{
+	nm_clear_g_variant (&reg_data->property_cache[property_idx].value);
+	nm_clear_g_variant (&reg_data->properties_cache);
+	nm_clear_g_variant (&reg_data->obj->internal.properties_cache);
+}
+
 static GVariant *
 _obj_get_property (RegistrationData *reg_data,
-                   guint property_idx,
-                   gboolean refetch)
+                   guint property_idx)
 {
 	const NMDBusInterfaceInfoExtended *interface_info = _reg_data_get_interface_info (reg_data);
 	const NMDBusPropertyInfoExtended *property_info;
@@ -875,13 +900,9 @@ _obj_get_property (RegistrationData *reg_data,
 
 	property_info = (const NMDBusPropertyInfoExtended *) (interface_info->parent.properties[property_idx]);
 
-	if (refetch)
-		nm_clear_g_variant (&reg_data->property_cache[property_idx].value);
-	else {
-		value = reg_data->property_cache[property_idx].value;
-		if (value)
-			goto out;
-	}
+	value = reg_data->property_cache[property_idx].value;
+	if (value)
+		goto out;
 
 	value = nm_dbus_utils_get_property (G_OBJECT (reg_data->obj),
 	                                    property_info->parent.signature,
@@ -909,7 +930,7 @@ dbus_vtable_get_property (GDBusConnection *connection,
 	                                                   &property_idx))
 		g_return_val_if_reached (NULL);
 
-	return _obj_get_property (reg_data, property_idx, FALSE);
+	return _obj_get_property (reg_data, property_idx);
 }
 
 static const GDBusInterfaceVTable dbus_vtable = {
@@ -931,9 +952,10 @@ _obj_register (NMDBusManager *self,
 	GType gtype;
 	NMDBusObjectClass *klasses[10];
 	const NMDBusInterfaceInfoExtended *const*prev_interface_infos = NULL;
-	GVariantBuilder builder;
+	gs_unref_variant GVariant *properties = NULL;
 
 	nm_assert (c_list_is_empty (&obj->internal.registration_lst_head));
+	nm_assert (!obj->internal.properties_cache);
 	nm_assert (priv->main_dbus_connection);
 	nm_assert (priv->objmgr_registration_id != 0);
 	nm_assert (priv->started);
@@ -1011,14 +1033,15 @@ _obj_register (NMDBusManager *self,
 	 *
 	 * In general, it's ok to export an object with frozen signals. But you better make sure
 	 * that all properties are in a self-consistent state when exporting the object. */
+	properties = _obj_collect_properties_all (obj);
 	g_dbus_connection_emit_signal (priv->main_dbus_connection,
 	                               NULL,
 	                               OBJECT_MANAGER_SERVER_BASE_PATH,
 	                               interface_info_objmgr.name,
 	                               signal_info_objmgr_interfaces_added.name,
-	                               g_variant_new ("(oa{sa{sv}})",
+	                               g_variant_new ("(o@a{sa{sv}})",
 	                                              obj->internal.path,
-	                                              _obj_collect_properties_all (obj, &builder)),
+	                                              properties),
 	                               NULL);
 }
 
@@ -1053,11 +1076,14 @@ _obj_unregister (NMDBusManager *self,
 			for (i = 0; interface_info->parent.properties[i]; i++)
 				nm_clear_g_variant (&reg_data->property_cache[i].value);
 		}
+		nm_clear_g_variant (&reg_data->properties_cache);
 
 		g_type_class_unref (reg_data->klass);
 		g_free (reg_data);
 	}
 
+	nm_clear_g_variant (&obj->internal.properties_cache);
+
 	g_dbus_connection_emit_signal (priv->main_dbus_connection,
 	                               NULL,
 	                               OBJECT_MANAGER_SERVER_BASE_PATH,
@@ -1109,8 +1135,11 @@ _nm_dbus_manager_obj_export (NMDBusObject *obj)
 		nm_assert_not_reached ();
 	c_list_link_tail (&priv->objects_lst_head, &obj->internal.objects_lst);
 
-	if (priv->started)
+	if (priv->started) {
+		/* clients must see the pending property changes before InterfacesAdded. */
+		_obj_notify_flush_all (self, TRUE);
 		_obj_register (self, obj);
+	}
 }
 
 void
@@ -1130,6 +1159,9 @@ _nm_dbus_manager_obj_unexport (NMDBusObject *obj)
 	nm_assert (&obj->internal == g_hash_table_lookup (priv->objects_by_path, &obj->internal));
 	nm_assert (c_list_contains (&priv->objects_lst_head, &obj->internal.objects_lst));
 
+	/* clients must see the pending property changes before InterfacesRemoved. */
+	_obj_notify_flush_all (self, TRUE);
+
 	if (priv->started)
 		_obj_unregister (self, obj);
 	else
@@ -1140,13 +1172,13 @@ _nm_dbus_manager_obj_unexport (NMDBusObject *obj)
 	c_list_unlink (&obj->internal.objects_lst);
 }
 
-void
-_nm_dbus_manager_obj_notify (NMDBusObject *obj,
-                             guint n_pspecs,
-                             const GParamSpec *const*pspecs)
+static void
+_obj_notify_emit (NMDBusManager *self,
+                  NMDBusObject *obj,
+                  guint n_pspecs,
+                  const GParamSpec *const*pspecs)
 {
-	NMDBusManager *self;
-	NMDBusManagerPrivate *priv;
+	NMDBusManagerPrivate *priv = NM_DBUS_MANAGER_GET_PRIVATE (self);
 	RegistrationData *reg_data;
 	guint i, p;
 	gboolean any_legacy_signals = FALSE;
@@ -1154,20 +1186,8 @@ _nm_dbus_manager_obj_notify (NMDBusObject *obj,
 	GVariantBuilder legacy_builder;
 	GVariant *device_statistics_args = NULL;
 
-	nm_assert (NM_IS_DBUS_OBJECT (obj));
-	nm_assert (obj->internal.path);
-	nm_assert (NM_IS_DBUS_MANAGER (obj->internal.bus_manager));
-	nm_assert (!c_list_is_empty (&obj->internal.objects_lst));
-
-	self = obj->internal.bus_manager;
-	priv = NM_DBUS_MANAGER_GET_PRIVATE (self);
-
-	nm_assert (!priv->started || priv->objmgr_registration_id != 0);
-	nm_assert (priv->objmgr_registration_id == 0 || priv->main_dbus_connection);
-	nm_assert (c_list_is_empty (&obj->internal.registration_lst_head) != priv->started);
-
-	if (G_UNLIKELY (!priv->started))
-		return;
+	nm_assert (priv->started);
+	nm_assert (priv->main_dbus_connection);
 
 	c_list_for_each_entry (reg_data, &obj->internal.registration_lst_head, registration_lst) {
 		if (_reg_data_get_interface_info (reg_data)->legacy_property_changed) {
@@ -1203,7 +1223,9 @@ _nm_dbus_manager_obj_notify (NMDBusObject *obj,
 				if (!nm_streq (property_info->property_name, pspec->name))
 					continue;
 
-				value = _obj_get_property (reg_data, i, TRUE);
+				/* the cached value was already dropped when the change was
+				 * recorded by _nm_dbus_manager_obj_notify(). */
+				value = _obj_get_property (reg_data, i);
 
 				if (   property_info->include_in_legacy_property_changed
 				    && any_legacy_signals) {
@@ -1301,6 +1323,183 @@ _nm_dbus_manager_obj_notify (NMDBusObject *obj,
 	}
 }
 
+static void
+_obj_notify_flush (NMDBusManager *self,
+                   NMDBusObject *obj)
+{
+	NMDBusManagerPrivate *priv = NM_DBUS_MANAGER_GET_PRIVATE (self);
+	gs_unref_ptrarray GPtrArray *pspecs = NULL;
+
+	if (c_list_is_empty (&obj->internal.notify_lst))
+		return;
+
+	c_list_unlink (&obj->internal.notify_lst);
+
+	pspecs = g_steal_pointer (&obj->internal.notify_pspecs);
+	nm_assert (pspecs && pspecs->len > 0);
+
+	if (!priv->started)
+		return;
+
+	obj->internal.notify_last_msec = nm_utils_get_monotonic_timestamp_ms ();
+	_obj_notify_emit (self,
+	                  obj,
+	                  pspecs->len,
+	                  (const GParamSpec *const*) pspecs->pdata);
+}
+
+static gboolean _obj_notify_flush_all_timeout_cb (gpointer user_data);
+
+/* Emit the pending PropertiesChanged signals. With @force, emit them for
+ * all objects, also for those that were flushed recently. That is
+ * necessary before emitting any other signal, because clients must see
+ * the property changes in the order they happened relative to it. */
+static void
+_obj_notify_flush_all (NMDBusManager *self, gboolean force)
+{
+	NMDBusManagerPrivate *priv = NM_DBUS_MANAGER_GET_PRIVATE (self);
+	CList due_lst_head = C_LIST_INIT (due_lst_head);
+	NMDBusObject *obj;
+	NMDBusObject *obj_safe;
+	gint64 now_msec;
+	gint64 next_msec = 0;
+	guint n_flushed = 0;
+
+	now_msec = nm_utils_get_monotonic_timestamp_ms ();
+
+	/* first collect all objects that are due. Objects that were flushed
+	 * recently stay in the list until their interval passed. */
+	c_list_for_each_entry_safe (obj, obj_safe, &priv->notify_lst_head, internal.notify_lst) {
+		gint64 due_msec = 0;
+
+		if (   !force
+		    && obj->internal.notify_last_msec != 0)
+			due_msec = obj->internal.notify_last_msec + NOTIFY_MIN_INTERVAL_MSEC;
+
+		if (due_msec > now_msec) {
+			if (   next_msec == 0
+			    || due_msec < next_msec)
+				next_msec = due_msec;
+			continue;
+		}
+		c_list_unlink_stale (&obj->internal.notify_lst);
+		c_list_link_tail (&due_lst_head, &obj->internal.notify_lst);
+	}
+
+	/* emitting the signals fetches the property values, which in turn could
+	 * queue new notifications (on the manager's list). Only process the
+	 * objects that we collected above. */
+	while ((obj = c_list_first_entry (&due_lst_head, NMDBusObject, internal.notify_lst))) {
+		_obj_notify_flush (self, obj);
+		n_flushed++;
+	}
+
+	if (n_flushed > 0)
+		_LOGT ("notify: flushed PropertiesChanged for %u objects", n_flushed);
+
+	nm_clear_g_source (&priv->notify_timeout_id);
+	if (next_msec != 0) {
+		priv->notify_timeout_id = g_timeout_add (MAX (next_msec - now_msec, 1),
+		                                         _obj_notify_flush_all_timeout_cb,
+		                                         self);
+	}
+}
+
+static gboolean
+_obj_notify_flush_all_idle_cb (gpointer user_data)
+{
+	NMDBusManager *self = user_data;
+	NMDBusManagerPrivate *priv = NM_DBUS_MANAGER_GET_PRIVATE (self);
+
+	priv->notify_idle_id = 0;
+	_obj_notify_flush_all (self, FALSE);
+	return G_SOURCE_REMOVE;
+}
+
+static gboolean
+_obj_notify_flush_all_timeout_cb (gpointer user_data)
+{
+	NMDBusManager *self = user_data;
+	NMDBusManagerPrivate *priv = NM_DBUS_MANAGER_GET_PRIVATE (self);
+
+	priv->notify_timeout_id = 0;
+	_obj_notify_flush_all (self, FALSE);
+	return G_SOURCE_REMOVE;
+}
+
+void
+_nm_dbus_manager_obj_notify (NMDBusObject *obj,
+                             guint n_pspecs,
+                             const GParamSpec *const*pspecs)
+{
+	NMDBusManager *self;
+	NMDBusManagerPrivate *priv;
+	RegistrationData *reg_data;
+	guint i, p;
+
+	nm_assert (NM_IS_DBUS_OBJECT (obj));
+	nm_assert (obj->internal.path);
+	nm_assert (NM_IS_DBUS_MANAGER (obj->internal.bus_manager));
+	nm_assert (!c_list_is_empty (&obj->internal.objects_lst));
+
+	self = obj->internal.bus_manager;
+	priv = NM_DBUS_MANAGER_GET_PRIVATE (self);
+
+	nm_assert (!priv->started || priv->objmgr_registration_id != 0);
+	nm_assert (priv->objmgr_registration_id == 0 || priv->main_dbus_connection);
+	nm_assert (c_list_is_empty (&obj->internal.registration_lst_head) != priv->started);
+
+	if (G_UNLIKELY (!priv->started))
+		return;
+
+	/* the signal is emitted later, but Get() and GetManagedObjects() must
+	 * already return the new values. Drop the cached values right away. */
+	c_list_for_each_entry (reg_data, &obj->internal.registration_lst_head, registration_lst) {
+		const NMDBusInterfaceInfoExtended *interface_info = _reg_data_get_interface_info (reg_data);
+
+		if (!interface_info->parent.properties)
+			continue;
+
+		for (i = 0; interface_info->parent.properties[i]; i++) {
+			const NMDBusPropertyInfoExtended *property_info = (const NMDBusPropertyInfoExtended *) interface_info->parent.properties[i];
+
+			for (p = 0; p < n_pspecs; p++) {
+				if (nm_streq (property_info->property_name, pspecs[p]->name)) {
+					_obj_invalidate_property (reg_data, i);
+					break;
+				}
+			}
+		}
+	}
+
+	if (!obj->internal.notify_pspecs)
+		obj->internal.notify_pspecs = g_ptr_array_new ();
+
+	for (p = 0; p < n_pspecs; p++) {
+		/* the number of pending properties per object is small. A linear
+		 * search is good enough to avoid duplicates. */
+		for (i = 0; i < obj->internal.notify_pspecs->len; i++) {
+			if (obj->internal.notify_pspecs->pdata[i] == pspecs[p])
+				break;
+		}
+		if (i == obj->internal.notify_pspecs->len)
+			g_ptr_array_add (obj->internal.notify_pspecs, (gpointer) pspecs[p]);
+	}
+
+	if (obj->internal.notify_pspecs->len == 0)
+		return;
+
+	if (!c_list_is_empty (&obj->internal.notify_lst)) {
+		/* already queued. */
+		return;
+	}
+
+	c_list_link_tail (&priv->notify_lst_head, &obj->internal.notify_lst);
+
+	if (priv->notify_idle_id == 0)
+		priv->notify_idle_id = g_idle_add_full (G_PRIORITY_DEFAULT, _obj_notify_flush_all_idle_cb, self, NULL);
+}
+
 void
 _nm_dbus_manager_obj_emit_signal (NMDBusObject *obj,
                                   const NMDBusInterfaceInfoExtended *interface_info,
@@ -1323,6 +1522,9 @@ _nm_dbus_manager_obj_emit_signal (NMDBusObject *obj,
 		return;
 	}
 
+	/* pending property changes happened before this signal. Emit them first. */
+	_obj_notify_flush_all (self, TRUE);
+
 	g_dbus_connection_emit_signal (priv->main_dbus_connection,
 	                               NULL,
 	                               obj->internal.path,
@@ -1334,50 +1536,61 @@ _nm_dbus_manager_obj_emit_signal (NMDBusObject *obj,
 
 /*****************************************************************************/
 
-static GVariantBuilder *
-_obj_collect_properties_per_interface (NMDBusObject *obj,
-                                       RegistrationData *reg_data,
-                                       GVariantBuilder *builder)
+/* The collected dictionaries are cached on the registration data and on the
+ * object. Any property notification drops them (see _obj_invalidate_property()),
+ * so that for unchanged objects GetManagedObjects() only needs to take
+ * a reference. */
+static GVariant *
+_obj_collect_properties_per_interface (RegistrationData *reg_data)
 {
 	const NMDBusInterfaceInfoExtended *interface_info = _reg_data_get_interface_info (reg_data);
+	GVariantBuilder builder;
 	guint i;
 
-	g_variant_builder_init (builder, G_VARIANT_TYPE ("a{sv}"));
+	if (reg_data->properties_cache)
+		return g_variant_ref (reg_data->properties_cache);
+
+	g_variant_builder_init (&builder, G_VARIANT_TYPE ("a{sv}"));
 	if (interface_info->parent.properties) {
 		for (i = 0; interface_info->parent.properties[i]; i++) {
 			const NMDBusPropertyInfoExtended *property_info = (const NMDBusPropertyInfoExtended *) interface_info->parent.properties[i];
 			gs_unref_variant GVariant *variant = NULL;
 
-			variant = _obj_get_property (reg_data, i, FALSE);
-			g_variant_builder_add (builder,
+			variant = _obj_get_property (reg_data, i);
+			g_variant_builder_add (&builder,
 			                       "{sv}",
 			                       property_info->parent.name,
 			                       variant);
 		}
 	}
-	return builder;
+
+	reg_data->properties_cache = g_variant_ref_sink (g_variant_builder_end (&builder));
+	return g_variant_ref (reg_data->properties_cache);
 }
 
-static GVariantBuilder *
-_obj_collect_properties_all (NMDBusObject *obj,
-                             GVariantBuilder *builder)
+static GVariant *
+_obj_collect_properties_all (NMDBusObject *obj)
 {
 	RegistrationData *reg_data;
+	GVariantBuilder builder;
+
+	if (obj->internal.properties_cache)
+		return g_variant_ref (obj->internal.properties_cache);
 
-	g_variant_builder_init (builder, G_VARIANT_TYPE ("a{sa{sv}}"));
+	g_variant_builder_init (&builder, G_VARIANT_TYPE ("a{sa{sv}}"));
 
 	c_list_for_each_entry (reg_data, &obj->internal.registration_lst_head, registration_lst) {
-		GVariantBuilder properties_builder;
+		gs_unref_variant GVariant *properties = NULL;
 
-		g_variant_builder_add (builder,
-		                       "{sa{sv}}",
+		properties = _obj_collect_properties_per_interface (reg_data);
+		g_variant_builder_add (&builder,
+		                       "{s@a{sv}}",
 		                       _reg_data_get_interface_info (reg_data)->parent.name,
-		                       _obj_collect_properties_per_interface (obj,
-		                                                              reg_data,
-		                                                              &properties_builder));
+		                       properties);
 	}
 
-	return builder;
+	obj->internal.properties_cache = g_variant_ref_sink (g_variant_builder_end (&builder));
+	return g_variant_ref (obj->internal.properties_cache);
 }
 
 static void
@@ -1409,24 +1622,121 @@ dbus_vtable_objmgr_method_call (GDBusConnection *connection,
 
 	g_variant_builder_init (&array_builder, G_VARIANT_TYPE ("a{oa{sa{sv}}}"));
 	c_list_for_each_entry (obj, &priv->objects_lst_head, internal.objects_lst) {
-		GVariantBuilder interfaces_builder;
+		gs_unref_variant GVariant *properties = NULL;
 
 		/* note that we are called on an idle handler. Hence, all properties are
 		 * supposed to be in a consistent state. That is true, if you always
 		 * g_object_thaw_notify() before returning to the mainloop. Keeping
 		 * signals frozen between while returning from the current call stack
 		 * is anyway a very fragile thing, easy to get wrong. Don't do that. */
+		properties = _obj_collect_properties_all (obj);
 		g_variant_builder_add (&array_builder,
-		                       "{oa{sa{sv}}}",
+		                       "{o@a{sa{sv}}}",
 		                       obj->internal.path,
-		                       _obj_collect_properties_all (obj,
-		                                                    &interfaces_builder));
+		                       properties);
 	}
 	g_dbus_method_invocation_return_value (invocation,
 	                                       g_variant_new ("(a{oa{sa{sv}}})",
 	                                                      &array_builder));
 }
 
+/**
+ * nm_dbus_manager_get_managed_objects:
+ * @self: the #NMDBusManager
+ * @interface_name: (allow-none): only return objects that implement
+ *   this D-Bus interface.
+ * @path_prefix: (allow-none): only return objects whose path starts
+ *   with this prefix.
+ * @cursor: 0 to start the enumeration, or the cursor returned by a
+ *   previous call to continue it.
+ * @limit: the maximum number of objects to return, or 0 for no limit.
+ * @out_next_cursor: (out): the cursor for the next call, or 0 if
+ *   there are no more objects.
+ *
+ * Like GetManagedObjects(), but only returns a filtered part of all
+ * objects. For matching objects, all interfaces are returned.
+ *
+ * Objects are enumerated in the order in which they were exported and
+ * the cursor is the export version id of the last returned object.
+ * Hence, objects that are exported in the meantime are returned by later
+ * calls, and removing objects does not invalidate the cursor.
+ *
+ * Returns: (transfer full): the "a{oa{sa{sv}}}" dictionary.
+ */
+GVariant *
+nm_dbus_manager_get_managed_objects (NMDBusManager *self,
+                                     const char *interface_name,
+                                     const char *path_prefix,
+                                     guint64 cursor,
+                                     guint limit,
+                                     guint64 *out_next_cursor)
+{
+	NMDBusManagerPrivate *priv;
+	GVariantBuilder array_builder;
+	NMDBusObject *obj;
+	gboolean has_more = FALSE;
+	guint n = 0;
+
+	g_return_val_if_fail (NM_IS_DBUS_MANAGER (self), NULL);
+	g_return_val_if_fail (out_next_cursor, NULL);
+
+	priv = NM_DBUS_MANAGER_GET_PRIVATE (self);
+
+	if (interface_name && !interface_name[0])
+		interface_name = NULL;
+	if (path_prefix && !path_prefix[0])
+		path_prefix = NULL;
+
+	*out_next_cursor = 0;
+
+	g_variant_builder_init (&array_builder, G_VARIANT_TYPE ("a{oa{sa{sv}}}"));
+	c_list_for_each_entry (obj, &priv->objects_lst_head, internal.objects_lst) {
+		gs_unref_variant GVariant *properties = NULL;
+
+		/* objects are appended to the list when being exported, so the
+		 * list is sorted by the export version id. */
+		if (obj->internal.export_version_id <= cursor)
+			continue;
+
+		if (   path_prefix
+		    && !g_str_has_prefix (obj->internal.path, path_prefix))
+			continue;
+
+		if (interface_name) {
+			RegistrationData *reg_data;
+			gboolean found = FALSE;
+
+			c_list_for_each_entry (reg_data, &obj->internal.registration_lst_head, registration_lst) {
+				if (nm_streq (_reg_data_get_interface_info (reg_data)->parent.name, interface_name)) {
+					found = TRUE;
+					break;
+				}
+			}
+			if (!found)
+				continue;
+		}
+
+		if (   limit > 0
+		    && n >= limit) {
+			has_more = TRUE;
+			break;
+		}
+
+		properties = _obj_collect_properties_all (obj);
+		g_variant_builder_add (&array_builder,
+		                       "{o@a{sa{sv}}}",
+		                       obj->internal.path,
+		                       properties);
+		n++;
+		*out_next_cursor = obj->internal.export_version_id;
+	}
+
+	if (!has_more)
+		*out_next_cursor = 0;
+
+	return g_variant_ref_sink (g_variant_builder_end (&array_builder));
+}
+
 static const GDBusInterfaceVTable dbus_vtable_objmgr = {
 	.method_call = dbus_vtable_objmgr_method_call
 };
@@ -1615,6 +1925,8 @@ nm_dbus_manager_init (NMDBusManager *self)
 	priv->objects_by_path = g_hash_table_new ((GHashFunc) _objects_by_path_hash, (GEqualFunc) _objects_by_path_equal);
 
 	c_list_init (&priv->caller_info_lst_head);
+
+	c_list_init (&priv->notify_lst_head);
 }
 
 static void
@@ -1629,6 +1941,10 @@ dispose (GObject *object)
 	 * expect any remaining objects. */
 	nm_assert (!priv->objects_by_path || g_hash_table_size (priv->objects_by_path) == 0);
 	nm_assert (c_list_is_empty (&priv->objects_lst_head));
+	nm_assert (c_list_is_empty (&priv->notify_lst_head));
+
+	nm_clear_g_source (&priv->notify_idle_id);
+	nm_clear_g_source (&priv->notify_timeout_id);
 
 	g_clear_pointer (&priv->objects_by_path, g_hash_table_destroy);
 
@@ -51,6 +51,13 @@ gboolean nm_dbus_manager_is_stopping (NMDBusManager *self);
 
 gpointer nm_dbus_manager_lookup_object (NMDBusManager *self, const char *path);
 
+GVariant *nm_dbus_manager_get_managed_objects (NMDBusManager *self,
+                                               const char *interface_name,
+                                               const char *path_prefix,
+                                               guint64 cursor,
+                                               guint limit,
+                                               guint64 *out_next_cursor);
+
 void _nm_dbus_manager_obj_export (NMDBusObject *obj);
 void _nm_dbus_manager_obj_unexport (NMDBusObject *obj);
 void _nm_dbus_manager_obj_notify (NMDBusObject *obj,
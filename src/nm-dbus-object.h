@@ -80,6 +80,19 @@ struct _NMDBusObjectInternal {
 	 * unexported, or even re-exported afterwards. If that happens, we want
 	 * to fail the request. For that, we keep track of a version id.  */
 	guint64 export_version_id;
+
+	/* the cached a{sa{sv}} dictionary with all interfaces and properties,
+	 * as returned by GetManagedObjects(). */
+	GVariant *properties_cache;
+
+	/* PropertiesChanged notifications are not emitted right away. Instead,
+	 * the changed properties are collected in @notify_pspecs and the object
+	 * is queued in the manager's notify list via @notify_lst, until the
+	 * manager flushes all dirty objects at once. */
+	CList notify_lst;
+	GPtrArray *notify_pspecs;
+	gint64 notify_last_msec;
+
 	bool is_unexporting:1;
 };
 
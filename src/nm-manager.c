@@ -42,6 +42,7 @@
 #include "nm-std-aux/nm-dbus-compat.h"
 #include "nm-checkpoint.h"
 #include "nm-checkpoint-manager.h"
+#include "nm-state-snapshot.h"
 #include "nm-dbus-object.h"
 #include "nm-dispatcher.h"
 #include "NetworkManagerUtils.h"
@@ -127,6 +128,7 @@ NM_GOBJECT_PROPERTIES_DEFINE (NMManager,
 	PROP_GLOBAL_DNS_CONFIGURATION,
 	PROP_ALL_DEVICES,
 	PROP_CHECKPOINTS,
+	PROP_DEVICE_STATE_HISTOGRAMS,
 
 	/* Not exported */
 	PROP_SLEEPING,
@@ -146,6 +148,18 @@ typedef struct {
 
 	CList devices_lst_head;
 
+	/* hash indexes for looking up the devices in devices_lst_head. Each
+	 * index maps a key to a GPtrArray of NMDevice, in the order in which
+	 * the devices got indexed. */
+	struct {
+		GHashTable *by_ifindex;
+		GHashTable *by_iface;
+		GHashTable *by_ip_iface;
+		GHashTable *by_perm_hw_addr;
+		/* NMDevice -> DevicesIdxKeys */
+		GHashTable *keys;
+	} devices_idx;
+
 	NMState state;
 	NMConfig *config;
 	NMConnectivity *concheck_mgr;
@@ -162,6 +176,8 @@ typedef struct {
 
 	NMCheckpointManager *checkpoint_mgr;
 
+	NMStateSnapshot *state_snapshot;
+
 	NMSettings *settings;
 
 	CList connection_changed_on_idle_lst;
@@ -176,6 +192,9 @@ typedef struct {
 
 	GHashTable *device_route_metrics;
 
+	/* DeviceStateHistogram, keyed by _device_state_histogram_key(). */
+	GHashTable *device_state_histograms;
+
 	CList auth_lst_head;
 
 	GHashTable *sleep_devices;
@@ -1090,6 +1109,48 @@ nm_manager_get_activatable_connections (NMManager *manager,
 	                                          NULL);
 }
 
+/**
+ * nm_manager_get_autoconnect_candidates:
+ * @manager: the #NMManager
+ * @device: the #NMDevice to autoconnect
+ * @out_len: (allow-none): returns the number of candidates.
+ *
+ * Like nm_manager_get_activatable_connections() for auto activation and sorted,
+ * but it only considers the profiles that have autoconnect enabled and that
+ * might apply to @device, based on their connection type and interface name.
+ * The caller still needs to check whether each candidate can autoconnect
+ * on @device.
+ *
+ * Returns: (transfer container): a %NULL terminated list of profiles. Free
+ *   with g_free().
+ */
+NMSettingsConnection **
+nm_manager_get_autoconnect_candidates (NMManager *manager,
+                                       NMDevice *device,
+                                       guint *out_len)
+{
+	NMManagerPrivate *priv = NM_MANAGER_GET_PRIVATE (manager);
+	const GetActivatableConnectionsFilterData d = {
+		.self = manager,
+		.for_auto_activation = TRUE,
+	};
+	NMSettingsConnection **list;
+	guint len, i, j;
+
+	list = nm_settings_get_autoconnect_candidates (priv->settings,
+	                                               nm_device_get_connection_type_check_compatible (device),
+	                                               nm_device_get_iface (device),
+	                                               &len);
+	for (i = 0, j = 0; i < len; i++) {
+		if (_get_activatable_connections_filter (priv->settings, list[i], (gpointer) &d))
+			list[j++] = list[i];
+	}
+	list[j] = NULL;
+
+	NM_SET_OUT (out_len, j);
+	return list;
+}
+
 static NMActiveConnection *
 active_connection_get_by_path (NMManager *self, const char *path)
 {
@@ -1239,14 +1300,201 @@ nm_manager_get_device_by_path (NMManager *self, const char *path)
 	return device;
 }
 
+/*****************************************************************************/
+
+/* The devices index is kept in sync with the devices by listening to the
+ * property change notifications of the device. Notifications are frozen
+ * between nm_device_realize_start() and nm_device_realize_finish(), hence
+ * the index is also updated explicitly after starting to realize a device.
+ * The lookup functions still verify that the candidates from the index
+ * match. */
+
+typedef struct {
+	int ifindex;
+	char *iface;
+	char *ip_iface;
+	char *perm_hw_addr;
+} DevicesIdxKeys;
+
+static char *
+_devices_idx_hw_addr_key (const char *hwaddr)
+{
+	guint8 buf[NM_UTILS_HWADDR_LEN_MAX];
+	gs_free char *str = NULL;
+	gsize len;
+
+	if (   !hwaddr
+	    || !_nm_utils_hwaddr_aton (hwaddr, buf, sizeof (buf), &len))
+		return NULL;
+
+	/* nm_utils_hwaddr_matches() only compares the last 8 bytes of
+	 * infiniband addresses. */
+	if (len == INFINIBAND_ALEN) {
+		str = nm_utils_hwaddr_ntoa (&buf[INFINIBAND_ALEN - 8], 8);
+		return g_strconcat ("ib/", str, NULL);
+	}
+
+	return nm_utils_hwaddr_ntoa (buf, len);
+}
+
+static GPtrArray *
+_devices_idx_lookup (GHashTable *idx, gconstpointer key)
+{
+	if (!key)
+		return NULL;
+	return g_hash_table_lookup (idx, key);
+}
+
+static void
+_devices_idx_add (GHashTable *idx, gpointer key, gboolean key_is_str, NMDevice *device)
+{
+	GPtrArray *devices;
+
+	if (!key)
+		return;
+
+	devices = g_hash_table_lookup (idx, key);
+	if (!devices) {
+		devices = g_ptr_array_new ();
+		g_hash_table_insert (idx,
+		                     key_is_str ? g_strdup (key) : key,
+		                     devices);
+	}
+	g_ptr_array_add (devices, device);
+}
+
+static void
+_devices_idx_remove (GHashTable *idx, gconstpointer key, NMDevice *device)
+{
+	GPtrArray *devices;
+
+	if (!key)
+		return;
+
+	devices = g_hash_table_lookup (idx, key);
+	if (!devices) {
+		nm_assert_not_reached ();
+		return;
+	}
+
+	if (!g_ptr_array_remove (devices, device))
+		nm_assert_not_reached ();
+	if (devices->len == 0)
+		g_hash_table_remove (idx, key);
+}
+
+static void
+_devices_idx_keys_free (DevicesIdxKeys *keys)
+{
+	g_free (keys->iface);
+	g_free (keys->ip_iface);
+	g_free (keys->perm_hw_addr);
+	g_slice_free (DevicesIdxKeys, keys);
+}
+
+static void
+_devices_idx_update (NMManager *self, NMDevice *device, gboolean remove)
+{
+	NMManagerPrivate *priv = NM_MANAGER_GET_PRIVATE (self);
+	DevicesIdxKeys *keys;
+	int ifindex;
+	const char *iface;
+	const char *ip_iface;
+	gs_free char *perm_hw_addr = NULL;
+
+	keys = g_hash_table_lookup (priv->devices_idx.keys, device);
+
+	if (remove) {
+		ifindex = 0;
+		iface = NULL;
+		ip_iface = NULL;
+	} else {
+		ifindex = nm_device_get_ifindex (device);
+		if (ifindex <= 0)
+			ifindex = 0;
+		iface = nm_device_get_iface (device);
+		ip_iface = nm_device_get_ip_iface (device);
+		/* don't force reading the permanent MAC address. Once it is known,
+		 * the device notifies about it. */
+		perm_hw_addr = _devices_idx_hw_addr_key (nm_device_get_permanent_hw_address_full (device, FALSE, NULL));
+	}
+
+	if (!keys) {
+		if (remove)
+			return;
+		keys = g_slice_new0 (DevicesIdxKeys);
+		g_hash_table_insert (priv->devices_idx.keys, device, keys);
+	}
+
+	/* only touch the indexes whose key changed, so that the order of
+	 * the devices with the same key is preserved. */
+	if (keys->ifindex != ifindex) {
+		_devices_idx_remove (priv->devices_idx.by_ifindex, GINT_TO_POINTER (keys->ifindex), device);
+		keys->ifindex = ifindex;
+		_devices_idx_add (priv->devices_idx.by_ifindex, GINT_TO_POINTER (keys->ifindex), FALSE, device);
+	}
+	if (!nm_streq0 (keys->iface, iface)) {
+		_devices_idx_remove (priv->devices_idx.by_iface, keys->iface, device);
+		g_free (keys->iface);
+		keys->iface = g_strdup (iface);
+		_devices_idx_add (priv->devices_idx.by_iface, keys->iface, TRUE, device);
+	}
+	if (!nm_streq0 (keys->ip_iface, ip_iface)) {
+		_devices_idx_remove (priv->devices_idx.by_ip_iface, keys->ip_iface, device);
+		g_free (keys->ip_iface);
+		keys->ip_iface = g_strdup (ip_iface);
+		_devices_idx_add (priv->devices_idx.by_ip_iface, keys->ip_iface, TRUE, device);
+	}
+	if (!nm_streq0 (keys->perm_hw_addr, perm_hw_addr)) {
+		_devices_idx_remove (priv->devices_idx.by_perm_hw_addr, keys->perm_hw_addr, device);
+		g_free (keys->perm_hw_addr);
+		keys->perm_hw_addr = g_steal_pointer (&perm_hw_addr);
+		_devices_idx_add (priv->devices_idx.by_perm_hw_addr, keys->perm_hw_addr, TRUE, device);
+	}
+
+	if (remove)
+		g_hash_table_remove (priv->devices_idx.keys, device);
+}
+
+static void
+_devices_idx_init (NMManagerPrivate *priv)
+{
+	priv->devices_idx.by_ifindex = g_hash_table_new_full (nm_direct_hash, NULL, NULL, (GDestroyNotify) g_ptr_array_unref);
+	priv->devices_idx.by_iface = g_hash_table_new_full (nm_str_hash, g_str_equal, g_free, (GDestroyNotify) g_ptr_array_unref);
+	priv->devices_idx.by_ip_iface = g_hash_table_new_full (nm_str_hash, g_str_equal, g_free, (GDestroyNotify) g_ptr_array_unref);
+	priv->devices_idx.by_perm_hw_addr = g_hash_table_new_full (nm_str_hash, g_str_equal, g_free, (GDestroyNotify) g_ptr_array_unref);
+	priv->devices_idx.keys = g_hash_table_new_full (nm_direct_hash, NULL, NULL, (GDestroyNotify) _devices_idx_keys_free);
+}
+
+static void
+_devices_idx_destroy (NMManagerPrivate *priv)
+{
+	nm_assert (!priv->devices_idx.keys || g_hash_table_size (priv->devices_idx.keys) == 0);
+
+	nm_clear_pointer (&priv->devices_idx.keys, g_hash_table_unref);
+	nm_clear_pointer (&priv->devices_idx.by_ifindex, g_hash_table_unref);
+	nm_clear_pointer (&priv->devices_idx.by_iface, g_hash_table_unref);
+	nm_clear_pointer (&priv->devices_idx.by_ip_iface, g_hash_table_unref);
+	nm_clear_pointer (&priv->devices_idx.by_perm_hw_addr, g_hash_table_unref);
+}
+
+/*****************************************************************************/
+
 NMDevice *
 nm_manager_get_device_by_ifindex (NMManager *self, int ifindex)
 {
 	NMManagerPrivate *priv = NM_MANAGER_GET_PRIVATE (self);
-	NMDevice *device;
+	GPtrArray *devices;
+	guint i;
+
+	if (ifindex <= 0)
+		return NULL;
+
+	devices = _devices_idx_lookup (priv->devices_idx.by_ifindex, GINT_TO_POINTER (ifindex));
+	if (devices) {
+		for (i = 0; i < devices->len; i++) {
+			NMDevice *device = devices->pdata[i];
 
-	if (ifindex > 0) {
-		c_list_for_each_entry (device, &priv->devices_lst_head, devices_lst) {
 			if (nm_device_get_ifindex (device) == ifindex)
 				return device;
 		}
@@ -1259,17 +1507,37 @@ static NMDevice *
 find_device_by_permanent_hw_addr (NMManager *self, const char *hwaddr)
 {
 	NMManagerPrivate *priv = NM_MANAGER_GET_PRIVATE (self);
+	gs_free char *key = NULL;
+	GPtrArray *devices;
 	NMDevice *device;
 	const char *device_addr;
 	guint8 hwaddr_bin[NM_UTILS_HWADDR_LEN_MAX];
 	gsize hwaddr_len;
+	guint i;
 
 	g_return_val_if_fail (hwaddr != NULL, NULL);
 
 	if (!_nm_utils_hwaddr_aton (hwaddr, hwaddr_bin, sizeof (hwaddr_bin), &hwaddr_len))
 		return NULL;
 
+	key = _devices_idx_hw_addr_key (hwaddr);
+	devices = _devices_idx_lookup (priv->devices_idx.by_perm_hw_addr, key);
+	if (devices) {
+		for (i = 0; i < devices->len; i++) {
+			device = devices->pdata[i];
+
+			device_addr = nm_device_get_permanent_hw_address (device);
+			if (   device_addr
+			    && nm_utils_hwaddr_matches (hwaddr_bin, hwaddr_len, device_addr, -1))
+				return device;
+		}
+	}
+
+	/* devices whose permanent MAC address is not yet known are not in the
+	 * index. Like before, force reading it for them. */
 	c_list_for_each_entry (device, &priv->devices_lst_head, devices_lst) {
+		if (nm_device_get_permanent_hw_address_full (device, FALSE, NULL))
+			continue;
 		device_addr = nm_device_get_permanent_hw_address (device);
 		if (   device_addr
 		    && nm_utils_hwaddr_matches (hwaddr_bin, hwaddr_len, device_addr, -1))
@@ -1282,14 +1550,20 @@ static NMDevice *
 find_device_by_ip_iface (NMManager *self, const char *iface)
 {
 	NMManagerPrivate *priv = NM_MANAGER_GET_PRIVATE (self);
-	NMDevice *device;
+	GPtrArray *devices;
+	guint i;
 
 	g_return_val_if_fail (iface, NULL);
 
-	c_list_for_each_entry (device, &priv->devices_lst_head, devices_lst) {
-		if (   nm_device_is_real (device)
-		    && nm_streq0 (nm_device_get_ip_iface (device), iface))
-			return device;
+	devices = _devices_idx_lookup (priv->devices_idx.by_ip_iface, iface);
+	if (devices) {
+		for (i = 0; i < devices->len; i++) {
+			NMDevice *device = devices->pdata[i];
+
+			if (   nm_device_is_real (device)
+			    && nm_streq0 (nm_device_get_ip_iface (device), iface))
+				return device;
+		}
 	}
 	return NULL;
 }
@@ -1317,11 +1591,14 @@ find_device_by_iface (NMManager *self,
 {
 	NMManagerPrivate *priv = NM_MANAGER_GET_PRIVATE (self);
 	NMDevice *fallback = NULL;
-	NMDevice *candidate;
+	GPtrArray *devices;
+	guint i;
 
 	g_return_val_if_fail (iface != NULL, NULL);
 
-	c_list_for_each_entry (candidate, &priv->devices_lst_head, devices_lst) {
+	devices = _devices_idx_lookup (priv->devices_idx.by_iface, iface);
+	for (i = 0; devices && i < devices->len; i++) {
+		NMDevice *candidate = devices->pdata[i];
 
 		if (strcmp (nm_device_get_iface (candidate), iface))
 			continue;
@@ -1663,6 +1940,7 @@ remove_device (NMManager *self,
 
 	nm_settings_device_removed (priv->settings, device, quitting);
 
+	_devices_idx_update (self, device, TRUE);
 	c_list_unlink (&device->devices_lst);
 
 	_parent_notify_changed (self, device, TRUE);
@@ -1873,12 +2151,16 @@ NMDevice *
 nm_manager_get_device (NMManager *self, const char *ifname, NMDeviceType device_type)
 {
 	NMManagerPrivate *priv = NM_MANAGER_GET_PRIVATE (self);
-	NMDevice *device;
+	GPtrArray *devices;
+	guint i;
 
 	g_return_val_if_fail (ifname, NULL);
 	g_return_val_if_fail (device_type != NM_DEVICE_TYPE_UNKNOWN, NULL);
 
-	c_list_for_each_entry (device, &priv->devices_lst_head, devices_lst) {
+	devices = _devices_idx_lookup (priv->devices_idx.by_iface, ifname);
+	for (i = 0; devices && i < devices->len; i++) {
+		NMDevice *device = devices->pdata[i];
+
 		if (   nm_device_get_device_type (device) == device_type
 		    && nm_streq0 (nm_device_get_iface (device), ifname))
 			return device;
@@ -2844,9 +3126,18 @@ device_ifindex_changed (NMDevice *device,
                         GParamSpec *pspec,
                         NMManager *self)
 {
+	_devices_idx_update (self, device, FALSE);
 	_parent_notify_changed (self, device, FALSE);
 }
 
+static void
+device_perm_hw_addr_changed (NMDevice *device,
+                             GParamSpec *pspec,
+                             NMManager *self)
+{
+	_devices_idx_update (self, device, FALSE);
+}
+
 static void
 device_ip_iface_changed (NMDevice *device,
                          GParamSpec *pspec,
@@ -2855,14 +3146,20 @@ device_ip_iface_changed (NMDevice *device,
 	NMManagerPrivate *priv = NM_MANAGER_GET_PRIVATE (self);
 	const char *ip_iface = nm_device_get_ip_iface (device);
 	NMDeviceType device_type = nm_device_get_device_type (device);
-	NMDevice *candidate;
+	GPtrArray *devices;
+	guint i;
+
+	_devices_idx_update (self, device, FALSE);
 
 	/* Remove NMDevice objects that are actually child devices of others,
 	 * when the other device finally knows its IP interface name.  For example,
 	 * remove the PPP interface that's a child of a WWAN device, since it's
 	 * not really a standalone NMDevice.
 	 */
-	c_list_for_each_entry (candidate, &priv->devices_lst_head, devices_lst) {
+	devices = _devices_idx_lookup (priv->devices_idx.by_iface, ip_iface);
+	for (i = 0; devices && i < devices->len; i++) {
+		NMDevice *candidate = devices->pdata[i];
+
 		if (   candidate != device
 		    && g_strcmp0 (nm_device_get_iface (candidate), ip_iface) == 0
 		    && nm_device_get_device_type (candidate) == device_type
@@ -2878,6 +3175,8 @@ device_iface_changed (NMDevice *device,
                       GParamSpec *pspec,
                       NMManager *self)
 {
+	_devices_idx_update (self, device, FALSE);
+
 	/* Virtual connections may refer to the new device name as
 	 * parent device, retry to activate them.
 	 */
@@ -2908,6 +3207,7 @@ device_realized (NMDevice *device,
                  GParamSpec *pspec,
                  NMManager *self)
 {
+	_devices_idx_update (self, device, FALSE);
 	_emit_device_added_removed (self, device, nm_device_is_real (device));
 }
 
@@ -3079,6 +3379,7 @@ add_device (NMManager *self, NMDevice *device, GError **error)
 
 	nm_assert (c_list_is_empty (&device->devices_lst));
 	c_list_link_tail (&priv->devices_lst_head, &device->devices_lst);
+	_devices_idx_update (self, device, FALSE);
 
 	g_signal_connect (device, NM_DEVICE_STATE_CHANGED,
 	                  G_CALLBACK (manager_device_state_changed),
@@ -3112,6 +3413,10 @@ add_device (NMManager *self, NMDevice *device, GError **error)
 	                  G_CALLBACK (device_realized),
 	                  self);
 
+	g_signal_connect (device, "notify::" NM_DEVICE_PERM_HW_ADDRESS,
+	                  G_CALLBACK (device_perm_hw_addr_changed),
+	                  self);
+
 	g_signal_connect (device, "notify::" NM_DEVICE_IP4_CONNECTIVITY,
 	                  G_CALLBACK (device_connectivity_changed),
 	                  self);
@@ -3200,6 +3505,114 @@ _register_device_factory (NMDeviceFactory *factory, gpointer user_data)
 
 /*****************************************************************************/
 
+/* log2 histograms of the time that devices spend in each device state,
+ * per device type. Bucket 0 is for durations below 1 msec, bucket i covers
+ * [2^(i-1), 2^i) msec. */
+
+#define DEVICE_STATE_HISTOGRAM_N_BUCKETS 16
+
+typedef struct {
+	NMDeviceType device_type;
+	NMDeviceState state;
+	guint32 buckets[DEVICE_STATE_HISTOGRAM_N_BUCKETS];
+} DeviceStateHistogram;
+
+static gpointer
+_device_state_histogram_key (NMDeviceType device_type, NMDeviceState state)
+{
+	nm_assert (state <= 0xFF);
+
+	return GUINT_TO_POINTER ((((guint) device_type) << 8) | ((guint) state));
+}
+
+static int
+_device_state_histogram_cmp (gconstpointer a, gconstpointer b, gpointer user_data)
+{
+	const DeviceStateHistogram *h_a = *((const DeviceStateHistogram *const*) a);
+	const DeviceStateHistogram *h_b = *((const DeviceStateHistogram *const*) b);
+
+	NM_CMP_FIELD (h_a, h_b, device_type);
+	NM_CMP_FIELD (h_a, h_b, state);
+	return 0;
+}
+
+/**
+ * nm_manager_device_state_duration_add:
+ * @self: the #NMManager
+ * @device_type: the type of the device
+ * @state: the state that the device left
+ * @duration_ms: how long the device was in @state
+ *
+ * Adds the duration to the histograms, which are exposed as the
+ * "DeviceStateHistograms" property.
+ */
+void
+nm_manager_device_state_duration_add (NMManager *self,
+                                      NMDeviceType device_type,
+                                      NMDeviceState state,
+                                      guint32 duration_ms)
+{
+	NMManagerPrivate *priv = NM_MANAGER_GET_PRIVATE (self);
+	DeviceStateHistogram *h;
+	gpointer key;
+
+	key = _device_state_histogram_key (device_type, state);
+
+	if (G_UNLIKELY (!priv->device_state_histograms))
+		priv->device_state_histograms = g_hash_table_new_full (nm_direct_hash, NULL, NULL, g_free);
+
+	h = g_hash_table_lookup (priv->device_state_histograms, key);
+	if (!h) {
+		h = g_new0 (DeviceStateHistogram, 1);
+		h->device_type = device_type;
+		h->state = state;
+		g_hash_table_insert (priv->device_state_histograms, key, h);
+	}
+
+	h->buckets[NM_MIN (g_bit_storage (duration_ms), (guint) (DEVICE_STATE_HISTOGRAM_N_BUCKETS - 1))]++;
+
+	/* the D-Bus manager coalesces the notifications of a burst of
+	 * state changes into one PropertiesChanged signal. */
+	_notify (self, PROP_DEVICE_STATE_HISTOGRAMS);
+}
+
+static GVariant *
+_device_state_histograms_to_variant (NMManager *self)
+{
+	NMManagerPrivate *priv = NM_MANAGER_GET_PRIVATE (self);
+	gs_free gpointer *histograms = NULL;
+	GVariantBuilder builder;
+	guint len;
+	guint i, j;
+
+	g_variant_builder_init (&builder, G_VARIANT_TYPE ("a(uuau)"));
+
+	if (priv->device_state_histograms) {
+		histograms = nm_utils_hash_values_to_array (priv->device_state_histograms,
+		                                            _device_state_histogram_cmp,
+		                                            NULL,
+		                                            &len);
+		for (i = 0; i < len; i++) {
+			const DeviceStateHistogram *h = histograms[i];
+			GVariantBuilder buckets;
+
+			g_variant_builder_init (&buckets, G_VARIANT_TYPE ("au"));
+			for (j = 0; j < DEVICE_STATE_HISTOGRAM_N_BUCKETS; j++)
+				g_variant_builder_add (&buckets, "u", h->buckets[j]);
+
+			g_variant_builder_add (&builder,
+			                       "(uuau)",
+			                       (guint32) h->device_type,
+			                       (guint32) h->state,
+			                       &buckets);
+		}
+	}
+
+	return g_variant_builder_end (&builder);
+}
+
+/*****************************************************************************/
+
 void
 nm_manager_notify_device_availibility_maybe_changed (NMManager *self)
 {
@@ -3222,18 +3635,31 @@ platform_link_added (NMManager *self,
 	NMManagerPrivate *priv = NM_MANAGER_GET_PRIVATE (self);
 	NMDeviceFactory *factory;
 	NMDevice *device = NULL;
-	NMDevice *candidate;
+	gs_unref_ptrarray GPtrArray *candidates = NULL;
+	GPtrArray *devices;
+	guint i;
 
 	g_return_if_fail (ifindex > 0);
 
 	if (nm_manager_get_device_by_ifindex (self, ifindex))
 		return;
 
-	/* Let unrealized devices try to realize themselves with the link */
-	c_list_for_each_entry (candidate, &priv->devices_lst_head, devices_lst) {
+	/* Let unrealized devices try to realize themselves with the link. Realizing
+	 * might modify the index, iterate over a copy. */
+	devices = _devices_idx_lookup (priv->devices_idx.by_iface, plink->name);
+	if (devices) {
+		candidates = g_ptr_array_new_full (devices->len, g_object_unref);
+		for (i = 0; i < devices->len; i++)
+			g_ptr_array_add (candidates, g_object_ref (devices->pdata[i]));
+	}
+	for (i = 0; candidates && i < candidates->len; i++) {
+		NMDevice *candidate = candidates->pdata[i];
 		gboolean compatible = TRUE;
 		gs_free_error GError *error = NULL;
 
+		if (c_list_is_empty (&candidate->devices_lst))
+			continue;
+
 		if (nm_device_get_link_type (candidate) != plink->type)
 			continue;
 
@@ -3265,6 +3691,7 @@ platform_link_added (NMManager *self,
 		                                    NM_UNMAN_FLAG_OP_FORGET,
 		                                    &compatible,
 		                                    &error)) {
+			_devices_idx_update (self, candidate, FALSE);
 			_device_realize_finish (self, candidate, plink);
 			return;
 		}
@@ -3848,6 +4275,36 @@ impl_manager_get_device_by_ip_iface (NMDBusObject *obj,
 	                                       g_variant_new ("(o)", path));
 }
 
+static void
+impl_manager_get_managed_objects_filtered (NMDBusObject *obj,
+                                           const NMDBusInterfaceInfoExtended *interface_info,
+                                           const NMDBusMethodInfoExtended *method_info,
+                                           GDBusConnection *connection,
+                                           const char *sender,
+                                           GDBusMethodInvocation *invocation,
+                                           GVariant *parameters)
+{
+	gs_unref_variant GVariant *objects = NULL;
+	const char *interface_name;
+	const char *path_prefix;
+	guint64 cursor;
+	guint64 next_cursor;
+	guint32 limit;
+
+	g_variant_get (parameters, "(&s&stu)", &interface_name, &path_prefix, &cursor, &limit);
+
+	objects = nm_dbus_manager_get_managed_objects (nm_dbus_object_get_manager (obj),
+	                                               interface_name,
+	                                               path_prefix,
+	                                               cursor,
+	                                               limit,
+	                                               &next_cursor);
+	g_dbus_method_invocation_return_value (invocation,
+	                                       g_variant_new ("(@a{oa{sa{sv}}}t)",
+	                                                      objects,
+	                                                      next_cursor));
+}
+
 static gboolean
 is_compatible_with_slave (NMConnection *master, NMConnection *slave)
 {
@@ -7389,6 +7846,12 @@ constructed (GObject *object)
 	                  G_CALLBACK (_config_changed_cb),
 	                  self);
 
+	if (nm_config_data_get_value_boolean (nm_config_get_data_orig (priv->config),
+	                                      NM_CONFIG_KEYFILE_GROUP_MAIN,
+	                                      NM_CONFIG_KEYFILE_KEY_MAIN_STATE_SNAPSHOT,
+	                                      FALSE))
+		priv->state_snapshot = nm_state_snapshot_new (self);
+
 	state = nm_config_state_get (priv->config);
 
 	priv->net_enabled = state->net_enabled;
@@ -7421,6 +7884,7 @@ nm_manager_init (NMManager *self)
 	c_list_init (&priv->auth_lst_head);
 	c_list_init (&priv->link_cb_lst);
 	c_list_init (&priv->devices_lst_head);
+	_devices_idx_init (priv);
 	c_list_init (&priv->active_connections_lst_head);
 	c_list_init (&priv->async_op_lst_head);
 	c_list_init (&priv->delete_volatile_connection_lst_head);
@@ -7610,6 +8074,9 @@ get_property (GObject *object, guint prop_id,
 		                                                                                                  NULL))
 		                    : NULL);
 		break;
+	case PROP_DEVICE_STATE_HISTOGRAMS:
+		g_value_take_variant (value, _device_state_histograms_to_variant (self));
+		break;
 	default:
 		G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
 		break;
@@ -7693,6 +8160,7 @@ dispose (GObject *object)
 	nm_clear_g_source (&priv->devices_inited_id);
 
 	g_clear_pointer (&priv->checkpoint_mgr, nm_checkpoint_manager_free);
+	g_clear_pointer (&priv->state_snapshot, nm_state_snapshot_free);
 
 	if (priv->concheck_mgr) {
 		g_signal_handlers_disconnect_by_func (priv->concheck_mgr,
@@ -7709,6 +8177,7 @@ dispose (GObject *object)
 	}
 
 	nm_assert (c_list_is_empty (&priv->devices_lst_head));
+	_devices_idx_destroy (priv);
 
 	nm_clear_g_source (&priv->ac_cleanup_id);
 
@@ -7781,6 +8250,7 @@ dispose (GObject *object)
 	nm_clear_g_source (&priv->timestamp_update_id);
 
 	g_clear_pointer (&priv->device_route_metrics, g_hash_table_destroy);
+	nm_clear_pointer (&priv->device_state_histograms, g_hash_table_unref);
 
 	G_OBJECT_CLASS (nm_manager_parent_class)->dispose (object);
 }
@@ -7865,6 +8335,22 @@ static const NMDBusInterfaceInfoExtended interface_info_manager = {
 				),
 				.handle = impl_manager_get_device_by_ip_iface,
 			),
+			NM_DEFINE_DBUS_METHOD_INFO_EXTENDED (
+				NM_DEFINE_GDBUS_METHOD_INFO_INIT (
+					"GetManagedObjectsFiltered",
+					.in_args = NM_DEFINE_GDBUS_ARG_INFOS (
+						NM_DEFINE_GDBUS_ARG_INFO ("interface_name", "s"),
+						NM_DEFINE_GDBUS_ARG_INFO ("path_prefix", "s"),
+						NM_DEFINE_GDBUS_ARG_INFO ("cursor", "t"),
+						NM_DEFINE_GDBUS_ARG_INFO ("limit", "u"),
+					),
+					.out_args = NM_DEFINE_GDBUS_ARG_INFOS (
+						NM_DEFINE_GDBUS_ARG_INFO ("objects", "a{oa{sa{sv}}}"),
+						NM_DEFINE_GDBUS_ARG_INFO ("next_cursor", "t"),
+					),
+				),
+				.handle = impl_manager_get_managed_objects_filtered,
+			),
 			NM_DEFINE_DBUS_METHOD_INFO_EXTENDED (
 				NM_DEFINE_GDBUS_METHOD_INFO_INIT (
 					"ActivateConnection",
@@ -8063,6 +8549,7 @@ static const NMDBusInterfaceInfoExtended interface_info_manager = {
 			NM_DEFINE_DBUS_PROPERTY_INFO_EXTENDED_READWRITABLE_L ("ConnectivityCheckEnabled",   "b",     NM_MANAGER_CONNECTIVITY_CHECK_ENABLED,    NM_AUTH_PERMISSION_ENABLE_DISABLE_CONNECTIVITY_CHECK, NM_AUDIT_OP_NET_CONTROL),
 			NM_DEFINE_DBUS_PROPERTY_INFO_EXTENDED_READABLE       ("ConnectivityCheckUri",       "s",     NM_MANAGER_CONNECTIVITY_CHECK_URI),
 			NM_DEFINE_DBUS_PROPERTY_INFO_EXTENDED_READWRITABLE_L ("GlobalDnsConfiguration",     "a{sv}", NM_MANAGER_GLOBAL_DNS_CONFIGURATION,      NM_AUTH_PERMISSION_SETTINGS_MODIFY_GLOBAL_DNS,        NM_AUDIT_OP_NET_CONTROL),
+			NM_DEFINE_DBUS_PROPERTY_INFO_EXTENDED_READABLE       ("DeviceStateHistograms",      "a(uuau)", NM_MANAGER_DEVICE_STATE_HISTOGRAMS),
 		),
 	),
 	.legacy_property_changed = TRUE,
@@ -8257,6 +8744,13 @@ nm_manager_class_init (NMManagerClass *manager_class)
 	                        G_PARAM_READABLE |
 	                        G_PARAM_STATIC_STRINGS);
 
+	obj_properties[PROP_DEVICE_STATE_HISTOGRAMS] =
+	    g_param_spec_variant (NM_MANAGER_DEVICE_STATE_HISTOGRAMS, "", "",
+	                          G_VARIANT_TYPE ("a(uuau)"),
+	                          NULL,
+	                          G_PARAM_READABLE |
+	                          G_PARAM_STATIC_STRINGS);
+
 	g_object_class_install_properties (object_class, _PROPERTY_ENUMS_LAST, obj_properties);
 
 	/* signals */
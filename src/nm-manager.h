@@ -42,6 +42,7 @@
 #define NM_MANAGER_GLOBAL_DNS_CONFIGURATION "global-dns-configuration"
 #define NM_MANAGER_ALL_DEVICES "all-devices"
 #define NM_MANAGER_CHECKPOINTS "checkpoints"
+#define NM_MANAGER_DEVICE_STATE_HISTOGRAMS "device-state-histograms"
 
 /* Not exported */
 #define NM_MANAGER_SLEEPING "sleeping"
@@ -102,6 +103,10 @@ NMSettingsConnection **nm_manager_get_activatable_connections (NMManager *manage
                                                                gboolean sort,
                                                                guint *out_len);
 
+NMSettingsConnection **nm_manager_get_autoconnect_candidates (NMManager *manager,
+                                                              NMDevice *device,
+                                                              guint *out_len);
+
 void          nm_manager_write_device_state_all (NMManager *manager);
 gboolean      nm_manager_write_device_state (NMManager *manager, NMDevice *device);
 
@@ -192,4 +197,9 @@ NMMetered nm_manager_get_metered (NMManager *self);
 
 void nm_manager_notify_device_availibility_maybe_changed (NMManager *self);
 
+void nm_manager_device_state_duration_add (NMManager *self,
+                                           NMDeviceType device_type,
+                                           NMDeviceState state,
+                                           guint32 duration_ms);
+
 #endif /* __NETWORKMANAGER_MANAGER_H__ */
@@ -51,6 +51,12 @@ typedef struct {
 	NMNetns *netns;
 	NMFirewallManager *firewall_manager;
 	CList pending_activation_checks;
+	GHashTable *pending_activation_checks_idx;
+
+	/* devices that were auto-activated and are in the early stages of
+	 * the activation. See _activating_devices_add(). */
+	GHashTable *activating_devices;
+	guint autoconnect_concurrency;
 
 	NMAgentManager *agent_mgr;
 
@@ -79,6 +85,8 @@ typedef struct {
 
 	guint schedule_activate_all_id; /* idle handler for schedule_activate_all(). */
 
+	guint autoactivate_batch_id; /* idle handler for auto_activate_batch_cb(). */
+
 	NMPolicyHostnameMode hostname_mode;
 	char *orig_hostname; /* hostname at NM start time */
 	char *cur_hostname;  /* hostname we want to assign */
@@ -1157,19 +1165,123 @@ check_activating_active_connections (NMPolicy *self)
 	g_object_thaw_notify (G_OBJECT (self));
 }
 
+/* Devices that need an autoconnect check are queued in pending_activation_checks
+ * (once per device) and processed by one idle handler. Each run of the handler
+ * processes the queue for at most AUTOACTIVATE_BATCH_MAX_MSEC, so that a burst
+ * of devices does not block the main loop. */
+#define AUTOACTIVATE_BATCH_MAX_MSEC 20
+
 typedef struct {
 	CList pending_lst;
 	NMPolicy *policy;
 	NMDevice *device;
-	guint autoactivate_id;
+	bool in_progress:1;
 } ActivateData;
 
+static gboolean auto_activate_batch_cb (gpointer user_data);
+
+static gboolean
+_autoconnect_concurrency_reached (NMPolicy *self)
+{
+	NMPolicyPrivate *priv = NM_POLICY_GET_PRIVATE (self);
+
+	return    priv->autoconnect_concurrency > 0
+	       && g_hash_table_size (priv->activating_devices) >= priv->autoconnect_concurrency;
+}
+
+static void
+_autoactivate_batch_schedule (NMPolicy *self)
+{
+	NMPolicyPrivate *priv = NM_POLICY_GET_PRIVATE (self);
+
+	if (   priv->autoactivate_batch_id
+	    || c_list_is_empty (&priv->pending_activation_checks)
+	    || _autoconnect_concurrency_reached (self))
+		return;
+
+	priv->autoactivate_batch_id = g_idle_add (auto_activate_batch_cb, self);
+}
+
+/* a device can hold its slot at most this long. This ensures that a device
+ * which hangs in PREPARE or CONFIG doesn't stall the autoconnect queue. */
+#define ACTIVATING_SLOT_TIMEOUT_SEC 30
+
+typedef struct {
+	NMPolicy *policy;
+	NMDevice *device;
+	guint timeout_id;
+} ActivatingSlot;
+
+static void
+_activating_slot_free (gpointer data)
+{
+	ActivatingSlot *slot = data;
+
+	nm_clear_g_source (&slot->timeout_id);
+	g_slice_free (ActivatingSlot, slot);
+}
+
+static void _activating_devices_remove (NMPolicy *self, NMDevice *device);
+
+static gboolean
+_activating_slot_timeout_cb (gpointer user_data)
+{
+	ActivatingSlot *slot = user_data;
+
+	slot->timeout_id = 0;
+	_LOGD (LOGD_DEVICE, "auto-activate: device %s still activating after %d seconds, release its slot",
+	       nm_device_get_iface (slot->device),
+	       ACTIVATING_SLOT_TIMEOUT_SEC);
+	_activating_devices_remove (slot->policy, slot->device);
+	return G_SOURCE_REMOVE;
+}
+
+/* With "main.autoconnect-concurrency", we limit the number of devices
+ * that were auto-activated by the autoconnect queue and did not yet leave
+ * the CONFIG state. In PREPARE and CONFIG the device sets up the link, which
+ * is the main-loop heavy part of an activation. Further autoconnect checks
+ * stay queued until a slot is free. Activations that were not started by the
+ * queue don't take a slot. */
+static void
+_activating_devices_add (NMPolicy *self, NMDevice *device)
+{
+	NMPolicyPrivate *priv = NM_POLICY_GET_PRIVATE (self);
+	ActivatingSlot *slot;
+
+	if (priv->autoconnect_concurrency == 0)
+		return;
+
+	if (g_hash_table_contains (priv->activating_devices, device))
+		return;
+
+	slot = g_slice_new (ActivatingSlot);
+	*slot = (ActivatingSlot) {
+		.policy     = self,
+		.device     = device,
+		.timeout_id = g_timeout_add_seconds (ACTIVATING_SLOT_TIMEOUT_SEC, _activating_slot_timeout_cb, slot),
+	};
+	g_hash_table_insert (priv->activating_devices, device, slot);
+}
+
+static void
+_activating_devices_remove (NMPolicy *self, NMDevice *device)
+{
+	NMPolicyPrivate *priv = NM_POLICY_GET_PRIVATE (self);
+
+	if (!g_hash_table_remove (priv->activating_devices, device))
+		return;
+
+	_autoactivate_batch_schedule (self);
+}
+
 static void
 activate_data_free (ActivateData *data)
 {
+	NMPolicyPrivate *priv = NM_POLICY_GET_PRIVATE (data->policy);
+
 	nm_device_remove_pending_action (data->device, NM_PENDING_ACTION_AUTOACTIVATE, TRUE);
 	c_list_unlink_stale (&data->pending_lst);
-	nm_clear_g_source (&data->autoactivate_id);
+	g_hash_table_remove (priv->pending_activation_checks_idx, data->device);
 	g_object_unref (data->device);
 	g_slice_free (ActivateData, data);
 }
@@ -1195,6 +1307,8 @@ pending_ac_state_changed (NMActiveConnection *ac, guint state, guint reason, NMP
 	NMSettingsConnection *con;
 
 	if (state >= NM_ACTIVE_CONNECTION_STATE_DEACTIVATING) {
+		_activating_devices_remove (self, nm_active_connection_get_device (ac));
+
 		/* The AC is being deactivated before the device had a chance
 		 * to move to PREPARE. Schedule a new auto-activation on the
 		 * device, but block the current connection to avoid an activation
@@ -1243,7 +1357,7 @@ auto_activate_device (NMPolicy *self,
 	if (!nm_device_autoconnect_allowed (device))
 		return;
 
-	connections = nm_manager_get_activatable_connections (priv->manager, TRUE, TRUE, &len);
+	connections = nm_manager_get_autoconnect_candidates (priv->manager, device, &len);
 	if (!connections[0])
 		return;
 
@@ -1304,6 +1418,8 @@ auto_activate_device (NMPolicy *self,
 		return;
 	}
 
+	_activating_devices_add (self, device);
+
 	/* Subscribe to AC state-changed signal to detect when the
 	 * activation fails in early stages without changing device
 	 * state.
@@ -1316,17 +1432,46 @@ auto_activate_device (NMPolicy *self,
 }
 
 static gboolean
-auto_activate_device_cb (gpointer user_data)
+auto_activate_batch_cb (gpointer user_data)
 {
-	ActivateData *data = user_data;
+	NMPolicy *self = user_data;
+	NMPolicyPrivate *priv = NM_POLICY_GET_PRIVATE (self);
+	ActivateData *data;
+	gint64 deadline_ms;
+	guint n_processed = 0;
+
+	deadline_ms = nm_utils_get_monotonic_timestamp_ms () + AUTOACTIVATE_BATCH_MAX_MSEC;
+
+	while ((data = c_list_first_entry (&priv->pending_activation_checks, ActivateData, pending_lst))) {
+		nm_assert (NM_IS_DEVICE (data->device));
+		nm_assert (!data->in_progress);
+
+		if (_autoconnect_concurrency_reached (self)) {
+			_LOGT (LOGD_DEVICE, "auto-activate: %u devices are activating, delay %u pending devices",
+			       g_hash_table_size (priv->activating_devices),
+			       g_hash_table_size (priv->pending_activation_checks_idx));
+			priv->autoactivate_batch_id = 0;
+			return G_SOURCE_REMOVE;
+		}
+
+		if (   n_processed > 0
+		    && nm_utils_get_monotonic_timestamp_ms () >= deadline_ms) {
+			_LOGT (LOGD_DEVICE, "auto-activate: checked %u devices, continue with %u pending devices later",
+			       n_processed,
+			       g_hash_table_size (priv->pending_activation_checks_idx));
+			return G_SOURCE_CONTINUE;
+		}
 
-	g_assert (data);
-	g_assert (NM_IS_POLICY (data->policy));
-	g_assert (NM_IS_DEVICE (data->device));
+		/* the device stays in the queue while we check it. That way, a
+		 * schedule_activate_check() for the same device is ignored and
+		 * device_removed() does not free it. */
+		data->in_progress = TRUE;
+		auto_activate_device (self, data->device);
+		activate_data_free (data);
+		n_processed++;
+	}
 
-	data->autoactivate_id = 0;
-	auto_activate_device (data->policy, data->device);
-	activate_data_free (data);
+	priv->autoactivate_batch_id = 0;
 	return G_SOURCE_REMOVE;
 }
 
@@ -1334,13 +1479,8 @@ static ActivateData *
 find_pending_activation (NMPolicy *self, NMDevice *device)
 {
 	NMPolicyPrivate *priv = NM_POLICY_GET_PRIVATE (self);
-	ActivateData *data;
 
-	c_list_for_each_entry (data, &priv->pending_activation_checks, pending_lst) {
-		if (data->device == device)
-			return data;
-	}
-	return NULL;
+	return g_hash_table_lookup (priv->pending_activation_checks_idx, device);
 }
 
 /*****************************************************************************/
@@ -1532,8 +1672,10 @@ schedule_activate_check (NMPolicy *self, NMDevice *device)
 	data = g_slice_new0 (ActivateData);
 	data->policy = self;
 	data->device = g_object_ref (device);
-	data->autoactivate_id = g_idle_add (auto_activate_device_cb, data);
 	c_list_link_tail (&priv->pending_activation_checks, &data->pending_lst);
+	g_hash_table_insert (priv->pending_activation_checks_idx, device, data);
+
+	_autoactivate_batch_schedule (self);
 }
 
 static gboolean
@@ -1764,6 +1906,11 @@ device_state_changed (NMDevice *device,
 	NMIP6Config *ip6_config;
 	NMSettingConnection *s_con = NULL;
 
+	/* the slot was taken by auto_activate_device(). */
+	if (!NM_IN_SET (new_state, NM_DEVICE_STATE_PREPARE,
+	                           NM_DEVICE_STATE_CONFIG))
+		_activating_devices_remove (self, device);
+
 	switch (nm_device_state_reason_check (reason)) {
 	case NM_DEVICE_STATE_REASON_GSM_SIM_PIN_REQUIRED:
 	case NM_DEVICE_STATE_REASON_GSM_SIM_PUK_REQUIRED:
@@ -2078,9 +2225,11 @@ device_removed (NMManager *manager, NMDevice *device, gpointer user_data)
 
 	/* Clear any idle callbacks for this device */
 	data = find_pending_activation (self, device);
-	if (data && data->autoactivate_id)
+	if (data && !data->in_progress)
 		activate_data_free (data);
 
+	_activating_devices_remove (self, device);
+
 	if (g_hash_table_remove (priv->devices, device))
 		devices_list_unregister (self, device);
 
@@ -2566,6 +2715,12 @@ nm_policy_init (NMPolicy *self)
 	gs_free char *hostname_mode = NULL;
 
 	c_list_init (&priv->pending_activation_checks);
+	priv->pending_activation_checks_idx = g_hash_table_new (nm_direct_hash, NULL);
+	priv->activating_devices = g_hash_table_new_full (nm_direct_hash, NULL, NULL, _activating_slot_free);
+	priv->autoconnect_concurrency = nm_config_data_get_value_int64 (NM_CONFIG_GET_DATA_ORIG,
+	                                                                NM_CONFIG_KEYFILE_GROUP_MAIN,
+	                                                                NM_CONFIG_KEYFILE_KEY_MAIN_AUTOCONNECT_CONCURRENCY,
+	                                                                10, 0, G_MAXUINT32, 0);
 
 	priv->netns = g_object_ref (nm_netns_get ());
 
@@ -2672,8 +2827,10 @@ dispose (GObject *object)
 	nm_clear_g_object (&priv->activating_ac6);
 	g_clear_pointer (&priv->pending_active_connections, g_hash_table_unref);
 
+	nm_clear_g_source (&priv->autoactivate_batch_id);
 	c_list_for_each_entry_safe (data, data_safe, &priv->pending_activation_checks, pending_lst)
 		activate_data_free (data);
+	g_hash_table_remove_all (priv->activating_devices);
 
 	g_slist_free_full (priv->pending_secondaries, (GDestroyNotify) pending_secondary_data_free);
 	priv->pending_secondaries = NULL;
@@ -2747,6 +2904,10 @@ finalize (GObject *object)
 
 	g_hash_table_unref (priv->devices);
 
+	nm_assert (g_hash_table_size (priv->pending_activation_checks_idx) == 0);
+	g_hash_table_unref (priv->pending_activation_checks_idx);
+	g_hash_table_unref (priv->activating_devices);
+
 	G_OBJECT_CLASS (nm_policy_parent_class)->finalize (object);
 
 	g_object_unref (priv->netns);
@@ -0,0 +1,381 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Copyright (C) 2019 Red Hat, Inc.
+ */
+
+#include "nm-default.h"
+
+#include "nm-state-snapshot.h"
+
+#include <unistd.h>
+
+#include "c-list/src/c-list.h"
+#include "nm-glib-aux/nm-io-utils.h"
+#include "nm-utils.h"
+#include "nm-manager.h"
+#include "nm-act-request.h"
+#include "nm-ip4-config.h"
+#include "nm-ip6-config.h"
+#include "devices/nm-device.h"
+#include "settings/nm-settings-connection.h"
+
+/*****************************************************************************/
+
+/* The snapshot is a keyfile in NM_STATE_SNAPSHOT_FILE that is replaced
+ * atomically. Readers never see a partially written file and don't need
+ * any locking. The "generation" key increases with each write. */
+#define SNAPSHOT_VERSION 1
+
+/* write the file at most once per interval. */
+#define SNAPSHOT_MIN_INTERVAL_MSEC 200
+
+#define SNAPSHOT_GROUP_SNAPSHOT  "snapshot"
+#define SNAPSHOT_GROUP_MANAGER   "manager"
+
+struct _NMStateSnapshot {
+	NMManager *manager;
+	GHashTable *devices;
+	CList devices_lst_head;
+	guint64 generation;
+	gint64 last_write_msec;
+	guint write_id;
+};
+
+typedef struct {
+	CList devices_lst;
+	NMDevice *device;
+
+	/* the rendered keyfile group of the device. Only regenerated after
+	 * the device changed. */
+	char *data;
+} DeviceData;
+
+/*****************************************************************************/
+
+#define _NMLOG_DOMAIN      LOGD_CORE
+#define _NMLOG(level, ...) __NMLOG_DEFAULT (level, _NMLOG_DOMAIN, "state-snapshot", __VA_ARGS__)
+
+/*****************************************************************************/
+
+static char *
+_device_render (NMDevice *device)
+{
+	gs_unref_keyfile GKeyFile *kf = NULL;
+	NMActRequest *req;
+	NMIP4Config *ip4_config;
+	NMIP6Config *ip6_config;
+	const char *group;
+	const char *s;
+
+	group = nm_dbus_object_get_path (NM_DBUS_OBJECT (device));
+	if (!group)
+		return NULL;
+
+	kf = g_key_file_new ();
+
+	g_key_file_set_string (kf, group, "interface", nm_device_get_iface (device));
+	if ((s = nm_device_get_ip_iface (device)))
+		g_key_file_set_string (kf, group, "ip-interface", s);
+	g_key_file_set_integer (kf, group, "ifindex", nm_device_get_ifindex (device));
+	g_key_file_set_string (kf, group, "type", nm_device_get_type_desc (device));
+	g_key_file_set_integer (kf, group, "state", nm_device_get_state (device));
+
+	req = nm_device_get_act_request (device);
+	if (req) {
+		NMSettingsConnection *sett_conn;
+
+		sett_conn = nm_act_request_get_settings_connection (req);
+		if (sett_conn) {
+			g_key_file_set_string (kf, group, "connection-id", nm_settings_connection_get_id (sett_conn));
+			g_key_file_set_string (kf, group, "connection-uuid", nm_settings_connection_get_uuid (sett_conn));
+		}
+		g_key_file_set_integer (kf, group, "active-connection-state",
+		                        nm_active_connection_get_state (NM_ACTIVE_CONNECTION (req)));
+	}
+
+	ip4_config = nm_device_get_ip4_config (device);
+	if (ip4_config) {
+		gs_unref_ptrarray GPtrArray *strv = g_ptr_array_new_with_free_func (g_free);
+		const NMPlatformIP4Address *addr;
+		NMDedupMultiIter ipconf_iter;
+		char buf[NM_UTILS_INET_ADDRSTRLEN];
+
+		nm_ip_config_iter_ip4_address_for_each (&ipconf_iter, ip4_config, &addr) {
+			g_ptr_array_add (strv,
+			                 g_strdup_printf ("%s/%u",
+			                                  nm_utils_inet4_ntop (addr->address, buf),
+			                                  (guint) addr->plen));
+		}
+		if (strv->len > 0) {
+			g_key_file_set_string_list (kf, group, "ip4-address",
+			                            (const char *const*) strv->pdata, strv->len);
+		}
+	}
+
+	ip6_config = nm_device_get_ip6_config (device);
+	if (ip6_config) {
+		gs_unref_ptrarray GPtrArray *strv = g_ptr_array_new_with_free_func (g_free);
+		const NMPlatformIP6Address *addr;
+		NMDedupMultiIter ipconf_iter;
+		char buf[NM_UTILS_INET_ADDRSTRLEN];
+
+		nm_ip_config_iter_ip6_address_for_each (&ipconf_iter, ip6_config, &addr) {
+			g_ptr_array_add (strv,
+			                 g_strdup_printf ("%s/%u",
+			                                  nm_utils_inet6_ntop (&addr->address, buf),
+			                                  (guint) addr->plen));
+		}
+		if (strv->len > 0) {
+			g_key_file_set_string_list (kf, group, "ip6-address",
+			                            (const char *const*) strv->pdata, strv->len);
+		}
+	}
+
+	return g_key_file_to_data (kf, NULL, NULL);
+}
+
+static char *
+_manager_render (NMStateSnapshot *self)
+{
+	gs_unref_keyfile GKeyFile *kf = NULL;
+	guint connectivity = NM_CONNECTIVITY_UNKNOWN;
+
+	g_object_get (self->manager, NM_MANAGER_CONNECTIVITY, &connectivity, NULL);
+
+	kf = g_key_file_new ();
+
+	g_key_file_set_integer (kf, SNAPSHOT_GROUP_SNAPSHOT, "version", SNAPSHOT_VERSION);
+	g_key_file_set_uint64 (kf, SNAPSHOT_GROUP_SNAPSHOT, "generation", self->generation);
+
+	g_key_file_set_integer (kf, SNAPSHOT_GROUP_MANAGER, "state", nm_manager_get_state (self->manager));
+	g_key_file_set_integer (kf, SNAPSHOT_GROUP_MANAGER, "connectivity", connectivity);
+	g_key_file_set_integer (kf, SNAPSHOT_GROUP_MANAGER, "devices", g_hash_table_size (self->devices));
+
+	return g_key_file_to_data (kf, NULL, NULL);
+}
+
+/*****************************************************************************/
+
+static void
+_write (NMStateSnapshot *self)
+{
+	gs_free_error GError *error = NULL;
+	gs_free char *manager_data = NULL;
+	nm_auto_free_gstring GString *str = NULL;
+	DeviceData *dev_data;
+	guint n_rendered = 0;
+
+	self->generation++;
+
+	manager_data = _manager_render (self);
+	str = g_string_new (manager_data);
+
+	c_list_for_each_entry (dev_data, &self->devices_lst_head, devices_lst) {
+		if (!dev_data->data) {
+			dev_data->data = _device_render (dev_data->device);
+			if (!dev_data->data)
+				continue;
+			n_rendered++;
+		}
+		g_string_append_c (str, '\n');
+		g_string_append (str, dev_data->data);
+	}
+
+	if (!nm_utils_file_set_contents (NM_STATE_SNAPSHOT_FILE,
+	                                 str->str,
+	                                 str->len,
+	                                 0644,
+	                                 NULL,
+	                                 &error)) {
+		_LOGW ("failure to write %s: %s", NM_STATE_SNAPSHOT_FILE, error->message);
+		return;
+	}
+
+	_LOGT ("wrote generation %"G_GUINT64_FORMAT" (%u of %u devices updated)",
+	       self->generation,
+	       n_rendered,
+	       g_hash_table_size (self->devices));
+}
+
+static gboolean
+_write_cb (gpointer user_data)
+{
+	NMStateSnapshot *self = user_data;
+
+	self->write_id = 0;
+	self->last_write_msec = nm_utils_get_monotonic_timestamp_ms ();
+	_write (self);
+	return G_SOURCE_REMOVE;
+}
+
+static void
+_schedule_write (NMStateSnapshot *self)
+{
+	gint64 delay_msec;
+
+	if (self->write_id != 0)
+		return;
+
+	delay_msec = 0;
+	if (self->last_write_msec != 0) {
+		delay_msec =   self->last_write_msec + SNAPSHOT_MIN_INTERVAL_MSEC
+		             - nm_utils_get_monotonic_timestamp_ms ();
+	}
+
+	if (delay_msec > 0)
+		self->write_id = g_timeout_add (delay_msec, _write_cb, self);
+	else
+		self->write_id = g_idle_add (_write_cb, self);
+}
+
+/*****************************************************************************/
+
+static void
+_device_changed (NMStateSnapshot *self, NMDevice *device)
+{
+	DeviceData *dev_data;
+
+	dev_data = g_hash_table_lookup (self->devices, device);
+	if (!dev_data)
+		return;
+
+	nm_clear_g_free (&dev_data->data);
+	_schedule_write (self);
+}
+
+static void
+device_state_changed (NMDevice *device,
+                      NMDeviceState new_state,
+                      NMDeviceState old_state,
+                      NMDeviceStateReason reason,
+                      gpointer user_data)
+{
+	_device_changed (user_data, device);
+}
+
+static void
+device_ip_config_changed (NMDevice *device,
+                          NMIPConfig *new_config,
+                          NMIPConfig *old_config,
+                          gpointer user_data)
+{
+	_device_changed (user_data, device);
+}
+
+static void
+device_notify (NMDevice *device,
+               GParamSpec *pspec,
+               gpointer user_data)
+{
+	_device_changed (user_data, device);
+}
+
+static void
+device_data_free (gpointer data)
+{
+	DeviceData *dev_data = data;
+
+	c_list_unlink_stale (&dev_data->devices_lst);
+	g_free (dev_data->data);
+	g_slice_free (DeviceData, dev_data);
+}
+
+static void
+device_added (NMManager *manager,
+              NMDevice *device,
+              gpointer user_data)
+{
+	NMStateSnapshot *self = user_data;
+	DeviceData *dev_data;
+
+	if (g_hash_table_contains (self->devices, device))
+		return;
+
+	dev_data = g_slice_new0 (DeviceData);
+	dev_data->device = device;
+	c_list_link_tail (&self->devices_lst_head, &dev_data->devices_lst);
+	g_hash_table_insert (self->devices, device, dev_data);
+
+	g_signal_connect (device, NM_DEVICE_STATE_CHANGED, G_CALLBACK (device_state_changed), self);
+	g_signal_connect (device, NM_DEVICE_IP4_CONFIG_CHANGED, G_CALLBACK (device_ip_config_changed), self);
+	g_signal_connect (device, NM_DEVICE_IP6_CONFIG_CHANGED, G_CALLBACK (device_ip_config_changed), self);
+	g_signal_connect (device, "notify::" NM_DEVICE_IFACE, G_CALLBACK (device_notify), self);
+	g_signal_connect (device, "notify::" NM_DEVICE_IP_IFACE, G_CALLBACK (device_notify), self);
+
+	_schedule_write (self);
+}
+
+static void
+device_removed (NMManager *manager,
+                NMDevice *device,
+                gpointer user_data)
+{
+	NMStateSnapshot *self = user_data;
+
+	g_signal_handlers_disconnect_by_data (device, self);
+	if (g_hash_table_remove (self->devices, device))
+		_schedule_write (self);
+}
+
+static void
+manager_notify (NMManager *manager,
+                GParamSpec *pspec,
+                gpointer user_data)
+{
+	_schedule_write (user_data);
+}
+
+/*****************************************************************************/
+
+NMStateSnapshot *
+nm_state_snapshot_new (NMManager *manager)
+{
+	NMStateSnapshot *self;
+	const CList *tmp_lst;
+	NMDevice *device;
+
+	g_return_val_if_fail (NM_IS_MANAGER (manager), NULL);
+
+	self = g_slice_new0 (NMStateSnapshot);
+	self->manager = manager;
+	self->devices = g_hash_table_new_full (nm_direct_hash, NULL, NULL, device_data_free);
+	c_list_init (&self->devices_lst_head);
+
+	g_signal_connect (manager, NM_MANAGER_INTERNAL_DEVICE_ADDED, G_CALLBACK (device_added), self);
+	g_signal_connect (manager, NM_MANAGER_INTERNAL_DEVICE_REMOVED, G_CALLBACK (device_removed), self);
+	g_signal_connect (manager, "notify::" NM_MANAGER_STATE, G_CALLBACK (manager_notify), self);
+	g_signal_connect (manager, "notify::" NM_MANAGER_CONNECTIVITY, G_CALLBACK (manager_notify), self);
+
+	nm_manager_for_each_device (manager, device, tmp_lst)
+		device_added (manager, device, self);
+
+	_LOGD ("publish state snapshot in %s", NM_STATE_SNAPSHOT_FILE);
+
+	_schedule_write (self);
+	return self;
+}
+
+void
+nm_state_snapshot_free (NMStateSnapshot *self)
+{
+	GHashTableIter iter;
+	NMDevice *device;
+
+	if (!self)
+		return;
+
+	g_signal_handlers_disconnect_by_data (self->manager, self);
+
+	g_hash_table_iter_init (&iter, self->devices);
+	while (g_hash_table_iter_next (&iter, (gpointer *) &device, NULL))
+		g_signal_handlers_disconnect_by_data (device, self);
+	g_hash_table_destroy (self->devices);
+	nm_assert (c_list_is_empty (&self->devices_lst_head));
+
+	nm_clear_g_source (&self->write_id);
+
+	/* don't leave a stale snapshot behind. */
+	unlink (NM_STATE_SNAPSHOT_FILE);
+
+	g_slice_free (NMStateSnapshot, self);
+}
@@ -0,0 +1,17 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Copyright (C) 2019 Red Hat, Inc.
+ */
+
+#ifndef __NM_STATE_SNAPSHOT_H__
+#define __NM_STATE_SNAPSHOT_H__
+
+#define NM_STATE_SNAPSHOT_FILE NMRUNDIR "/state-snapshot"
+
+typedef struct _NMStateSnapshot NMStateSnapshot;
+
+NMStateSnapshot *nm_state_snapshot_new (NMManager *manager);
+
+void nm_state_snapshot_free (NMStateSnapshot *self);
+
+#endif /* __NM_STATE_SNAPSHOT_H__ */
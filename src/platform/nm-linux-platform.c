@@ -414,6 +414,80 @@ typedef struct {
 
 /*****************************************************************************/
 
+typedef struct {
+	/* if set, only routes in one of these tables are cached. */
+	GHashTable *tables;
+
+	/* if @has_protocols, only routes with one of these protocols are cached. */
+	guint32 protocols[256 / 32];
+	bool has_protocols:1;
+} RouteCacheFilter;
+
+static gboolean
+_route_cache_filter_match (const RouteCacheFilter *filter,
+                           guint32 table,
+                           guint8 protocol)
+{
+	if (   filter->tables
+	    && !g_hash_table_contains (filter->tables, GUINT_TO_POINTER (table)))
+		return FALSE;
+
+	if (   filter->has_protocols
+	    && !NM_FLAGS_HAS (filter->protocols[protocol / 32], ((guint32) 1) << (protocol % 32)))
+		return FALSE;
+
+	return TRUE;
+}
+
+static gboolean
+_route_cache_filter_match_obj (const RouteCacheFilter *filter,
+                               const NMPObject *obj)
+{
+	const NMPlatformIPRoute *r = NMP_OBJECT_CAST_IP_ROUTE (obj);
+
+	return _route_cache_filter_match (filter,
+	                                  nm_platform_route_table_uncoerce (r->table_coerced, TRUE),
+	                                  nmp_utils_ip_config_source_coerce_to_rtprot (r->rt_source));
+}
+
+/* The ring of receive buffers for event_handler_recvmsgs(). The netlink
+ * socket is drained with one recvmmsg() call into @n_slots buffers of
+ * @slot_size bytes. The datagrams are then parsed in place, one after
+ * the other. */
+typedef struct {
+	struct iovec iov;
+	struct sockaddr_nl nla;
+	union {
+		struct cmsghdr cmsg;
+		char buf[CMSG_SPACE (sizeof (struct ucred))];
+	} control;
+} EventRecvSlot;
+
+typedef struct {
+	struct mmsghdr *msgs;
+	EventRecvSlot *slots;
+	unsigned char *data;
+	gsize slot_size;
+	guint n_slots;
+
+	/* the number of slots to use for the next refill. This grows,
+	 * when recvmmsg() filled all slots. */
+	guint n_slots_want;
+
+	/* the slots [idx, n_filled) contain datagrams that were received
+	 * but not yet processed. */
+	guint n_filled;
+	guint idx;
+
+	/* >0 while processing a datagram of the ring. In that case, the ring
+	 * must not be refilled, because that would overwrite the buffer
+	 * that is currently parsed. */
+	guint processing;
+} EventRecvRing;
+
+#define EVENT_RECV_RING_SLOTS_MIN 4u
+#define EVENT_RECV_RING_SLOTS_MAX 32u
+
 typedef struct {
 	struct nl_sock *genl;
 
@@ -423,14 +497,64 @@ typedef struct {
 	guint32 nlh_seq_last_handled;
 #endif
 	guint32 nlh_seq_last_seen;
+	bool nlh_strict_chk:1;
 	GIOChannel *event_channel;
 	guint event_id;
 
+	FILE *capture_file;
+	gint64 capture_start_ns;
+
+	EventRecvRing recv_ring;
+	NMLinuxPlatformNetlinkStats netlink_stats;
+
+	struct {
+		/* the number of multicast events seen, per refresh-all type. */
+		guint64 n_events[_REFRESH_ALL_TYPE_NUM];
+
+		/* snapshots of @n_events at the start of the current and the
+		 * previous activity window. */
+		guint64 n_events_cur[_REFRESH_ALL_TYPE_NUM];
+		guint64 n_events_prev[_REFRESH_ALL_TYPE_NUM];
+		gint64 window_start_ns;
+
+		/* the types that were not refreshed right away after an overflow,
+		 * and the timeout to refresh them later. */
+		DelayedActionType deferred;
+		guint deferred_id;
+
+		int rx_buffer_size;
+	} resync;
+
+	RouteCacheFilter route_cache_filter;
+
 	guint32 pruning[_REFRESH_ALL_TYPE_NUM];
 
 	GHashTable *sysctl_get_prev_values;
 	CList sysctl_list;
 
+	struct {
+		/* ifname -> GHashTable (path -> value) */
+		GHashTable *by_ifname;
+		guint64 n_hits;
+		guint64 n_misses;
+		guint64 n_invalidations;
+		bool enabled:1;
+	} sysctl_read_cache;
+
+	struct {
+		/* protects the @superseded flag of the entries, which is read by
+		 * the worker thread. */
+		GMutex lock;
+
+		/* SysctlBatchEntry that are queued for the next batch. */
+		CList lst_pending;
+
+		/* SysctlBatchEntry that are handed to the worker thread. */
+		CList lst_in_flight;
+
+		guint idle_id;
+	} sysctl_batch;
+
 	NMUdevClient *udev_client;
 
 	struct {
@@ -459,6 +583,11 @@ struct _NMLinuxPlatformClass {
 	NMPlatformClass parent;
 };
 
+NM_GOBJECT_PROPERTIES_DEFINE_BASE (
+	PROP_CACHE_ROUTE_TABLES,
+	PROP_CACHE_ROUTE_PROTOCOLS,
+);
+
 G_DEFINE_TYPE (NMLinuxPlatform, nm_linux_platform, NM_TYPE_PLATFORM)
 
 #define NM_LINUX_PLATFORM_GET_PRIVATE(self) _NM_GET_PRIVATE (self, NMLinuxPlatform, NM_IS_LINUX_PLATFORM, NMPlatform)
@@ -529,6 +658,7 @@ static void cache_on_change (NMPlatform *platform,
                              const NMPObject *obj_new);
 static void cache_prune_all (NMPlatform *platform);
 static gboolean event_handler_read_netlink (NMPlatform *platform, gboolean wait_for_acks);
+static void _resync_window_update (NMPlatform *platform);
 static struct nl_sock *_genl_sock (NMLinuxPlatform *platform);
 
 /*****************************************************************************/
@@ -3040,7 +3170,7 @@ _new_from_nl_addr (struct nlmsghdr *nlh, gboolean id_only)
 
 /* Copied and heavily modified from libnl3's rtnl_route_parse() and parse_multipath(). */
 static NMPObject *
-_new_from_nl_route (struct nlmsghdr *nlh, gboolean id_only)
+_new_from_nl_route (struct nlmsghdr *nlh, gboolean id_only, const RouteCacheFilter *filter)
 {
 	static const struct nla_policy policy[] = {
 		[RTA_TABLE]     = { .type = NLA_U32 },
@@ -3094,6 +3224,17 @@ _new_from_nl_route (struct nlmsghdr *nlh, gboolean id_only)
 	                     policy) < 0)
 		return NULL;
 
+	if (   filter
+	    && !_route_cache_filter_match (filter,
+	                                   tb[RTA_TABLE]
+	                                     ? nla_get_u32 (tb[RTA_TABLE])
+	                                     : (guint32) rtm->rtm_table,
+	                                   rtm->rtm_protocol)) {
+		/* the route is excluded from caching by configuration. Drop it
+		 * right away, before parsing the rest of the message. */
+		return NULL;
+	}
+
 	/*****************************************************************/
 
 	is_v4 = rtm->rtm_family == AF_INET;
@@ -3603,11 +3744,17 @@ _new_from_nl_tfilter (struct nlmsghdr *nlh, gboolean id_only)
  *   If a cache is given, the object is completed with information from the cache.
  * @nlh: the netlink message header
  * @id_only: whether only to create an empty object with only the ID fields set.
+ * @route_filter: (allow-none): if given, routes that don't match the filter
+ *   are dropped.
  *
  * Returns: %NULL or a newly created NMPObject instance.
  **/
 static NMPObject *
-nmp_object_new_from_nl (NMPlatform *platform, const NMPCache *cache, struct nl_msg *msg, gboolean id_only)
+nmp_object_new_from_nl (NMPlatform *platform,
+                        const NMPCache *cache,
+                        struct nl_msg *msg,
+                        gboolean id_only,
+                        const RouteCacheFilter *route_filter)
 {
 	struct nlmsghdr *msghdr;
 
@@ -3629,7 +3776,7 @@ nmp_object_new_from_nl (NMPlatform *platform, const NMPCache *cache, struct nl_m
 	case RTM_NEWROUTE:
 	case RTM_DELROUTE:
 	case RTM_GETROUTE:
-		return _new_from_nl_route (msghdr, id_only);
+		return _new_from_nl_route (msghdr, id_only, route_filter);
 	case RTM_NEWRULE:
 	case RTM_DELRULE:
 	case RTM_GETRULE:
@@ -4541,6 +4688,208 @@ sysctl_set_internal (NMPlatform *platform,
 
 /*****************************************************************************/
 
+/*****************************************************************************/
+
+/* The optional sysctl read cache.
+ *
+ * Only per-interface sysctls below /proc/sys/net/ipv{4,6}/{conf,neigh}/$IFNAME/
+ * are cached. Kernel does not change them on its own, except in
+ * reaction to a change of the link (like the IPv6 mtu). Hence, the entries
+ * of an interface are dropped on every change of the link in the cache, and
+ * an entry is dropped when we write to it. The cache is per platform
+ * instance, hence per network namespace. Writes by other processes are
+ * not noticed, that's why the cache must be enabled explicitly. */
+
+#define SYSCTL_READ_CACHE_LOG_INTERVAL 1000u
+
+static gboolean
+_sysctl_read_cache_parse_path (const char *path,
+                               char *out_ifname)
+{
+	static const char *const prefixes[] = {
+		"/proc/sys/net/ipv4/conf/",
+		"/proc/sys/net/ipv6/conf/",
+		"/proc/sys/net/ipv4/neigh/",
+		"/proc/sys/net/ipv6/neigh/",
+	};
+	const char *ifname;
+	const char *slash;
+	guint i;
+
+	if (!NM_STR_HAS_PREFIX (path, "/proc/sys/net/ipv"))
+		return FALSE;
+
+	for (i = 0; i < G_N_ELEMENTS (prefixes); i++) {
+		if (!g_str_has_prefix (path, prefixes[i]))
+			continue;
+
+		ifname = &path[strlen (prefixes[i])];
+		slash = strchr (ifname, '/');
+		if (   !slash
+		    || slash == ifname
+		    || slash - ifname >= IFNAMSIZ
+		    || strchr (&slash[1], '/'))
+			return FALSE;
+
+		memcpy (out_ifname, ifname, slash - ifname);
+		out_ifname[slash - ifname] = '\0';
+		return TRUE;
+	}
+
+	return FALSE;
+}
+
+static void
+_sysctl_read_cache_log_stats (NMPlatform *platform)
+{
+	NMLinuxPlatformPrivate *priv = NM_LINUX_PLATFORM_GET_PRIVATE (platform);
+	guint64 n = priv->sysctl_read_cache.n_hits + priv->sysctl_read_cache.n_misses;
+
+	_LOGD ("sysctl: read cache: %"G_GUINT64_FORMAT" hits, %"G_GUINT64_FORMAT" misses (%u%% hit rate), %"G_GUINT64_FORMAT" invalidations",
+	       priv->sysctl_read_cache.n_hits,
+	       priv->sysctl_read_cache.n_misses,
+	       n > 0 ? (guint) (priv->sysctl_read_cache.n_hits * 100u / n) : 0u,
+	       priv->sysctl_read_cache.n_invalidations);
+}
+
+static const char *
+_sysctl_read_cache_lookup (NMPlatform *platform, const char *path)
+{
+	NMLinuxPlatformPrivate *priv = NM_LINUX_PLATFORM_GET_PRIVATE (platform);
+	char ifname[IFNAMSIZ];
+	GHashTable *values;
+	const char *value = NULL;
+
+	if (!priv->sysctl_read_cache.enabled)
+		return NULL;
+	if (!_sysctl_read_cache_parse_path (path, ifname))
+		return NULL;
+
+	if (priv->sysctl_read_cache.by_ifname) {
+		values = g_hash_table_lookup (priv->sysctl_read_cache.by_ifname, ifname);
+		if (values)
+			value = g_hash_table_lookup (values, path);
+	}
+
+	if (value)
+		priv->sysctl_read_cache.n_hits++;
+	else
+		priv->sysctl_read_cache.n_misses++;
+
+	if (   _LOGD_ENABLED ()
+	    && (priv->sysctl_read_cache.n_hits + priv->sysctl_read_cache.n_misses) % SYSCTL_READ_CACHE_LOG_INTERVAL == 0)
+		_sysctl_read_cache_log_stats (platform);
+
+	return value;
+}
+
+static void
+_sysctl_read_cache_add (NMPlatform *platform, const char *path, const char *value)
+{
+	NMLinuxPlatformPrivate *priv = NM_LINUX_PLATFORM_GET_PRIVATE (platform);
+	char ifname[IFNAMSIZ];
+	GHashTable *values;
+
+	if (!priv->sysctl_read_cache.enabled)
+		return;
+	if (!_sysctl_read_cache_parse_path (path, ifname))
+		return;
+
+	if (!priv->sysctl_read_cache.by_ifname) {
+		priv->sysctl_read_cache.by_ifname = g_hash_table_new_full (nm_str_hash,
+		                                                           g_str_equal,
+		                                                           g_free,
+		                                                           (GDestroyNotify) g_hash_table_unref);
+	}
+
+	values = g_hash_table_lookup (priv->sysctl_read_cache.by_ifname, ifname);
+	if (!values) {
+		values = g_hash_table_new_full (nm_str_hash, g_str_equal, g_free, g_free);
+		g_hash_table_insert (priv->sysctl_read_cache.by_ifname, g_strdup (ifname), values);
+	}
+	g_hash_table_insert (values, g_strdup (path), g_strdup (value));
+}
+
+static void
+_sysctl_read_cache_invalidate_path (NMPlatform *platform, const char *path)
+{
+	NMLinuxPlatformPrivate *priv = NM_LINUX_PLATFORM_GET_PRIVATE (platform);
+	char ifname[IFNAMSIZ];
+	GHashTable *values;
+
+	/* the path may be passed together with a dirfd, but an absolute path
+	 * refers to the same file regardless. Relative paths never parse
+	 * to a cached sysctl. */
+	if (!priv->sysctl_read_cache.by_ifname)
+		return;
+	if (!_sysctl_read_cache_parse_path (path, ifname))
+		return;
+
+	values = g_hash_table_lookup (priv->sysctl_read_cache.by_ifname, ifname);
+	if (   values
+	    && g_hash_table_remove (values, path))
+		priv->sysctl_read_cache.n_invalidations++;
+}
+
+static void
+_sysctl_read_cache_invalidate_ifname (NMPlatform *platform, const char *ifname)
+{
+	NMLinuxPlatformPrivate *priv = NM_LINUX_PLATFORM_GET_PRIVATE (platform);
+
+	if (   !priv->sysctl_read_cache.by_ifname
+	    || !ifname
+	    || !ifname[0])
+		return;
+
+	if (g_hash_table_remove (priv->sysctl_read_cache.by_ifname, ifname))
+		priv->sysctl_read_cache.n_invalidations++;
+}
+
+static void
+_sysctl_read_cache_invalidate_all (NMPlatform *platform)
+{
+	NMLinuxPlatformPrivate *priv = NM_LINUX_PLATFORM_GET_PRIVATE (platform);
+
+	if (   priv->sysctl_read_cache.by_ifname
+	    && g_hash_table_size (priv->sysctl_read_cache.by_ifname) > 0) {
+		g_hash_table_remove_all (priv->sysctl_read_cache.by_ifname);
+		priv->sysctl_read_cache.n_invalidations++;
+	}
+}
+
+/**
+ * nm_linux_platform_set_sysctl_read_cache:
+ * @platform: the #NMLinuxPlatform
+ * @enabled: whether to cache the values of per-interface sysctls.
+ *
+ * Enable or disable the sysctl read cache. When enabled, reading per-interface
+ * sysctls below /proc/sys/net is served from a cache, which is invalidated
+ * by our own writes and by changes of the link. Writes by other processes
+ * are not noticed.
+ */
+void
+nm_linux_platform_set_sysctl_read_cache (NMPlatform *platform,
+                                         gboolean enabled)
+{
+	NMLinuxPlatformPrivate *priv;
+
+	g_return_if_fail (NM_IS_LINUX_PLATFORM (platform));
+
+	priv = NM_LINUX_PLATFORM_GET_PRIVATE (platform);
+
+	if (priv->sysctl_read_cache.enabled == (!!enabled))
+		return;
+
+	_LOGD ("sysctl: %s read cache", enabled ? "enable" : "disable");
+	priv->sysctl_read_cache.enabled = enabled;
+	if (!enabled)
+		nm_clear_pointer (&priv->sysctl_read_cache.by_ifname, g_hash_table_unref);
+}
+
+/*****************************************************************************/
+
+static void _sysctl_batch_supersede (NMPlatform *platform, const char *pathid, const char *path);
+
 static gboolean
 sysctl_set (NMPlatform *platform,
             const char *pathid,
@@ -4561,6 +4910,9 @@ sysctl_set (NMPlatform *platform,
 		return FALSE;
 	}
 
+	_sysctl_batch_supersede (platform, pathid, path);
+	_sysctl_read_cache_invalidate_path (platform, path);
+
 	return sysctl_set_internal (platform, pathid, dirfd, path, value);
 }
 
@@ -4601,6 +4953,8 @@ sysctl_async_cb (GObject *object,
 
 	info = g_task_get_task_data (task);
 
+	_sysctl_read_cache_invalidate_path (info->platform, info->path);
+
 	if (g_task_propagate_boolean (task, &error)) {
 		platform = info->platform;
 		_LOGD ("sysctl: successfully set-async '%s' to values '%s'",
@@ -4697,6 +5051,8 @@ sysctl_set_async (NMPlatform *platform,
 
 	ASSERT_SYSCTL_ARGS (pathid, dirfd, path);
 
+	_sysctl_read_cache_invalidate_path (platform, path);
+
 	if (dirfd >= 0) {
 		dirfd_dup = fcntl (dirfd, F_DUPFD_CLOEXEC, 0);
 		if (dirfd_dup < 0) {
@@ -4737,110 +5093,403 @@ sysctl_set_async (NMPlatform *platform,
 	g_object_unref (task);
 }
 
-static GSList *sysctl_clear_cache_list;
-
-void
-_nm_logging_clear_platform_logging_cache (void)
-{
-	while (sysctl_clear_cache_list) {
-		NMLinuxPlatformPrivate *priv = NM_LINUX_PLATFORM_GET_PRIVATE (sysctl_clear_cache_list->data);
-
-		sysctl_clear_cache_list = g_slist_delete_link (sysctl_clear_cache_list, sysctl_clear_cache_list);
+/*****************************************************************************/
 
-		g_hash_table_destroy (priv->sysctl_get_prev_values);
-		priv->sysctl_get_prev_values = NULL;
-	}
-}
+/* Batched sysctl writes.
+ *
+ * sysctl_set_batched() only queues the write. All writes queued during
+ * one main loop iteration are handed at once to a worker thread of the
+ * GTask pool, which writes them in order. Consecutive writes to files in
+ * the same directory (like /proc/sys/net/ipv6/conf/$IFNAME/) reuse
+ * the directory fd. Afterwards, the callbacks of the individual writes
+ * are invoked on the main thread.
+ *
+ * Only one batch is in flight at a time, and a synchronous sysctl_set()
+ * to the same path supersedes a queued or in-flight write. That way, the
+ * order of writes is preserved. */
 
 typedef struct {
-	const char *path;
 	CList lst;
+	char *pathid;
+	char *path;
+	int dirfd;
 	char *value;
-	char path_data[];
-} SysctlCacheEntry;
+	NMPlatformAsyncCallback callback;
+	gpointer callback_data;
 
-static void
-sysctl_cache_entry_free (SysctlCacheEntry *entry)
+	/* the result of the write, set by the worker thread. */
+	int errsv;
+
+	/* set under the sysctl_batch.lock, when a later synchronous write
+	 * to the same path happened. */
+	bool superseded:1;
+} SysctlBatchEntry;
+
+static const char *
+_sysctl_batch_entry_get_id (const SysctlBatchEntry *entry)
 {
-	c_list_unlink_stale (&entry->lst);
-	g_free (entry->value);
-	g_free (entry);
+	return entry->pathid ?: entry->path;
 }
 
 static void
-_log_dbg_sysctl_get_impl (NMPlatform *platform, const char *pathid, const char *contents)
+_sysctl_batch_entry_complete (NMPlatform *platform, SysctlBatchEntry *entry, gboolean is_disposing)
 {
-	NMLinuxPlatformPrivate *priv = NM_LINUX_PLATFORM_GET_PRIVATE (platform);
-	SysctlCacheEntry *entry = NULL;
+	gs_free_error GError *error = NULL;
 
-	if (!priv->sysctl_get_prev_values) {
-		sysctl_clear_cache_list = g_slist_prepend (sysctl_clear_cache_list, platform);
-		c_list_init (&priv->sysctl_list);
-		priv->sysctl_get_prev_values = g_hash_table_new_full (nm_pstr_hash,
-		                                                      nm_pstr_equal,
-		                                                      (GDestroyNotify) sysctl_cache_entry_free,
-		                                                      NULL);
-	} else
-		entry = g_hash_table_lookup (priv->sysctl_get_prev_values, &pathid);
+	c_list_unlink_stale (&entry->lst);
 
-	if (entry) {
-		if (!nm_streq (entry->value, contents)) {
-			gs_free char *contents_escaped = g_strescape (contents, NULL);
-			gs_free char *prev_value_escaped = g_strescape (entry->value, NULL);
+	if (!is_disposing)
+		_sysctl_read_cache_invalidate_path (platform, entry->path);
 
-			_LOGD ("sysctl: reading '%s': '%s' (changed from '%s' on last read)", pathid, contents_escaped, prev_value_escaped);
-			g_free (entry->value);
-			entry->value = g_strdup (contents);
+	if (entry->callback) {
+		if (is_disposing)
+			nm_utils_error_set_cancelled (&error, TRUE, "NMLinuxPlatform");
+		else if (entry->superseded) {
+			g_set_error (&error,
+			             NM_UTILS_ERROR,
+			             NM_UTILS_ERROR_UNKNOWN,
+			             "sysctl: write to '%s' was superseded",
+			             _sysctl_batch_entry_get_id (entry));
+		} else if (entry->errsv != 0) {
+			g_set_error (&error,
+			             NM_UTILS_ERROR,
+			             NM_UTILS_ERROR_UNKNOWN,
+			             "sysctl: failed setting '%s' to value '%s': %s",
+			             _sysctl_batch_entry_get_id (entry),
+			             entry->value,
+			             nm_strerror_native (entry->errsv));
 		}
-		nm_c_list_move_front (&priv->sysctl_list, &entry->lst);
-	} else {
-		gs_free char *contents_escaped = g_strescape (contents, NULL);
-		SysctlCacheEntry *old;
-		size_t len;
+		entry->callback (error, entry->callback_data);
+	}
 
-		len = strlen (pathid);
-		entry = g_malloc (sizeof (SysctlCacheEntry) + len + 1);
-		entry->value = g_strdup (contents);
-		entry->path = entry->path_data;
-		memcpy (entry->path_data, pathid, len + 1);
+	if (entry->dirfd >= 0)
+		nm_close (entry->dirfd);
+	g_free (entry->pathid);
+	g_free (entry->path);
+	g_free (entry->value);
+	g_slice_free (SysctlBatchEntry, entry);
+}
 
-		/* Remove oldest entry when the cache becomes too big */
-		if (g_hash_table_size (priv->sysctl_get_prev_values) > 1000) {
-			old = c_list_last_entry (&priv->sysctl_list, SysctlCacheEntry, lst);
-			g_hash_table_remove (priv->sysctl_get_prev_values, old);
-		}
+static void
+_sysctl_batch_supersede (NMPlatform *platform, const char *pathid, const char *path)
+{
+	NMLinuxPlatformPrivate *priv = NM_LINUX_PLATFORM_GET_PRIVATE (platform);
+	const char *id = pathid ?: path;
+	SysctlBatchEntry *entry;
 
-		_LOGD ("sysctl: reading '%s': '%s'", pathid, contents_escaped);
+	if (   c_list_is_empty (&priv->sysctl_batch.lst_pending)
+	    && c_list_is_empty (&priv->sysctl_batch.lst_in_flight))
+		return;
 
-		g_hash_table_add (priv->sysctl_get_prev_values, entry);
-		c_list_link_front (&priv->sysctl_list, &entry->lst);
+	g_mutex_lock (&priv->sysctl_batch.lock);
+	c_list_for_each_entry (entry, &priv->sysctl_batch.lst_pending, lst) {
+		if (nm_streq (_sysctl_batch_entry_get_id (entry), id))
+			entry->superseded = TRUE;
 	}
+	c_list_for_each_entry (entry, &priv->sysctl_batch.lst_in_flight, lst) {
+		if (nm_streq (_sysctl_batch_entry_get_id (entry), id))
+			entry->superseded = TRUE;
+	}
+	g_mutex_unlock (&priv->sysctl_batch.lock);
 }
 
-#define _log_dbg_sysctl_get(platform, pathid, contents) \
-	G_STMT_START { \
-		if (_LOGD_ENABLED ()) \
-			_log_dbg_sysctl_get_impl (platform, pathid, contents); \
-	} G_STMT_END
+#undef NM_THREAD_SAFE_ON_MAIN_THREAD
+#define NM_THREAD_SAFE_ON_MAIN_THREAD 0
 
-static char *
-sysctl_get (NMPlatform *platform, const char *pathid, int dirfd, const char *path)
+static void
+sysctl_batch_thread_fn (GTask *task,
+                        gpointer source_object,
+                        gpointer task_data,
+                        GCancellable *cancellable)
 {
 	nm_auto_pop_netns NMPNetns *netns = NULL;
-	GError *error = NULL;
-	gs_free char *contents = NULL;
-
-	ASSERT_SYSCTL_ARGS (pathid, dirfd, path);
-
-	if (dirfd < 0) {
-		if (!nm_platform_netns_push (platform, &netns)) {
-			errno = EBUSY;
-			return NULL;
+	NMPlatform *platform = task_data;
+	NMLinuxPlatformPrivate *priv = NM_LINUX_PLATFORM_GET_PRIVATE (platform);
+	SysctlBatchEntry *entry;
+	gs_free char *dir_path = NULL;
+	int dir_fd = -1;
+	gboolean netns_pushed = FALSE;
+
+	/* while the batch is in flight, the main thread does not modify the
+	 * list, only the @superseded flag of the entries. */
+	c_list_for_each_entry (entry, &priv->sysctl_batch.lst_in_flight, lst) {
+		const char *basename;
+		gboolean success;
+
+		if (entry->errsv != 0) {
+			/* already failed while queuing. */
+			continue;
 		}
-		pathid = path;
-	}
 
-	if (!nm_utils_file_get_contents (dirfd,
+		if (   entry->dirfd < 0
+		    && !netns_pushed) {
+			if (!nm_platform_netns_push (platform, &netns)) {
+				entry->errsv = ENETDOWN;
+				continue;
+			}
+			netns_pushed = TRUE;
+		}
+
+		g_mutex_lock (&priv->sysctl_batch.lock);
+
+		if (entry->superseded) {
+			g_mutex_unlock (&priv->sysctl_batch.lock);
+			continue;
+		}
+
+		if (entry->dirfd >= 0) {
+			success = sysctl_set_internal (platform, entry->pathid, entry->dirfd, entry->path, entry->value);
+			goto next;
+		}
+
+		/* for absolute paths, keep the parent directory open, so that the next
+		 * write to the same directory (the same interface) only needs openat(). */
+		basename = strrchr (entry->path, '/');
+		nm_assert (basename && basename > entry->path);
+		if (   !dir_path
+		    || strncmp (dir_path, entry->path, basename - entry->path) != 0
+		    || dir_path[basename - entry->path] != '\0') {
+			nm_close (nm_steal_fd (&dir_fd));
+			g_free (dir_path);
+			dir_path = g_strndup (entry->path, basename - entry->path);
+			dir_fd = open (dir_path, O_PATH | O_DIRECTORY | O_CLOEXEC);
+		}
+
+		if (dir_fd >= 0)
+			success = sysctl_set_internal (platform, entry->path, dir_fd, &basename[1], entry->value);
+		else
+			success = sysctl_set_internal (platform, NULL, -1, entry->path, entry->value);
+
+next:
+		entry->errsv = success ? 0 : (errno ?: EIO);
+		g_mutex_unlock (&priv->sysctl_batch.lock);
+	}
+
+	if (dir_fd >= 0)
+		nm_close (dir_fd);
+
+	g_task_return_boolean (task, TRUE);
+}
+
+#undef NM_THREAD_SAFE_ON_MAIN_THREAD
+#define NM_THREAD_SAFE_ON_MAIN_THREAD 1
+
+static gboolean sysctl_batch_dispatch_cb (gpointer user_data);
+
+static void
+sysctl_batch_cb (GObject *object,
+                 GAsyncResult *res,
+                 gpointer user_data)
+{
+	NMPlatform *platform = NM_PLATFORM (object);
+	NMLinuxPlatformPrivate *priv = NM_LINUX_PLATFORM_GET_PRIVATE (platform);
+	SysctlBatchEntry *entry;
+	guint n = 0;
+	guint n_failed = 0;
+	guint n_superseded = 0;
+
+	while ((entry = c_list_first_entry (&priv->sysctl_batch.lst_in_flight, SysctlBatchEntry, lst))) {
+		n++;
+		if (entry->superseded)
+			n_superseded++;
+		else if (entry->errsv != 0)
+			n_failed++;
+		_sysctl_batch_entry_complete (platform, entry, FALSE);
+	}
+
+	_LOGD ("sysctl: batch of %u writes completed (%u failed, %u superseded)",
+	       n, n_failed, n_superseded);
+
+	/* writes that were queued meanwhile, are the next batch. */
+	if (   !c_list_is_empty (&priv->sysctl_batch.lst_pending)
+	    && !priv->sysctl_batch.idle_id)
+		priv->sysctl_batch.idle_id = g_idle_add (sysctl_batch_dispatch_cb, platform);
+}
+
+static gboolean
+sysctl_batch_dispatch_cb (gpointer user_data)
+{
+	NMPlatform *platform = user_data;
+	NMLinuxPlatformPrivate *priv = NM_LINUX_PLATFORM_GET_PRIVATE (platform);
+	GTask *task;
+
+	priv->sysctl_batch.idle_id = 0;
+
+	if (!c_list_is_empty (&priv->sysctl_batch.lst_in_flight)) {
+		/* the previous batch is still in flight. sysctl_batch_cb() reschedules
+		 * us, when it completes. */
+		return G_SOURCE_REMOVE;
+	}
+
+	g_mutex_lock (&priv->sysctl_batch.lock);
+	c_list_splice (&priv->sysctl_batch.lst_in_flight, &priv->sysctl_batch.lst_pending);
+	g_mutex_unlock (&priv->sysctl_batch.lock);
+
+	/* the task keeps the platform alive until the batch completes. */
+	task = g_task_new (platform, NULL, sysctl_batch_cb, NULL);
+	g_task_set_task_data (task, platform, NULL);
+	g_task_run_in_thread (task, sysctl_batch_thread_fn);
+	g_object_unref (task);
+	return G_SOURCE_REMOVE;
+}
+
+static void
+sysctl_set_batched (NMPlatform *platform,
+                    const char *pathid,
+                    int dirfd,
+                    const char *path,
+                    const char *value,
+                    NMPlatformAsyncCallback callback,
+                    gpointer callback_data)
+{
+	NMLinuxPlatformPrivate *priv = NM_LINUX_PLATFORM_GET_PRIVATE (platform);
+	SysctlBatchEntry *entry;
+	int dirfd_dup = -1;
+
+	ASSERT_SYSCTL_ARGS (pathid, dirfd, path);
+
+	if (dirfd >= 0)
+		dirfd_dup = fcntl (dirfd, F_DUPFD_CLOEXEC, 0);
+
+	_sysctl_read_cache_invalidate_path (platform, path);
+
+	entry = g_slice_new (SysctlBatchEntry);
+	*entry = (SysctlBatchEntry) {
+		.pathid        = g_strdup (pathid),
+		.path          = g_strdup (path),
+		.dirfd         = dirfd_dup,
+		.value         = g_strdup (value),
+		.callback      = callback,
+		.callback_data = callback_data,
+	};
+
+	if (   dirfd >= 0
+	    && dirfd_dup < 0) {
+		/* the worker skips this entry and reports the error. */
+		entry->errsv = errno ?: EBADF;
+	}
+
+	g_mutex_lock (&priv->sysctl_batch.lock);
+	c_list_link_tail (&priv->sysctl_batch.lst_pending, &entry->lst);
+	g_mutex_unlock (&priv->sysctl_batch.lock);
+
+	if (!priv->sysctl_batch.idle_id)
+		priv->sysctl_batch.idle_id = g_idle_add (sysctl_batch_dispatch_cb, platform);
+}
+
+/*****************************************************************************/
+
+static GSList *sysctl_clear_cache_list;
+
+void
+_nm_logging_clear_platform_logging_cache (void)
+{
+	while (sysctl_clear_cache_list) {
+		NMLinuxPlatformPrivate *priv = NM_LINUX_PLATFORM_GET_PRIVATE (sysctl_clear_cache_list->data);
+
+		sysctl_clear_cache_list = g_slist_delete_link (sysctl_clear_cache_list, sysctl_clear_cache_list);
+
+		g_hash_table_destroy (priv->sysctl_get_prev_values);
+		priv->sysctl_get_prev_values = NULL;
+	}
+}
+
+typedef struct {
+	const char *path;
+	CList lst;
+	char *value;
+	char path_data[];
+} SysctlCacheEntry;
+
+static void
+sysctl_cache_entry_free (SysctlCacheEntry *entry)
+{
+	c_list_unlink_stale (&entry->lst);
+	g_free (entry->value);
+	g_free (entry);
+}
+
+static void
+_log_dbg_sysctl_get_impl (NMPlatform *platform, const char *pathid, const char *contents)
+{
+	NMLinuxPlatformPrivate *priv = NM_LINUX_PLATFORM_GET_PRIVATE (platform);
+	SysctlCacheEntry *entry = NULL;
+
+	if (!priv->sysctl_get_prev_values) {
+		sysctl_clear_cache_list = g_slist_prepend (sysctl_clear_cache_list, platform);
+		c_list_init (&priv->sysctl_list);
+		priv->sysctl_get_prev_values = g_hash_table_new_full (nm_pstr_hash,
+		                                                      nm_pstr_equal,
+		                                                      (GDestroyNotify) sysctl_cache_entry_free,
+		                                                      NULL);
+	} else
+		entry = g_hash_table_lookup (priv->sysctl_get_prev_values, &pathid);
+
+	if (entry) {
+		if (!nm_streq (entry->value, contents)) {
+			gs_free char *contents_escaped = g_strescape (contents, NULL);
+			gs_free char *prev_value_escaped = g_strescape (entry->value, NULL);
+
+			_LOGD ("sysctl: reading '%s': '%s' (changed from '%s' on last read)", pathid, contents_escaped, prev_value_escaped);
+			g_free (entry->value);
+			entry->value = g_strdup (contents);
+		}
+		nm_c_list_move_front (&priv->sysctl_list, &entry->lst);
+	} else {
+		gs_free char *contents_escaped = g_strescape (contents, NULL);
+		SysctlCacheEntry *old;
+		size_t len;
+
+		len = strlen (pathid);
+		entry = g_malloc (sizeof (SysctlCacheEntry) + len + 1);
+		entry->value = g_strdup (contents);
+		entry->path = entry->path_data;
+		memcpy (entry->path_data, pathid, len + 1);
+
+		/* Remove oldest entry when the cache becomes too big */
+		if (g_hash_table_size (priv->sysctl_get_prev_values) > 1000) {
+			old = c_list_last_entry (&priv->sysctl_list, SysctlCacheEntry, lst);
+			g_hash_table_remove (priv->sysctl_get_prev_values, old);
+		}
+
+		_LOGD ("sysctl: reading '%s': '%s'", pathid, contents_escaped);
+
+		g_hash_table_add (priv->sysctl_get_prev_values, entry);
+		c_list_link_front (&priv->sysctl_list, &entry->lst);
+	}
+}
+
+#define _log_dbg_sysctl_get(platform, pathid, contents) \
+	G_STMT_START { \
+		if (_LOGD_ENABLED ()) \
+			_log_dbg_sysctl_get_impl (platform, pathid, contents); \
+	} G_STMT_END
+
+static char *
+sysctl_get (NMPlatform *platform, const char *pathid, int dirfd, const char *path)
+{
+	nm_auto_pop_netns NMPNetns *netns = NULL;
+	GError *error = NULL;
+	gs_free char *contents = NULL;
+	const char *cached;
+
+	ASSERT_SYSCTL_ARGS (pathid, dirfd, path);
+
+	if (dirfd < 0) {
+		cached = _sysctl_read_cache_lookup (platform, path);
+		if (cached) {
+			_LOGT ("sysctl: reading '%s': cached", path);
+			return g_strdup (cached);
+		}
+
+		if (!nm_platform_netns_push (platform, &netns)) {
+			errno = EBUSY;
+			return NULL;
+		}
+		pathid = path;
+	}
+
+	if (!nm_utils_file_get_contents (dirfd,
 	                                 path,
 	                                 1*1024*1024,
 	                                 NM_UTILS_FILE_GET_CONTENTS_FLAG_NONE,
@@ -4870,6 +5519,9 @@ sysctl_get (NMPlatform *platform, const char *pathid, int dirfd, const char *pat
 
 	_log_dbg_sysctl_get (platform, pathid, contents);
 
+	if (dirfd < 0)
+		_sysctl_read_cache_add (platform, path, contents);
+
 	/* errno is left undefined (as we don't return NULL). */
 	return g_steal_pointer (&contents);
 }
@@ -5079,6 +5731,26 @@ delayed_action_refresh_all_in_progress (NMPlatform *platform, DelayedActionType
 	return (priv->delayed_action.refresh_all_in_progress[refresh_all_type] > 0);
 }
 
+static gboolean
+delayed_action_wait_for_route_get_in_progress (NMPlatform *platform, guint32 seq_number)
+{
+	NMLinuxPlatformPrivate *priv = NM_LINUX_PLATFORM_GET_PRIVATE (platform);
+	guint i;
+
+	if (!NM_FLAGS_HAS (priv->delayed_action.flags, DELAYED_ACTION_TYPE_WAIT_FOR_NL_RESPONSE))
+		return FALSE;
+
+	for (i = 0; i < priv->delayed_action.list_wait_for_nl_response->len; i++) {
+		const DelayedActionWaitForNlResponseData *data = &g_array_index (priv->delayed_action.list_wait_for_nl_response, DelayedActionWaitForNlResponseData, i);
+
+		if (   data->response_type == DELAYED_ACTION_RESPONSE_TYPE_ROUTE_GET
+		    && data->response.out_route_get
+		    && data->seq_number == seq_number)
+			return TRUE;
+	}
+	return FALSE;
+}
+
 static void
 delayed_action_wait_for_nl_response_complete (NMPlatform *platform,
                                               guint idx,
@@ -5463,6 +6135,13 @@ cache_on_change (NMPlatform *platform,
 	switch (klass->obj_type) {
 	case NMP_OBJECT_TYPE_LINK:
 		{
+			if (obj_old)
+				_sysctl_read_cache_invalidate_ifname (platform, obj_old->link.name);
+			if (   obj_new
+			    && (   !obj_old
+			        || !nm_streq (obj_old->link.name, obj_new->link.name)))
+				_sysctl_read_cache_invalidate_ifname (platform, obj_new->link.name);
+
 			/* check whether changing a slave link can cause a master link (bridge or bond) to go up/down */
 			if (   obj_old
 			    && nmp_cache_link_connected_needs_toggle_by_ifindex (cache, obj_old->link.master, obj_new, obj_old))
@@ -5658,13 +6337,18 @@ cache_on_change (NMPlatform *platform,
 
 /*****************************************************************************/
 
+/* sequence numbers with this bit set are never used for our own requests.
+ * They are reserved for replayed messages (see nm_linux_platform_replay()). */
+#define NLH_SEQ_REPLAY_BIT ((guint32) 0x80000000u)
+
 static guint32
 _nlh_seq_next_get (NMLinuxPlatformPrivate *priv)
 {
 	/* generate a new sequence number, but never return zero.
 	 * Wrapping numbers are not a problem, because we don't rely
 	 * on strictly increasing sequence numbers. */
-	return (++priv->nlh_seq_next) ?: (++priv->nlh_seq_next);
+	priv->nlh_seq_next = (priv->nlh_seq_next + 1) & ~NLH_SEQ_REPLAY_BIT;
+	return priv->nlh_seq_next ?: (++priv->nlh_seq_next);
 }
 
 /**
@@ -5817,9 +6501,25 @@ do_request_link (NMPlatform *platform, int ifindex, const char *name)
 	delayed_action_handle_all (platform, FALSE);
 }
 
+/*
+ * _nl_msg_new_dump:
+ * @obj_type: the object type to dump.
+ * @preferred_addr_family: the address family of the request.
+ * @strict_chk: whether the socket has NETLINK_GET_STRICT_CHK enabled.
+ *   In that case, kernel requires the full header of the object type and
+ *   honors the filter arguments. Otherwise, a plain rtgenmsg header
+ *   is sent and the filter arguments are ignored.
+ * @ifindex: if positive, only dump addresses/routes of this interface.
+ * @table: if non-zero, only dump routes of this table.
+ * @protocol: if non-zero, only dump routes of this protocol.
+ */
 static struct nl_msg *
 _nl_msg_new_dump (NMPObjectType obj_type,
-                  int preferred_addr_family)
+                  int preferred_addr_family,
+                  gboolean strict_chk,
+                  int ifindex,
+                  guint32 table,
+                  guint8 protocol)
 {
 	nm_auto_nlmsg struct nl_msg *nlmsg = NULL;
 	const NMPClass *klass;
@@ -5828,6 +6528,8 @@ _nl_msg_new_dump (NMPObjectType obj_type,
 
 	nm_assert (klass);
 	nm_assert (klass->rtm_gettype > 0);
+	nm_assert (ifindex >= 0);
+	nm_assert (strict_chk || (ifindex == 0 && table == 0 && protocol == 0));
 
 	nlmsg = nlmsg_alloc_simple (klass->rtm_gettype, NLM_F_DUMP);
 
@@ -5855,13 +6557,68 @@ _nl_msg_new_dump (NMPObjectType obj_type,
 	case NMP_OBJECT_TYPE_IP4_ROUTE:
 	case NMP_OBJECT_TYPE_IP6_ROUTE:
 	case NMP_OBJECT_TYPE_ROUTING_RULE:
-		{
+		if (!strict_chk) {
 			const struct rtgenmsg gmsg = {
 				.rtgen_family = preferred_addr_family,
 			};
 
 			if (nlmsg_append_struct (nlmsg, &gmsg) < 0)
 				g_return_val_if_reached (NULL);
+			break;
+		}
+
+		switch (klass->obj_type) {
+		case NMP_OBJECT_TYPE_LINK:
+			{
+				const struct ifinfomsg ifi = {
+					.ifi_family = preferred_addr_family,
+				};
+
+				if (nlmsg_append_struct (nlmsg, &ifi) < 0)
+					g_return_val_if_reached (NULL);
+			}
+			break;
+		case NMP_OBJECT_TYPE_IP4_ADDRESS:
+		case NMP_OBJECT_TYPE_IP6_ADDRESS:
+			{
+				const struct ifaddrmsg ifa = {
+					.ifa_family = preferred_addr_family,
+					.ifa_index  = ifindex,
+				};
+
+				if (nlmsg_append_struct (nlmsg, &ifa) < 0)
+					g_return_val_if_reached (NULL);
+			}
+			break;
+		case NMP_OBJECT_TYPE_IP4_ROUTE:
+		case NMP_OBJECT_TYPE_IP6_ROUTE:
+			{
+				const struct rtmsg rtmsg = {
+					.rtm_family   = preferred_addr_family,
+					.rtm_table    = table < 256 ? table : RT_TABLE_UNSPEC,
+					.rtm_protocol = protocol,
+				};
+
+				if (nlmsg_append_struct (nlmsg, &rtmsg) < 0)
+					g_return_val_if_reached (NULL);
+				if (table != 0)
+					NLA_PUT_U32 (nlmsg, RTA_TABLE, table);
+				if (ifindex > 0)
+					NLA_PUT_U32 (nlmsg, RTA_OIF, ifindex);
+			}
+			break;
+		case NMP_OBJECT_TYPE_ROUTING_RULE:
+			{
+				const struct fib_rule_hdr frh = {
+					.family = preferred_addr_family,
+				};
+
+				if (nlmsg_append_struct (nlmsg, &frh) < 0)
+					g_return_val_if_reached (NULL);
+			}
+			break;
+		default:
+			nm_assert_not_reached ();
 		}
 		break;
 	default:
@@ -5869,6 +6626,49 @@ _nl_msg_new_dump (NMPObjectType obj_type,
 	}
 
 	return g_steal_pointer (&nlmsg);
+
+nla_put_failure:
+	g_return_val_if_reached (NULL);
+}
+
+/* If the route cache is restricted to exactly one table and/or one protocol,
+ * let kernel filter full route dumps accordingly. Routes outside the filter
+ * would be dropped by _new_from_nl_route() anyway. */
+static void
+_route_cache_filter_get_dump_args (const RouteCacheFilter *filter,
+                                   guint32 *out_table,
+                                   guint8 *out_protocol)
+{
+	*out_table = 0;
+	*out_protocol = 0;
+
+	if (   filter->tables
+	    && g_hash_table_size (filter->tables) == 1) {
+		GHashTableIter iter;
+		gpointer key;
+
+		g_hash_table_iter_init (&iter, filter->tables);
+		if (g_hash_table_iter_next (&iter, &key, NULL))
+			*out_table = GPOINTER_TO_UINT (key);
+	}
+
+	if (filter->has_protocols) {
+		guint32 protocol = 0;
+		guint n = 0;
+		guint i;
+
+		for (i = 1; i < 256; i++) {
+			if (NM_FLAGS_HAS (filter->protocols[i / 32], ((guint32) 1) << (i % 32))) {
+				protocol = i;
+				n++;
+			}
+		}
+		/* RTPROT_UNSPEC (0) cannot be used as kernel filter, because
+		 * it means "all". */
+		if (   n == 1
+		    && !NM_FLAGS_HAS (filter->protocols[0], (guint32) 1))
+			*out_protocol = protocol;
+	}
 }
 
 static void
@@ -5914,6 +6714,8 @@ do_request_all_no_delayed_actions (NMPlatform *platform, DelayedActionType actio
 		const RefreshAllInfo *refresh_all_info = refresh_all_type_get_info (refresh_all_type);
 		nm_auto_nlmsg struct nl_msg *nlmsg = NULL;
 		int *out_refresh_all_in_progress;
+		guint32 table;
+		guint8 protocol;
 
 		out_refresh_all_in_progress = &priv->delayed_action.refresh_all_in_progress[refresh_all_type];
 		nm_assert (*out_refresh_all_in_progress >= 0);
@@ -5935,8 +6737,19 @@ do_request_all_no_delayed_actions (NMPlatform *platform, DelayedActionType actio
 
 		event_handler_read_netlink (platform, FALSE);
 
+		table = 0;
+		protocol = 0;
+		if (   priv->nlh_strict_chk
+		    && NM_IN_SET (refresh_all_info->obj_type, NMP_OBJECT_TYPE_IP4_ROUTE,
+		                                              NMP_OBJECT_TYPE_IP6_ROUTE))
+			_route_cache_filter_get_dump_args (&priv->route_cache_filter, &table, &protocol);
+
 		nlmsg = _nl_msg_new_dump (refresh_all_info->obj_type,
-		                          refresh_all_info->addr_family);
+		                          refresh_all_info->addr_family,
+		                          priv->nlh_strict_chk,
+		                          0,
+		                          table,
+		                          protocol);
 		if (!nlmsg)
 			goto next_after_fail;
 
@@ -5956,10 +6769,92 @@ next_after_fail:
 	}
 }
 
+/* Like do_request_all_no_delayed_actions(), but only refresh the objects of
+ * @refresh_all_type that belong to @ifindex. This requires a kernel that
+ * supports NETLINK_GET_STRICT_CHK, so that the dump can be filtered
+ * by kernel. Returns %FALSE, if the request could not be sent and
+ * the caller should fallback to a full dump. */
+static gboolean
+do_request_ifindex_no_delayed_actions (NMPlatform *platform,
+                                       RefreshAllType refresh_all_type,
+                                       int ifindex)
+{
+	NMLinuxPlatformPrivate *priv = NM_LINUX_PLATFORM_GET_PRIVATE (platform);
+	const RefreshAllInfo *refresh_all_info = refresh_all_type_get_info (refresh_all_type);
+	nm_auto_nlmsg struct nl_msg *nlmsg = NULL;
+	int *out_refresh_all_in_progress;
+	NMPLookup lookup;
+
+	nm_assert (priv->nlh_strict_chk);
+	nm_assert (ifindex > 0);
+	nm_assert (NM_IN_SET (refresh_all_info->obj_type, NMP_OBJECT_TYPE_IP4_ADDRESS,
+	                                                  NMP_OBJECT_TYPE_IP6_ADDRESS,
+	                                                  NMP_OBJECT_TYPE_IP4_ROUTE,
+	                                                  NMP_OBJECT_TYPE_IP6_ROUTE));
+
+	event_handler_read_netlink (platform, FALSE);
+
+	nlmsg = _nl_msg_new_dump (refresh_all_info->obj_type,
+	                          refresh_all_info->addr_family,
+	                          TRUE,
+	                          ifindex,
+	                          0,
+	                          0);
+	if (!nlmsg)
+		return FALSE;
+
+	/* only the objects of this interface are marked dirty, so that
+	 * cache_prune_all() leaves the other interfaces alone. */
+	priv->pruning[refresh_all_type] += 1;
+	nmp_lookup_init_object (&lookup, refresh_all_info->obj_type, ifindex);
+	nmp_cache_dirty_set_all_main (nm_platform_get_cache (platform),
+	                              &lookup);
+
+	out_refresh_all_in_progress = &priv->delayed_action.refresh_all_in_progress[refresh_all_type];
+	nm_assert (*out_refresh_all_in_progress >= 0);
+	*out_refresh_all_in_progress += 1;
+
+	_LOGt ("do-request-ifindex: dump %s for ifindex %d",
+	       nmp_class_from_type (refresh_all_info->obj_type)->obj_type_name,
+	       ifindex);
+
+	if (_nl_send_nlmsg (platform,
+	                    nlmsg,
+	                    NULL,
+	                    NULL,
+	                    DELAYED_ACTION_RESPONSE_TYPE_REFRESH_ALL_IN_PROGRESS,
+	                    out_refresh_all_in_progress) < 0) {
+		nm_assert (*out_refresh_all_in_progress > 0);
+		*out_refresh_all_in_progress -= 1;
+	}
+
+	/* like for a full dump, a failure to send is not retried. */
+	return TRUE;
+}
+
 static void
 do_request_one_type_by_needle_object (NMPlatform *platform, const NMPObject *obj_needle)
 {
-	do_request_all_no_delayed_actions (platform, delayed_action_refresh_from_needle_object (obj_needle));
+	NMLinuxPlatformPrivate *priv = NM_LINUX_PLATFORM_GET_PRIVATE (platform);
+	DelayedActionType action_type = delayed_action_refresh_from_needle_object (obj_needle);
+
+	/* If a full refresh of this type is anyway pending, there is no point
+	 * in a filtered dump. */
+	if (   priv->nlh_strict_chk
+	    && NM_IN_SET (NMP_OBJECT_GET_TYPE (obj_needle), NMP_OBJECT_TYPE_IP4_ADDRESS,
+	                                                    NMP_OBJECT_TYPE_IP6_ADDRESS,
+	                                                    NMP_OBJECT_TYPE_IP4_ROUTE,
+	                                                    NMP_OBJECT_TYPE_IP6_ROUTE)
+	    && NMP_OBJECT_CAST_OBJ_WITH_IFINDEX (obj_needle)->ifindex > 0
+	    && !NM_FLAGS_ANY (priv->delayed_action.flags, action_type)
+	    && do_request_ifindex_no_delayed_actions (platform,
+	                                              refresh_all_type_from_needle_object (obj_needle),
+	                                              NMP_OBJECT_CAST_OBJ_WITH_IFINDEX (obj_needle)->ifindex)) {
+		delayed_action_handle_all (platform, FALSE);
+		return;
+	}
+
+	do_request_all_no_delayed_actions (platform, action_type);
 	delayed_action_handle_all (platform, FALSE);
 }
 
@@ -6041,6 +6936,7 @@ event_valid_msg (NMPlatform *platform, struct nl_msg *msg, gboolean handle_event
 	char buf_nlmsghdr[400];
 	gboolean is_del = FALSE;
 	gboolean is_dump = FALSE;
+	gboolean is_route_get = FALSE;
 	NMPCache *cache = nm_platform_get_cache (platform);
 
 	msghdr = nlmsg_hdr (msg);
@@ -6081,7 +6977,19 @@ event_valid_msg (NMPlatform *platform, struct nl_msg *msg, gboolean handle_event
 		is_del = TRUE;
 	}
 
-	obj = nmp_object_new_from_nl (platform, cache, msg, is_del);
+	priv = NM_LINUX_PLATFORM_GET_PRIVATE (platform);
+
+	/* the route cache filter only restricts what is cached from dumps and
+	 * events. The reply to nm_platform_ip_route_get() must always be parsed. */
+	if (   msghdr->nlmsg_type == RTM_NEWROUTE
+	    && delayed_action_wait_for_route_get_in_progress (platform, msghdr->nlmsg_seq))
+		is_route_get = TRUE;
+
+	obj = nmp_object_new_from_nl (platform,
+	                              cache,
+	                              msg,
+	                              is_del,
+	                              is_route_get ? NULL : &priv->route_cache_filter);
 	if (!obj) {
 		_LOGT ("event-notification: %s: ignore",
 		       nl_nlmsghdr_to_str (msghdr, buf_nlmsghdr, sizeof (buf_nlmsghdr)));
@@ -6136,7 +7044,6 @@ event_valid_msg (NMPlatform *platform, struct nl_msg *msg, gboolean handle_event
 			is_ipv6 = NMP_OBJECT_GET_TYPE (obj) == NMP_OBJECT_TYPE_IP6_ROUTE;
 			if (is_ipv6 || NM_FLAGS_HAS (obj->ip_route.r_rtm_flags, RTM_F_CLONED)) {
 				nm_assert (is_ipv6 || !nmp_object_is_alive (obj));
-				priv = NM_LINUX_PLATFORM_GET_PRIVATE (platform);
 				if (NM_FLAGS_HAS (priv->delayed_action.flags, DELAYED_ACTION_TYPE_WAIT_FOR_NL_RESPONSE)) {
 					guint i;
 
@@ -6157,8 +7064,14 @@ event_valid_msg (NMPlatform *platform, struct nl_msg *msg, gboolean handle_event
 				}
 			}
 
-			cache_op = nmp_cache_update_netlink_route (cache,
-			                                           obj,
+			if (   is_route_get
+			    && !_route_cache_filter_match_obj (&priv->route_cache_filter, obj)) {
+				/* the route was only parsed for the waiting route-get request. */
+				break;
+			}
+
+			cache_op = nmp_cache_update_netlink_route (cache,
+			                                           obj,
 			                                           is_dump,
 			                                           msghdr->nlmsg_flags,
 			                                           &obj_old,
@@ -6332,6 +7245,32 @@ do_add_addrroute (NMPlatform *platform,
 	return wait_for_nl_response_to_nmerr (seq_result);
 }
 
+static gboolean
+_delete_object_result_is_success (const NMPObject *obj_id,
+                                  WaitForNlResponseResult seq_result,
+                                  const char **out_log_detail)
+{
+	const char *log_detail = "";
+	gboolean success = TRUE;
+
+	if (seq_result == WAIT_FOR_NL_RESPONSE_RESULT_RESPONSE_OK) {
+		/* ok */
+	} else if (NM_IN_SET (-((int) seq_result), ESRCH, ENOENT))
+		log_detail = ", meaning the object was already removed";
+	else if (   NM_IN_SET (-((int) seq_result), ENXIO)
+	         && NM_IN_SET (NMP_OBJECT_GET_TYPE (obj_id), NMP_OBJECT_TYPE_IP6_ADDRESS)) {
+		/* On RHEL7 kernel, deleting a non existing address fails with ENXIO */
+		log_detail = ", meaning the address was already removed";
+	} else if (   NM_IN_SET (-((int) seq_result), EADDRNOTAVAIL)
+	           && NM_IN_SET (NMP_OBJECT_GET_TYPE (obj_id), NMP_OBJECT_TYPE_IP4_ADDRESS, NMP_OBJECT_TYPE_IP6_ADDRESS))
+		log_detail = ", meaning the address was already removed";
+	else
+		success = FALSE;
+
+	NM_SET_OUT (out_log_detail, log_detail);
+	return success;
+}
+
 static gboolean
 do_delete_object (NMPlatform *platform, const NMPObject *obj_id, struct nl_msg *nlmsg)
 {
@@ -6340,7 +7279,7 @@ do_delete_object (NMPlatform *platform, const NMPObject *obj_id, struct nl_msg *
 	int nle;
 	char s_buf[256];
 	gboolean success;
-	const char *log_detail = "";
+	const char *log_detail;
 
 	event_handler_read_netlink (platform, FALSE);
 
@@ -6357,20 +7296,7 @@ do_delete_object (NMPlatform *platform, const NMPObject *obj_id, struct nl_msg *
 
 	nm_assert (seq_result);
 
-	success = TRUE;
-	if (seq_result == WAIT_FOR_NL_RESPONSE_RESULT_RESPONSE_OK) {
-		/* ok */
-	} else if (NM_IN_SET (-((int) seq_result), ESRCH, ENOENT))
-		log_detail = ", meaning the object was already removed";
-	else if (   NM_IN_SET (-((int) seq_result), ENXIO)
-	         && NM_IN_SET (NMP_OBJECT_GET_TYPE (obj_id), NMP_OBJECT_TYPE_IP6_ADDRESS)) {
-		/* On RHEL7 kernel, deleting a non existing address fails with ENXIO */
-		log_detail = ", meaning the address was already removed";
-	} else if (   NM_IN_SET (-((int) seq_result), EADDRNOTAVAIL)
-	           && NM_IN_SET (NMP_OBJECT_GET_TYPE (obj_id), NMP_OBJECT_TYPE_IP4_ADDRESS, NMP_OBJECT_TYPE_IP6_ADDRESS))
-		log_detail = ", meaning the address was already removed";
-	else
-		success = FALSE;
+	success = _delete_object_result_is_success (obj_id, seq_result, &log_detail);
 
 	_NMLOG (success ? LOGL_DEBUG : LOGL_WARN,
 	        "do-delete-%s[%s]: %s%s",
@@ -6397,6 +7323,148 @@ do_delete_object (NMPlatform *platform, const NMPObject *obj_id, struct nl_msg *
 	return success;
 }
 
+/*****************************************************************************/
+
+/* Batched requests: instead of sending one netlink request and waiting for
+ * its ACK before sending the next, pack many requests into few sendmsg() calls
+ * and collect all ACKs afterwards.
+ *
+ * The number of requests in flight is bounded. For one, the ACKs (and the
+ * notifications that go along with them) must fit into the receive buffer of
+ * the socket. Also, matching a response to its sequence number in
+ * event_seq_check() is linear in the number of pending requests. */
+#define NL_BATCH_SEND_SIZE      (32 * 1024)
+#define NL_BATCH_MAX_IN_FLIGHT  256
+
+static void
+_nl_send_batch_flush (NMPlatform *platform,
+                      struct iovec *iov,
+                      struct nl_msg *const *nlmsgs,
+                      guint len,
+                      WaitForNlResponseResult *seq_results,
+                      char **errmsgs)
+{
+	NMLinuxPlatformPrivate *priv = NM_LINUX_PLATFORM_GET_PRIVATE (platform);
+	struct sockaddr_nl nladdr = {
+		.nl_family = AF_NETLINK,
+	};
+	struct msghdr msg = {
+		.msg_name = &nladdr,
+		.msg_namelen = sizeof (nladdr),
+		.msg_iov = iov,
+		.msg_iovlen = len,
+	};
+	int try_count = 0;
+	guint i;
+	int errsv;
+
+	if (len == 0)
+		return;
+
+again:
+	if (sendmsg (nl_socket_get_fd (priv->nlh), &msg, 0) < 0) {
+		errsv = errno;
+		if (errsv == EINTR && try_count++ < 100)
+			goto again;
+		_LOGD ("netlink: nl-send-batch: failed sending %u messages: %s (%d)",
+		       len, nm_strerror_native (errsv), errsv);
+		/* we didn't get a response from kernel, but report the
+		 * errno from sendmsg() for each request. */
+		for (i = 0; i < len; i++)
+			seq_results[i] = -errsv;
+		return;
+	}
+
+	for (i = 0; i < len; i++) {
+		delayed_action_schedule_WAIT_FOR_NL_RESPONSE (platform,
+		                                              nlmsg_hdr (nlmsgs[i])->nlmsg_seq,
+		                                              &seq_results[i],
+		                                              errmsgs ? &errmsgs[i] : NULL,
+		                                              DELAYED_ACTION_RESPONSE_TYPE_VOID,
+		                                              NULL);
+	}
+}
+
+/**
+ * _nl_send_batch:
+ * @platform: the #NMPlatform instance.
+ * @nlmsgs: the requests to send.
+ * @len: the number of requests in @nlmsgs.
+ * @seq_results: (out): an array of length @len. On return, it contains
+ *   the result for each request.
+ * @errmsgs: (out) (allow-none): an array of length @len for the extended
+ *   error messages. Must be initialized to %NULL and freed by the caller.
+ *
+ * Sends all requests and waits for the ACKs. Contrary to _nl_send_nlmsg(),
+ * this also handles the delayed actions.
+ */
+static void
+_nl_send_batch (NMPlatform *platform,
+                struct nl_msg *const *nlmsgs,
+                guint len,
+                WaitForNlResponseResult *seq_results,
+                char **errmsgs)
+{
+	NMLinuxPlatformPrivate *priv = NM_LINUX_PLATFORM_GET_PRIVATE (platform);
+	struct iovec iov[NL_BATCH_MAX_IN_FLIGHT];
+	guint32 local_port;
+	guint i_chunk;
+
+	if (len == 0)
+		return;
+
+	local_port = nl_socket_get_local_port (priv->nlh);
+
+	for (i_chunk = 0; i_chunk < len; i_chunk += NL_BATCH_MAX_IN_FLIGHT) {
+		const guint n_chunk = MIN (len - i_chunk, (guint) NL_BATCH_MAX_IN_FLIGHT);
+		guint i_start = i_chunk;
+		gsize send_size = 0;
+		guint i;
+
+		event_handler_read_netlink (platform, FALSE);
+
+		for (i = i_chunk; i < i_chunk + n_chunk; i++) {
+			struct nlmsghdr *nlhdr = nlmsg_hdr (nlmsgs[i]);
+			gsize msg_size = NLMSG_ALIGN (nlhdr->nlmsg_len);
+
+			if (   i > i_start
+			    && send_size + msg_size > NL_BATCH_SEND_SIZE) {
+				_nl_send_batch_flush (platform,
+				                      &iov[i_start - i_chunk],
+				                      &nlmsgs[i_start],
+				                      i - i_start,
+				                      &seq_results[i_start],
+				                      errmsgs ? &errmsgs[i_start] : NULL);
+				i_start = i;
+				send_size = 0;
+			}
+
+			seq_results[i] = WAIT_FOR_NL_RESPONSE_RESULT_UNKNOWN;
+			nlhdr->nlmsg_seq = _nlh_seq_next_get (priv);
+			if (!nlhdr->nlmsg_pid)
+				nlhdr->nlmsg_pid = local_port;
+			nlhdr->nlmsg_flags |= (NLM_F_REQUEST | NLM_F_ACK);
+
+			/* the kernel parses the messages in the datagram at NLMSG_ALIGN()
+			 * offsets. The nl_msg buffer is large enough for the padding. */
+			iov[i - i_chunk] = (struct iovec) {
+				.iov_base = nlhdr,
+				.iov_len  = msg_size,
+			};
+			send_size += msg_size;
+		}
+
+		_nl_send_batch_flush (platform,
+		                      &iov[i_start - i_chunk],
+		                      &nlmsgs[i_start],
+		                      i - i_start,
+		                      &seq_results[i_start],
+		                      errmsgs ? &errmsgs[i_start] : NULL);
+
+		delayed_action_handle_all (platform, FALSE);
+	}
+}
+
 static int
 do_change_link (NMPlatform *platform,
                 ChangeLinkType change_link_type,
@@ -8333,6 +9401,60 @@ ip_route_add (NMPlatform *platform,
 	                         NM_FLAGS_HAS (flags, NMP_NLM_FLAG_SUPPRESS_NETLINK_FAILURE));
 }
 
+static void
+ip_route_add_batch (NMPlatform *platform,
+                    NMPNlmFlags flags,
+                    const NMPObject *const *routes,
+                    guint len,
+                    int *out_results)
+{
+	gs_free struct nl_msg **nlmsgs = NULL;
+	gs_free WaitForNlResponseResult *seq_results = NULL;
+	gs_free char **errmsgs = NULL;
+	char s_buf[256];
+	guint i;
+
+	if (len == 0)
+		return;
+
+	nlmsgs = g_new (struct nl_msg *, len);
+	seq_results = g_new (WaitForNlResponseResult, len);
+	errmsgs = g_new0 (char *, len);
+
+	for (i = 0; i < len; i++) {
+		NMPObject obj;
+
+		nm_assert (NM_IN_SET (NMP_OBJECT_GET_TYPE (routes[i]), NMP_OBJECT_TYPE_IP4_ROUTE,
+		                                                       NMP_OBJECT_TYPE_IP6_ROUTE));
+
+		nmp_object_stackinit (&obj, NMP_OBJECT_GET_TYPE (routes[i]), &routes[i]->object);
+		nm_platform_ip_route_normalize (NMP_OBJECT_GET_CLASS (&obj)->addr_family,
+		                                NMP_OBJECT_CAST_IP_ROUTE (&obj));
+		nlmsgs[i] = _nl_msg_new_route (RTM_NEWROUTE, flags & NMP_NLM_FLAG_FMASK, &obj);
+		nm_assert (nlmsgs[i]);
+	}
+
+	_nl_send_batch (platform, nlmsgs, len, seq_results, errmsgs);
+
+	for (i = 0; i < len; i++) {
+		nm_assert (seq_results[i]);
+
+		_NMLOG ((   seq_results[i] == WAIT_FOR_NL_RESPONSE_RESULT_RESPONSE_OK
+		         || (   NM_FLAGS_HAS (flags, NMP_NLM_FLAG_SUPPRESS_NETLINK_FAILURE)
+		             && seq_results[i] < 0))
+		            ? LOGL_DEBUG
+		            : LOGL_WARN,
+		        "do-add-%s[%s]: %s (batch)",
+		        NMP_OBJECT_GET_CLASS (routes[i])->obj_type_name,
+		        nmp_object_to_string (routes[i], NMP_OBJECT_TO_STRING_ID, NULL, 0),
+		        wait_for_nl_response_to_string (seq_results[i], errmsgs[i], s_buf, sizeof (s_buf)));
+
+		out_results[i] = wait_for_nl_response_to_nmerr (seq_results[i]);
+		nlmsg_free (nlmsgs[i]);
+		g_free (errmsgs[i]);
+	}
+}
+
 static gboolean
 object_delete (NMPlatform *platform,
                const NMPObject *obj)
@@ -8366,6 +9488,53 @@ object_delete (NMPlatform *platform,
 	return do_delete_object (platform, obj, nlmsg);
 }
 
+static void
+object_delete_batch (NMPlatform *platform,
+                     const NMPObject *const *objs,
+                     guint len,
+                     gboolean *out_results)
+{
+	gs_free struct nl_msg **nlmsgs = NULL;
+	gs_free WaitForNlResponseResult *seq_results = NULL;
+	gs_free char **errmsgs = NULL;
+	char s_buf[256];
+	guint i;
+
+	if (len == 0)
+		return;
+
+	nlmsgs = g_new (struct nl_msg *, len);
+	seq_results = g_new (WaitForNlResponseResult, len);
+	errmsgs = g_new0 (char *, len);
+
+	for (i = 0; i < len; i++) {
+		nm_assert (NM_IN_SET (NMP_OBJECT_GET_TYPE (objs[i]), NMP_OBJECT_TYPE_IP4_ROUTE,
+		                                                     NMP_OBJECT_TYPE_IP6_ROUTE));
+		nlmsgs[i] = _nl_msg_new_route (RTM_DELROUTE, 0, objs[i]);
+		nm_assert (nlmsgs[i]);
+	}
+
+	_nl_send_batch (platform, nlmsgs, len, seq_results, errmsgs);
+
+	for (i = 0; i < len; i++) {
+		const char *log_detail;
+
+		nm_assert (seq_results[i]);
+
+		out_results[i] = _delete_object_result_is_success (objs[i], seq_results[i], &log_detail);
+
+		_NMLOG (out_results[i] ? LOGL_DEBUG : LOGL_WARN,
+		        "do-delete-%s[%s]: %s%s (batch)",
+		        NMP_OBJECT_GET_CLASS (objs[i])->obj_type_name,
+		        nmp_object_to_string (objs[i], NMP_OBJECT_TO_STRING_ID, NULL, 0),
+		        wait_for_nl_response_to_string (seq_results[i], errmsgs[i], s_buf, sizeof (s_buf)),
+		        log_detail);
+
+		nlmsg_free (nlmsgs[i]);
+		g_free (errmsgs[i]);
+	}
+}
+
 /*****************************************************************************/
 
 static int
@@ -8584,54 +9753,531 @@ event_handler (GIOChannel *channel,
                GIOCondition io_condition,
                gpointer user_data)
 {
-	delayed_action_handle_all (NM_PLATFORM (user_data), TRUE);
+	NMPlatform *platform = NM_PLATFORM (user_data);
+	NMLinuxPlatformPrivate *priv = NM_LINUX_PLATFORM_GET_PRIVATE (platform);
+	guint64 n_messages = priv->netlink_stats.n_messages;
+	guint n;
+
+	_resync_window_update (platform);
+
+	delayed_action_handle_all (platform, TRUE);
+
+	n = priv->netlink_stats.n_messages - n_messages;
+	priv->netlink_stats.n_wakeups++;
+	priv->netlink_stats.last_messages_per_wakeup = n;
+	priv->netlink_stats.max_messages_per_wakeup = MAX (priv->netlink_stats.max_messages_per_wakeup, n);
 	return TRUE;
 }
 
+/**
+ * nm_linux_platform_get_netlink_stats:
+ * @platform: the #NMLinuxPlatform
+ * @out_stats: (out): the counters of the netlink event socket.
+ */
+void
+nm_linux_platform_get_netlink_stats (NMPlatform *platform,
+                                     NMLinuxPlatformNetlinkStats *out_stats)
+{
+	g_return_if_fail (NM_IS_LINUX_PLATFORM (platform));
+	g_return_if_fail (out_stats);
+
+	*out_stats = NM_LINUX_PLATFORM_GET_PRIVATE (platform)->netlink_stats;
+}
+
 /*****************************************************************************/
 
-/* copied from libnl3's recvmsgs() */
-static int
-event_handler_recvmsgs (NMPlatform *platform, gboolean handle_events)
+/* Capture of the netlink traffic that we receive from kernel, and replay
+ * of such a capture.
+ *
+ * The file starts with the 8 bytes NM_LINUX_PLATFORM_CAPTURE_MAGIC, followed
+ * by one record per recvmsg() call. Each record is a NMLinuxPlatformCaptureRecord
+ * header, followed by @len bytes of netlink messages, padded to 8 bytes.
+ * All numbers are in host byte order. A capture is only meant to be replayed
+ * on the same machine architecture. */
+
+#define NM_LINUX_PLATFORM_CAPTURE_MAGIC "NMNLCAP1"
+
+typedef struct {
+	/* nanoseconds since the start of the capture. */
+	guint64 timestamp_ns;
+	guint32 len;
+	guint32 _reserved;
+} NMLinuxPlatformCaptureRecord;
+
+G_STATIC_ASSERT (sizeof (NMLinuxPlatformCaptureRecord) == 16);
+
+static void
+_capture_write (NMPlatform *platform, const unsigned char *buf, int len)
 {
 	NMLinuxPlatformPrivate *priv = NM_LINUX_PLATFORM_GET_PRIVATE (platform);
-	struct nl_sock *sk = priv->nlh;
-	int n;
-	int err = 0;
-	gboolean multipart = 0;
-	gboolean interrupted = FALSE;
-	struct nlmsghdr *hdr;
-	WaitForNlResponseResult seq_result;
-	struct sockaddr_nl nla = {0};
-	struct ucred creds;
-	gboolean creds_has;
-	nm_auto_free unsigned char *buf = NULL;
+	static const guint8 padding[8] = { 0 };
+	NMLinuxPlatformCaptureRecord record = {
+		.timestamp_ns = nm_utils_get_monotonic_timestamp_ns () - priv->capture_start_ns,
+		.len          = len,
+	};
 
-continue_reading:
-	g_clear_pointer (&buf, free);
-	n = nl_recv (sk, &nla, &buf, &creds, &creds_has);
+	nm_assert (priv->capture_file);
+	nm_assert (len > 0);
 
-	if (n <= 0) {
+	if (   fwrite (&record, sizeof (record), 1, priv->capture_file) != 1
+	    || fwrite (buf, len, 1, priv->capture_file) != 1
+	    || (   len % 8 != 0
+	        && fwrite (padding, 8 - (len % 8), 1, priv->capture_file) != 1)) {
+		_LOGW ("netlink: capture: failure to write capture file. Stop capturing");
+		nm_linux_platform_capture_stop (platform);
+	}
+}
 
-		if (n == -NME_NL_MSG_TRUNC) {
-			int buf_size;
+/**
+ * nm_linux_platform_capture_start:
+ * @platform: the #NMLinuxPlatform instance
+ * @filename: the capture file to write. It gets truncated.
+ * @error: (allow-none): the failure reason.
+ *
+ * Record all netlink messages that @platform receives from kernel
+ * to @filename. This includes the responses to our own requests, so
+ * that the capture contains the full picture as seen by the cache.
+ * The capture starts with a full dump of all objects.
+ * See nm_linux_platform_replay().
+ *
+ * Returns: %TRUE on success.
+ */
+gboolean
+nm_linux_platform_capture_start (NMPlatform *platform,
+                                 const char *filename,
+                                 GError **error)
+{
+	NMLinuxPlatformPrivate *priv;
+	FILE *f;
+	int errsv;
 
-			/* the message receive buffer was too small. We lost one message, which
-			 * is unfortunate. Try to double the buffer size for the next time. */
-			buf_size = nl_socket_get_msg_buf_size (sk);
-			if (buf_size < 512*1024) {
-				buf_size *= 2;
-				_LOGT ("netlink: recvmsg: increase message buffer size for recvmsg() to %d bytes", buf_size);
-				if (nl_socket_set_msg_buf_size (sk, buf_size) < 0)
-					nm_assert_not_reached ();
-				if (!handle_events)
-					goto continue_reading;
-			}
+	g_return_val_if_fail (NM_IS_LINUX_PLATFORM (platform), FALSE);
+	g_return_val_if_fail (filename, FALSE);
+
+	priv = NM_LINUX_PLATFORM_GET_PRIVATE (platform);
+
+	nm_linux_platform_capture_stop (platform);
+
+	f = fopen (filename, "we");
+	if (!f) {
+		errsv = errno;
+		g_set_error (error, NM_UTILS_ERROR, NM_UTILS_ERROR_UNKNOWN,
+		             "cannot open capture file \"%s\": %s",
+		             filename, nm_strerror_native (errsv));
+		return FALSE;
+	}
+
+	if (fwrite (NM_LINUX_PLATFORM_CAPTURE_MAGIC, 8, 1, f) != 1) {
+		fclose (f);
+		g_set_error (error, NM_UTILS_ERROR, NM_UTILS_ERROR_UNKNOWN,
+		             "cannot write capture file \"%s\"",
+		             filename);
+		return FALSE;
+	}
+
+	_LOGD ("netlink: capture: start recording to \"%s\"", filename);
+	priv->capture_file = f;
+	priv->capture_start_ns = nm_utils_get_monotonic_timestamp_ns ();
+
+	/* start the capture with a full dump, so that a replay
+	 * begins with the same cache content. */
+	delayed_action_schedule (platform, DELAYED_ACTION_TYPE_REFRESH_ALL, NULL);
+	delayed_action_handle_all (platform, FALSE);
+	return TRUE;
+}
+
+void
+nm_linux_platform_capture_stop (NMPlatform *platform)
+{
+	NMLinuxPlatformPrivate *priv;
+
+	g_return_if_fail (NM_IS_LINUX_PLATFORM (platform));
+
+	priv = NM_LINUX_PLATFORM_GET_PRIVATE (platform);
+
+	if (!priv->capture_file)
+		return;
+
+	_LOGD ("netlink: capture: stop recording");
+	fclose (g_steal_pointer (&priv->capture_file));
+}
+
+static void
+_replay_remap_seq (unsigned char *buf, int n)
+{
+	struct nlmsghdr *hdr = (struct nlmsghdr *) buf;
+
+	/* the sequence numbers in the capture belong to the requests of the
+	 * recording platform. Move them out of the range of our own requests,
+	 * so that they don't complete one of our pending requests. Messages
+	 * of the same response still share the same number. */
+	while (nlmsg_ok (hdr, n)) {
+		if (hdr->nlmsg_seq != 0)
+			hdr->nlmsg_seq |= NLH_SEQ_REPLAY_BIT;
+		hdr = nlmsg_next (hdr, &n);
+	}
+}
+
+static int event_handler_process_buf (NMPlatform *platform,
+                                      unsigned char *buf,
+                                      int n,
+                                      const struct sockaddr_nl *nla,
+                                      const struct ucred *creds,
+                                      gboolean creds_has,
+                                      gboolean handle_events,
+                                      gboolean *inout_multipart,
+                                      gboolean *inout_interrupted,
+                                      gboolean *out_stop);
+
+/**
+ * nm_linux_platform_replay:
+ * @platform: the #NMLinuxPlatform instance
+ * @filename: a capture file, as written by nm_linux_platform_capture_start().
+ * @realtime: if %TRUE, keep the original timing between the records.
+ *   Otherwise, replay the capture as fast as possible.
+ * @out_n_records: (allow-none) (out): the number of replayed records.
+ * @error: (allow-none): the failure reason.
+ *
+ * Feed the captured netlink messages into @platform, as if it received them
+ * from kernel. The messages are processed by the regular event handling
+ * code path, so the cache gets updated and the platform signals are emitted.
+ *
+ * Note that @platform still talks to kernel for the requests that it
+ * issues itself (like refreshing a link). Hence, replay into a platform
+ * instance that lives in an otherwise unused network namespace. The
+ * sequence numbers of the replayed messages are moved to a range that
+ * @platform never uses for its own requests.
+ *
+ * Returns: %TRUE on success.
+ */
+gboolean
+nm_linux_platform_replay (NMPlatform *platform,
+                          const char *filename,
+                          gboolean realtime,
+                          guint *out_n_records,
+                          GError **error)
+{
+	nm_auto_pop_netns NMPNetns *netns = NULL;
+	gs_free_error GError *local = NULL;
+	GMappedFile *mapped;
+	const char *data;
+	gsize len;
+	gsize offset;
+	gint64 start_ns;
+	guint n_records = 0;
+	gboolean success = FALSE;
+	const struct sockaddr_nl nla = {
+		.nl_family = AF_NETLINK,
+	};
+	const struct ucred creds = { 0 };
+
+	g_return_val_if_fail (NM_IS_LINUX_PLATFORM (platform), FALSE);
+	g_return_val_if_fail (filename, FALSE);
+
+	NM_SET_OUT (out_n_records, 0);
+
+	if (!nm_platform_netns_push (platform, &netns)) {
+		g_set_error (error, NM_UTILS_ERROR, NM_UTILS_ERROR_UNKNOWN,
+		             "cannot switch to the network namespace of the platform");
+		return FALSE;
+	}
+
+	mapped = g_mapped_file_new (filename, FALSE, &local);
+	if (!mapped) {
+		g_set_error (error, NM_UTILS_ERROR, NM_UTILS_ERROR_UNKNOWN,
+		             "cannot open capture file \"%s\": %s",
+		             filename, local->message);
+		return FALSE;
+	}
+
+	data = g_mapped_file_get_contents (mapped);
+	len = g_mapped_file_get_length (mapped);
+
+	if (   len < 8
+	    || memcmp (data, NM_LINUX_PLATFORM_CAPTURE_MAGIC, 8) != 0) {
+		g_set_error (error, NM_UTILS_ERROR, NM_UTILS_ERROR_UNKNOWN,
+		             "\"%s\" is not a netlink capture file",
+		             filename);
+		goto out;
+	}
+
+	_LOGD ("netlink: replay: start replaying \"%s\"%s", filename, realtime ? " in realtime" : "");
+
+	start_ns = nm_utils_get_monotonic_timestamp_ns ();
+	offset = 8;
+	while (offset < len) {
+		NMLinuxPlatformCaptureRecord record;
+		gs_free unsigned char *buf = NULL;
+		gboolean multipart = FALSE;
+		gboolean interrupted = FALSE;
+		gboolean stop;
+
+		if (len - offset < sizeof (record)) {
+			g_set_error (error, NM_UTILS_ERROR, NM_UTILS_ERROR_UNKNOWN,
+			             "truncated record header at offset %"G_GSIZE_FORMAT,
+			             offset);
+			goto out;
+		}
+		memcpy (&record, &data[offset], sizeof (record));
+		offset += sizeof (record);
+
+		if (   record.len == 0
+		    || record.len > G_MAXINT
+		    || len - offset < record.len) {
+			g_set_error (error, NM_UTILS_ERROR, NM_UTILS_ERROR_UNKNOWN,
+			             "invalid record at offset %"G_GSIZE_FORMAT,
+			             offset - sizeof (record));
+			goto out;
 		}
 
-		return n;
+		if (realtime) {
+			gint64 wait_ns;
+
+			wait_ns = (start_ns + (gint64) record.timestamp_ns) - nm_utils_get_monotonic_timestamp_ns ();
+			if (wait_ns > 0)
+				g_usleep (wait_ns / 1000);
+		}
+
+		/* the mapped file is not necessarily aligned. Copy the record. */
+		buf = g_memdup (&data[offset], record.len);
+		offset += record.len;
+		if (record.len % 8 != 0)
+			offset += 8 - (record.len % 8);
+
+		_replay_remap_seq (buf, record.len);
+
+		event_handler_process_buf (platform,
+		                           buf,
+		                           record.len,
+		                           &nla,
+		                           &creds,
+		                           TRUE,
+		                           TRUE,
+		                           &multipart,
+		                           &interrupted,
+		                           &stop);
+		delayed_action_handle_all (platform, FALSE);
+		n_records++;
+	}
+
+	_LOGD ("netlink: replay: replayed %u records in %"G_GINT64_FORMAT" msec",
+	       n_records,
+	       (nm_utils_get_monotonic_timestamp_ns () - start_ns) / NM_UTILS_NS_PER_MSEC);
+	success = TRUE;
+
+out:
+	g_mapped_file_unref (mapped);
+	NM_SET_OUT (out_n_records, n_records);
+	return success;
+}
+
+/*****************************************************************************/
+
+/* Resynchronization after the netlink socket overflowed.
+ *
+ * On overflow (ENOBUFS), kernel drops the events that don't fit into the
+ * receive queue. There is no sequence number for multicast events, so we
+ * don't know which events are lost. However, the overflow is caused by a
+ * burst of events, and the events that are dropped are of the types that
+ * are busy. Hence, we count the events per object type in a sliding window
+ * of about one to two seconds, and after an overflow only dump the
+ * types that had recent events. The other types are dumped later, when
+ * things settled down. That avoids adding the full dump load during the
+ * storm, which could cause the next overflow.
+ *
+ * Also, every overflow doubles the size of the receive buffer, up to
+ * RESYNC_RX_BUFFER_SIZE_MAX. */
+
+#define RESYNC_WINDOW_NS            (NM_UTILS_NS_PER_SECOND)
+#define RESYNC_DEFERRED_TIMEOUT_MS  5000
+#define RESYNC_RX_BUFFER_SIZE_MAX   (128 * 1024 * 1024)
+
+static RefreshAllType
+_resync_refresh_all_type_from_nlmsg (const struct nlmsghdr *hdr)
+{
+	guint8 family;
+
+	switch (hdr->nlmsg_type) {
+	case RTM_NEWLINK:
+	case RTM_DELLINK:
+		return REFRESH_ALL_TYPE_LINKS;
+	case RTM_NEWQDISC:
+	case RTM_DELQDISC:
+		return REFRESH_ALL_TYPE_QDISCS;
+	case RTM_NEWTFILTER:
+	case RTM_DELTFILTER:
+		return REFRESH_ALL_TYPE_TFILTERS;
+	}
+
+	/* ifaddrmsg, rtmsg and fib_rule_hdr all start with the address family. */
+	if (hdr->nlmsg_len < NLMSG_HDRLEN + sizeof (guint8))
+		return _REFRESH_ALL_TYPE_NUM;
+	family = *((const guint8 *) NLMSG_DATA (hdr));
+
+	switch (hdr->nlmsg_type) {
+	case RTM_NEWADDR:
+	case RTM_DELADDR:
+		if (family == AF_INET)
+			return REFRESH_ALL_TYPE_IP4_ADDRESSES;
+		if (family == AF_INET6)
+			return REFRESH_ALL_TYPE_IP6_ADDRESSES;
+		break;
+	case RTM_NEWROUTE:
+	case RTM_DELROUTE:
+		if (family == AF_INET)
+			return REFRESH_ALL_TYPE_IP4_ROUTES;
+		if (family == AF_INET6)
+			return REFRESH_ALL_TYPE_IP6_ROUTES;
+		break;
+	case RTM_NEWRULE:
+	case RTM_DELRULE:
+		if (family == AF_INET)
+			return REFRESH_ALL_TYPE_ROUTING_RULES_IP4;
+		if (family == AF_INET6)
+			return REFRESH_ALL_TYPE_ROUTING_RULES_IP6;
+		break;
+	}
+
+	return _REFRESH_ALL_TYPE_NUM;
+}
+
+static void
+_resync_count_event (NMPlatform *platform, const struct nlmsghdr *hdr)
+{
+	NMLinuxPlatformPrivate *priv = NM_LINUX_PLATFORM_GET_PRIVATE (platform);
+	RefreshAllType refresh_all_type;
+
+	refresh_all_type = _resync_refresh_all_type_from_nlmsg (hdr);
+	if (refresh_all_type < _REFRESH_ALL_TYPE_NUM)
+		priv->resync.n_events[refresh_all_type]++;
+}
+
+static void
+_resync_window_update (NMPlatform *platform)
+{
+	NMLinuxPlatformPrivate *priv = NM_LINUX_PLATFORM_GET_PRIVATE (platform);
+	gint64 now_ns = nm_utils_get_monotonic_timestamp_ns ();
+
+	if (now_ns < priv->resync.window_start_ns + RESYNC_WINDOW_NS)
+		return;
+
+	memcpy (priv->resync.n_events_prev, priv->resync.n_events_cur, sizeof (priv->resync.n_events_prev));
+	memcpy (priv->resync.n_events_cur, priv->resync.n_events, sizeof (priv->resync.n_events_cur));
+	priv->resync.window_start_ns = now_ns;
+}
+
+static gboolean
+_resync_deferred_cb (gpointer user_data)
+{
+	NMPlatform *platform = user_data;
+	NMLinuxPlatformPrivate *priv = NM_LINUX_PLATFORM_GET_PRIVATE (platform);
+	DelayedActionType deferred;
+
+	priv->resync.deferred_id = 0;
+	deferred = nm_steal_int (&priv->resync.deferred);
+
+	_LOGD ("netlink: resync: refresh deferred types");
+	delayed_action_schedule (platform, deferred, NULL);
+	delayed_action_handle_all (platform, FALSE);
+	return G_SOURCE_REMOVE;
+}
+
+/* Returns the refresh-all types to dump right away after an overflow. Must
+ * be called before the pending requests get failed, because the types with
+ * an interrupted dump must be dumped again. */
+static DelayedActionType
+_resync_get_types (NMPlatform *platform)
+{
+	NMLinuxPlatformPrivate *priv = NM_LINUX_PLATFORM_GET_PRIVATE (platform);
+	DelayedActionType action_type = DELAYED_ACTION_TYPE_NONE;
+	RefreshAllType t;
+
+	_resync_window_update (platform);
+
+	for (t = _REFRESH_ALL_TYPE_FIRST; t < _REFRESH_ALL_TYPE_NUM; t++) {
+		if (   priv->resync.n_events[t] != priv->resync.n_events_prev[t]
+		    || priv->pruning[t] > 0
+		    || priv->delayed_action.refresh_all_in_progress[t] > 0)
+			action_type |= delayed_action_type_from_refresh_all_type (t);
 	}
 
+	/* without any recent events, we cannot tell what was lost. */
+	if (action_type == DELAYED_ACTION_TYPE_NONE)
+		action_type = DELAYED_ACTION_TYPE_REFRESH_ALL;
+
+	return action_type;
+}
+
+static void
+_resync_schedule (NMPlatform *platform, DelayedActionType action_type)
+{
+	NMLinuxPlatformPrivate *priv = NM_LINUX_PLATFORM_GET_PRIVATE (platform);
+	DelayedActionType deferred;
+	DelayedActionType iflags;
+	guint n_types = 0;
+	guint n_deferred = 0;
+
+	/* all types that are not dumped now are (re-)deferred. */
+	deferred = DELAYED_ACTION_TYPE_REFRESH_ALL & ~action_type;
+
+	FOR_EACH_DELAYED_ACTION (iflags, action_type)
+		n_types++;
+	FOR_EACH_DELAYED_ACTION (iflags, deferred)
+		n_deferred++;
+
+	/* link events might be lost. */
+	_sysctl_read_cache_invalidate_all (platform);
+
+	priv->netlink_stats.n_resyncs++;
+	priv->netlink_stats.n_resync_types_dumped += n_types;
+	priv->netlink_stats.n_resync_types_deferred += n_deferred;
+
+	_LOGI ("netlink: resync: refresh %u object types now and %u later", n_types, n_deferred);
+
+	delayed_action_schedule (platform, action_type, NULL);
+
+	/* types that are dumped now no longer need to be dumped later. Keep an
+	 * already running timer, so that a storm of overflows cannot postpone
+	 * the deferred types forever. */
+	priv->resync.deferred = (priv->resync.deferred | deferred) & ~action_type;
+	if (priv->resync.deferred == DELAYED_ACTION_TYPE_NONE)
+		nm_clear_g_source (&priv->resync.deferred_id);
+	else if (!priv->resync.deferred_id)
+		priv->resync.deferred_id = g_timeout_add (RESYNC_DEFERRED_TIMEOUT_MS, _resync_deferred_cb, platform);
+
+	if (priv->resync.rx_buffer_size < RESYNC_RX_BUFFER_SIZE_MAX) {
+		int size = MIN (priv->resync.rx_buffer_size * 2, RESYNC_RX_BUFFER_SIZE_MAX);
+
+		if (nl_socket_set_rx_buffer_size (priv->nlh, size) >= 0) {
+			_LOGD ("netlink: resync: increase socket receive buffer to %d bytes", size);
+			priv->resync.rx_buffer_size = size;
+			priv->netlink_stats.rx_buffer_size = size;
+		}
+	}
+}
+
+/*****************************************************************************/
+
+/* copied from libnl3's recvmsgs(). Process the netlink messages in @buf,
+ * as received by one recvmsg() call. */
+static int
+event_handler_process_buf (NMPlatform *platform,
+                           unsigned char *buf,
+                           int n,
+                           const struct sockaddr_nl *nla,
+                           const struct ucred *creds,
+                           gboolean creds_has,
+                           gboolean handle_events,
+                           gboolean *inout_multipart,
+                           gboolean *inout_interrupted,
+                           gboolean *out_stop)
+{
+	struct nlmsghdr *hdr;
+	WaitForNlResponseResult seq_result;
+	int err = 0;
+
+	*out_stop = FALSE;
+
 	hdr = (struct nlmsghdr *) buf;
 	while (nlmsg_ok (hdr, n)) {
 		nm_auto_nlmsg struct nl_msg *msg = NULL;
@@ -8641,27 +10287,29 @@ continue_reading:
 		char buf_nlmsghdr[400];
 		const char *extack_msg = NULL;
 
-		msg = nlmsg_alloc_convert (hdr);
+		msg = nlmsg_alloc_borrow (hdr);
 
 		nlmsg_set_proto (msg, NETLINK_ROUTE);
-		nlmsg_set_src (msg, &nla);
+		nlmsg_set_src (msg, (struct sockaddr_nl *) nla);
+
+		NM_LINUX_PLATFORM_GET_PRIVATE (platform)->netlink_stats.n_messages++;
 
-		if (!creds_has || creds.pid) {
+		if (!creds_has || creds->pid) {
 			if (!creds_has)
 				_LOGT ("netlink: recvmsg: received message without credentials");
 			else
-				_LOGT ("netlink: recvmsg: received non-kernel message (pid %d)", creds.pid);
-			err = 0;
-			goto stop;
+				_LOGT ("netlink: recvmsg: received non-kernel message (pid %d)", creds->pid);
+			*out_stop = TRUE;
+			return 0;
 		}
 
 		_LOGt ("netlink: recvmsg: new message %s",
 		       nl_nlmsghdr_to_str (hdr, buf_nlmsghdr, sizeof (buf_nlmsghdr)));
 
-		nlmsg_set_creds (msg, &creds);
+		nlmsg_set_creds (msg, (struct ucred *) creds);
 
 		if (hdr->nlmsg_flags & NLM_F_MULTI)
-			multipart = TRUE;
+			*inout_multipart = TRUE;
 
 		if (hdr->nlmsg_flags & NLM_F_DUMP_INTR) {
 			/*
@@ -8669,7 +10317,7 @@ continue_reading:
 			 * all messages until a NLMSG_DONE is
 			 * received and report the inconsistency.
 			 */
-			interrupted = TRUE;
+			*inout_interrupted = TRUE;
 		}
 
 		/* Other side wishes to see an ack for this message */
@@ -8684,7 +10332,7 @@ continue_reading:
 			 * usually the end of a message and therefore we slip
 			 * out of the loop by default. the user may overrule
 			 * this action by skipping this packet. */
-			multipart = FALSE;
+			*inout_multipart = FALSE;
 			seq_result = WAIT_FOR_NL_RESPONSE_RESULT_RESPONSE_OK;
 		} else if (hdr->nlmsg_type == NLMSG_NOOP) {
 			/* Message to be ignored, the default action is to
@@ -8758,6 +10406,9 @@ continue_reading:
 			 * get along with broken kernels. NL_SKIP has no
 			 * effect on this.  */
 
+			if (seq_number == 0)
+				_resync_count_event (platform, hdr);
+
 			event_valid_msg (platform, msg, handle_events);
 
 			seq_result = WAIT_FOR_NL_RESPONSE_RESULT_RESPONSE_OK;
@@ -8765,13 +10416,235 @@ continue_reading:
 
 		event_seq_check (platform, seq_number, seq_result, extack_msg);
 
-		if (abort_parsing)
-			goto stop;
+		if (abort_parsing) {
+			*out_stop = TRUE;
+			return err;
+		}
 
 		err = 0;
 		hdr = nlmsg_next (hdr, &n);
 	}
 
+	return err;
+}
+
+static void
+_recv_ring_clear (EventRecvRing *ring)
+{
+	nm_assert (ring->idx == ring->n_filled);
+	nm_assert (ring->processing == 0);
+
+	nm_clear_g_free (&ring->msgs);
+	nm_clear_g_free (&ring->slots);
+	nm_clear_g_free (&ring->data);
+	ring->n_slots = 0;
+	ring->slot_size = 0;
+	ring->n_filled = 0;
+	ring->idx = 0;
+}
+
+static int
+_recv_ring_fill (NMPlatform *platform)
+{
+	NMLinuxPlatformPrivate *priv = NM_LINUX_PLATFORM_GET_PRIVATE (platform);
+	EventRecvRing *ring = &priv->recv_ring;
+	gsize slot_size;
+	guint i;
+	int n;
+
+	nm_assert (ring->idx == ring->n_filled);
+	nm_assert (ring->processing == 0);
+
+	/* event_handler_recvmsgs() doubles the message buffer size, when
+	 * it encounters truncated messages. Follow that. */
+	slot_size = nl_socket_get_msg_buf_size (priv->nlh);
+	nm_assert (slot_size > 0);
+
+	if (   ring->slot_size != slot_size
+	    || ring->n_slots != ring->n_slots_want) {
+		_recv_ring_clear (ring);
+
+		ring->n_slots = ring->n_slots_want;
+		ring->slot_size = slot_size;
+		ring->msgs = g_new0 (struct mmsghdr, ring->n_slots);
+		ring->slots = g_new0 (EventRecvSlot, ring->n_slots);
+		ring->data = g_malloc (ring->n_slots * slot_size);
+
+		for (i = 0; i < ring->n_slots; i++) {
+			ring->slots[i].iov.iov_base = &ring->data[i * slot_size];
+			ring->slots[i].iov.iov_len = slot_size;
+		}
+
+		_LOGT ("netlink: recvmmsg: use %u buffers of %zu bytes", ring->n_slots, slot_size);
+	}
+
+	for (i = 0; i < ring->n_slots; i++) {
+		ring->msgs[i] = (struct mmsghdr) {
+			.msg_hdr = {
+				.msg_name       = &ring->slots[i].nla,
+				.msg_namelen    = sizeof (ring->slots[i].nla),
+				.msg_iov        = &ring->slots[i].iov,
+				.msg_iovlen     = 1,
+				.msg_control    = &ring->slots[i].control,
+				.msg_controllen = sizeof (ring->slots[i].control),
+			},
+		};
+	}
+
+	ring->idx = 0;
+	ring->n_filled = 0;
+
+	n = nl_recvmmsg (priv->nlh, ring->msgs, ring->n_slots);
+	if (n <= 0)
+		return n;
+
+	ring->n_filled = n;
+
+	priv->netlink_stats.n_recv_calls++;
+	priv->netlink_stats.n_datagrams += n;
+
+	if (   (guint) n == ring->n_slots
+	    && ring->n_slots_want < EVENT_RECV_RING_SLOTS_MAX) {
+		/* the socket had more data than we could receive at once. Use more
+		 * buffers next time. */
+		ring->n_slots_want = MIN (ring->n_slots_want * 2u, EVENT_RECV_RING_SLOTS_MAX);
+	}
+
+	return n;
+}
+
+/* Returns the next datagram from the receive ring, refilling it from the
+ * socket if necessary. The returned buffer stays valid until the next call.
+ * If the ring is currently being processed (a nested read while handling an
+ * event), the ring cannot be refilled and we fallback to nl_recv(), which
+ * returns an allocated buffer in @out_buf_free. */
+static int
+_recv_ring_next (NMPlatform *platform,
+                 unsigned char **out_buf,
+                 unsigned char **out_buf_free,
+                 struct sockaddr_nl *out_nla,
+                 struct ucred *out_creds,
+                 gboolean *out_creds_has,
+                 gboolean *out_from_ring)
+{
+	NMLinuxPlatformPrivate *priv = NM_LINUX_PLATFORM_GET_PRIVATE (platform);
+	EventRecvRing *ring = &priv->recv_ring;
+	struct msghdr *msg;
+	struct cmsghdr *cmsg;
+	guint i;
+	int n;
+
+	*out_from_ring = FALSE;
+	*out_creds_has = FALSE;
+
+	if (ring->idx >= ring->n_filled) {
+		if (ring->processing > 0) {
+			n = nl_recv (priv->nlh, out_nla, out_buf_free, out_creds, out_creds_has);
+			if (n > 0) {
+				priv->netlink_stats.n_recv_calls++;
+				priv->netlink_stats.n_datagrams++;
+				*out_buf = *out_buf_free;
+			}
+			return n;
+		}
+
+		n = _recv_ring_fill (platform);
+		if (n <= 0)
+			return n;
+	}
+
+	i = ring->idx++;
+	msg = &ring->msgs[i].msg_hdr;
+
+	if (msg->msg_flags & MSG_TRUNC) {
+		/* the datagram did not fit into the buffer and is lost. */
+		return -NME_NL_MSG_TRUNC;
+	}
+
+	if (msg->msg_namelen != sizeof (struct sockaddr_nl))
+		return -NME_UNSPEC;
+
+	for (cmsg = CMSG_FIRSTHDR (msg); cmsg; cmsg = CMSG_NXTHDR (msg, cmsg)) {
+		if (   cmsg->cmsg_level == SOL_SOCKET
+		    && cmsg->cmsg_type == SCM_CREDENTIALS) {
+			memcpy (out_creds, CMSG_DATA (cmsg), sizeof (*out_creds));
+			*out_creds_has = TRUE;
+			break;
+		}
+	}
+
+	*out_nla = ring->slots[i].nla;
+	*out_buf = ring->slots[i].iov.iov_base;
+	*out_from_ring = TRUE;
+	return ring->msgs[i].msg_len;
+}
+
+static int
+event_handler_recvmsgs (NMPlatform *platform, gboolean handle_events)
+{
+	NMLinuxPlatformPrivate *priv = NM_LINUX_PLATFORM_GET_PRIVATE (platform);
+	struct nl_sock *sk = priv->nlh;
+	int n;
+	int err = 0;
+	gboolean multipart = 0;
+	gboolean interrupted = FALSE;
+	gboolean stop;
+	gboolean from_ring;
+	struct sockaddr_nl nla = {0};
+	struct ucred creds;
+	gboolean creds_has;
+	unsigned char *buf;
+	nm_auto_free unsigned char *buf_free = NULL;
+
+continue_reading:
+	g_clear_pointer (&buf_free, free);
+	n = _recv_ring_next (platform, &buf, &buf_free, &nla, &creds, &creds_has, &from_ring);
+
+	if (n <= 0) {
+
+		if (n == -NME_NL_MSG_TRUNC) {
+			int buf_size;
+
+			priv->netlink_stats.n_truncated++;
+
+			/* the message receive buffer was too small. We lost one message, which
+			 * is unfortunate. Try to double the buffer size for the next time. */
+			buf_size = nl_socket_get_msg_buf_size (sk);
+			if (buf_size < 512*1024) {
+				buf_size *= 2;
+				_LOGT ("netlink: recvmsg: increase message buffer size for recvmsg() to %d bytes", buf_size);
+				if (nl_socket_set_msg_buf_size (sk, buf_size) < 0)
+					nm_assert_not_reached ();
+				if (!handle_events)
+					goto continue_reading;
+			}
+		}
+
+		return n;
+	}
+
+	if (   priv->capture_file
+	    && creds_has
+	    && creds.pid == 0)
+		_capture_write (platform, buf, n);
+
+	if (from_ring)
+		priv->recv_ring.processing++;
+	err = event_handler_process_buf (platform,
+	                                 buf,
+	                                 n,
+	                                 &nla,
+	                                 &creds,
+	                                 creds_has,
+	                                 handle_events,
+	                                 &multipart,
+	                                 &interrupted,
+	                                 &stop);
+	if (from_ring)
+		priv->recv_ring.processing--;
+	if (stop)
+		goto stop;
+
 	if (multipart) {
 		/* Multipart message not yet complete, continue reading */
 		goto continue_reading;
@@ -8826,7 +10699,11 @@ event_handler_read_netlink (NMPlatform *platform, gboolean wait_for_acks)
 					_LOGD ("netlink: read: uncritical failure to retrieve incoming events: %s (%d)", nm_strerror (nle), nle);
 					break;
 				case -NME_NL_MSG_TRUNC:
-				case -ENOBUFS:
+				case -ENOBUFS: {
+					DelayedActionType resync_types;
+
+					if (nle == -ENOBUFS)
+						priv->netlink_stats.n_enobufs++;
 					_LOGI ("netlink: read: %s. Need to resynchronize platform cache",
 					       ({
 					            const char *_reason = "unknown";
@@ -8837,20 +10714,13 @@ event_handler_read_netlink (NMPlatform *platform, gboolean wait_for_acks)
 					            _reason;
 					       }));
 					event_handler_recvmsgs (platform, FALSE);
+					resync_types = _resync_get_types (platform);
 					delayed_action_wait_for_nl_response_complete_all (platform,
 					                                                  WAIT_FOR_NL_RESPONSE_RESULT_FAILED_RESYNC);
 
-					delayed_action_schedule (platform,
-					                         DELAYED_ACTION_TYPE_REFRESH_ALL_LINKS |
-					                         DELAYED_ACTION_TYPE_REFRESH_ALL_IP4_ADDRESSES |
-					                         DELAYED_ACTION_TYPE_REFRESH_ALL_IP6_ADDRESSES |
-					                         DELAYED_ACTION_TYPE_REFRESH_ALL_IP4_ROUTES |
-					                         DELAYED_ACTION_TYPE_REFRESH_ALL_IP6_ROUTES |
-					                         DELAYED_ACTION_TYPE_REFRESH_ALL_ROUTING_RULES_ALL |
-					                         DELAYED_ACTION_TYPE_REFRESH_ALL_QDISCS |
-					                         DELAYED_ACTION_TYPE_REFRESH_ALL_TFILTERS,
-					                         NULL);
+					_resync_schedule (platform, resync_types);
 					break;
+				}
 				default:
 					_LOGE ("netlink: read: failed to retrieve incoming events: %s (%d)", nm_strerror (nle), nle);
 					break;
@@ -9028,10 +10898,125 @@ handle_udev_event (NMUdevClient *udev_client,
 
 /*****************************************************************************/
 
+static NMPlatform *_linux_platform_new (gboolean log_with_ptr,
+                                        gboolean netns_support,
+                                        const char *cache_route_tables,
+                                        const char *cache_route_protocols);
+
 void
 nm_linux_platform_setup (void)
 {
-	nm_platform_setup (nm_linux_platform_new (FALSE, FALSE));
+	nm_linux_platform_setup_full (NULL, NULL);
+}
+
+/**
+ * nm_linux_platform_setup_full:
+ * @cache_route_tables: (allow-none): the route tables to cache. See
+ *   %NM_LINUX_PLATFORM_CACHE_ROUTE_TABLES.
+ * @cache_route_protocols: (allow-none): the route protocols to cache. See
+ *   %NM_LINUX_PLATFORM_CACHE_ROUTE_PROTOCOLS.
+ *
+ * Like nm_linux_platform_setup(), but only cache a subset of the routes.
+ */
+void
+nm_linux_platform_setup_full (const char *cache_route_tables,
+                              const char *cache_route_protocols)
+{
+	nm_platform_setup (_linux_platform_new (FALSE,
+	                                        FALSE,
+	                                        cache_route_tables,
+	                                        cache_route_protocols));
+}
+
+/*****************************************************************************/
+
+static gint64
+_route_cache_filter_parse_value (const char *str,
+                                 gboolean is_table)
+{
+	static const struct {
+		const char *name;
+		guint32 value;
+		bool is_table;
+	} names[] = {
+		{ "default", RT_TABLE_DEFAULT, TRUE  },
+		{ "main",    RT_TABLE_MAIN,    TRUE  },
+		{ "local",   RT_TABLE_LOCAL,   TRUE  },
+		{ "kernel",  RTPROT_KERNEL,    FALSE },
+		{ "boot",    RTPROT_BOOT,      FALSE },
+		{ "static",  RTPROT_STATIC,    FALSE },
+		{ "ra",      RTPROT_RA,        FALSE },
+		{ "dhcp",    RTPROT_DHCP,      FALSE },
+	};
+	guint i;
+
+	for (i = 0; i < G_N_ELEMENTS (names); i++) {
+		if (   names[i].is_table == is_table
+		    && nm_streq (str, names[i].name))
+			return names[i].value;
+	}
+
+	return _nm_utils_ascii_str_to_int64 (str,
+	                                     10,
+	                                     is_table ? 1 : 0,
+	                                     is_table ? G_MAXUINT32 : 255,
+	                                     -1);
+}
+
+static void
+_route_cache_filter_set (NMPlatform *platform,
+                         const char *str,
+                         gboolean is_table)
+{
+	RouteCacheFilter *filter = &NM_LINUX_PLATFORM_GET_PRIVATE (platform)->route_cache_filter;
+	gs_free const char **strv = NULL;
+	gsize i;
+
+	strv = nm_utils_strsplit_set (str, ", ");
+	if (!strv)
+		return;
+
+	for (i = 0; strv[i]; i++) {
+		gint64 v;
+
+		v = _route_cache_filter_parse_value (strv[i], is_table);
+		if (v < 0) {
+			_LOGW ("invalid route %s \"%s\" for the route cache filter",
+			       is_table ? "table" : "protocol",
+			       strv[i]);
+			continue;
+		}
+
+		if (is_table) {
+			if (!filter->tables)
+				filter->tables = g_hash_table_new (nm_direct_hash, NULL);
+			g_hash_table_add (filter->tables, GUINT_TO_POINTER ((guint32) v));
+		} else {
+			filter->protocols[v / 32] |= ((guint32) 1) << (v % 32);
+			filter->has_protocols = TRUE;
+		}
+	}
+}
+
+static void
+set_property (GObject *object, guint prop_id,
+              const GValue *value, GParamSpec *pspec)
+{
+	NMPlatform *platform = NM_PLATFORM (object);
+
+	switch (prop_id) {
+	case PROP_CACHE_ROUTE_TABLES:
+		/* construct-only */
+		_route_cache_filter_set (platform, g_value_get_string (value), TRUE);
+		break;
+	case PROP_CACHE_ROUTE_PROTOCOLS:
+		/* construct-only */
+		_route_cache_filter_set (platform, g_value_get_string (value), FALSE);
+		break;
+	default:
+		G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+		break;
+	}
 }
 
 /*****************************************************************************/
@@ -9044,6 +11029,12 @@ nm_linux_platform_init (NMLinuxPlatform *self)
 	priv->delayed_action.list_master_connected = g_ptr_array_new ();
 	priv->delayed_action.list_refresh_link = g_ptr_array_new ();
 	priv->delayed_action.list_wait_for_nl_response = g_array_new (FALSE, TRUE, sizeof (DelayedActionWaitForNlResponseData));
+
+	priv->recv_ring.n_slots_want = EVENT_RECV_RING_SLOTS_MIN;
+
+	g_mutex_init (&priv->sysctl_batch.lock);
+	c_list_init (&priv->sysctl_batch.lst_pending);
+	c_list_init (&priv->sysctl_batch.lst_in_flight);
 }
 
 static void
@@ -9073,6 +11064,13 @@ constructed (GObject *_object)
 	                                   nmp_netns_get_current () == nmp_netns_get_initial () ? "/main" : "")),
 	       nm_platform_get_use_udev (platform) ? "use" : "no");
 
+	if (   priv->route_cache_filter.tables
+	    || priv->route_cache_filter.has_protocols) {
+		_LOGD ("only cache routes in %u configured tables and %s protocols",
+		       priv->route_cache_filter.tables ? g_hash_table_size (priv->route_cache_filter.tables) : 0u,
+		       priv->route_cache_filter.has_protocols ? "configured" : "all");
+	}
+
 
 	priv->genl = nl_socket_alloc ();
 	g_assert (priv->genl);
@@ -9100,11 +11098,21 @@ constructed (GObject *_object)
 	/* use 8 MB for receive socket kernel queue. */
 	nle = nl_socket_set_buffer_size (priv->nlh, 8*1024*1024, 0);
 	g_assert (!nle);
+	priv->resync.rx_buffer_size = 8*1024*1024;
+	priv->netlink_stats.rx_buffer_size = priv->resync.rx_buffer_size;
 
 	nle = nl_socket_set_ext_ack (priv->nlh, TRUE);
 	if (nle)
 		_LOGD ("could not enable extended acks on netlink socket");
 
+	/* with strict checking, kernel honors the filter attributes of dump
+	 * requests. That allows to refresh the addresses and routes of one
+	 * interface, without dumping them all. */
+	nle = nl_socket_set_get_strict_chk (priv->nlh, TRUE);
+	priv->nlh_strict_chk = (nle >= 0);
+	if (nle)
+		_LOGD ("could not enable strict checking on netlink socket, dumps will not be filtered");
+
 	/* explicitly set the msg buffer size and disable MSG_PEEK.
 	 * If we later encounter NME_NL_MSG_TRUNC, we will adjust the buffer size. */
 	nl_socket_disable_msg_peek (priv->nlh);
@@ -9181,8 +11189,11 @@ constructed (GObject *_object)
 	}
 }
 
-NMPlatform *
-nm_linux_platform_new (gboolean log_with_ptr, gboolean netns_support)
+static NMPlatform *
+_linux_platform_new (gboolean log_with_ptr,
+                     gboolean netns_support,
+                     const char *cache_route_tables,
+                     const char *cache_route_protocols)
 {
 	gboolean use_udev = FALSE;
 
@@ -9194,14 +11205,23 @@ nm_linux_platform_new (gboolean log_with_ptr, gboolean netns_support)
 	                     NM_PLATFORM_LOG_WITH_PTR, log_with_ptr,
 	                     NM_PLATFORM_USE_UDEV, use_udev,
 	                     NM_PLATFORM_NETNS_SUPPORT, netns_support,
+	                     NM_LINUX_PLATFORM_CACHE_ROUTE_TABLES, cache_route_tables,
+	                     NM_LINUX_PLATFORM_CACHE_ROUTE_PROTOCOLS, cache_route_protocols,
 	                     NULL);
 }
 
+NMPlatform *
+nm_linux_platform_new (gboolean log_with_ptr, gboolean netns_support)
+{
+	return _linux_platform_new (log_with_ptr, netns_support, NULL, NULL);
+}
+
 static void
 dispose (GObject *object)
 {
 	NMPlatform *platform = NM_PLATFORM (object);
 	NMLinuxPlatformPrivate *priv = NM_LINUX_PLATFORM_GET_PRIVATE (platform);
+	SysctlBatchEntry *entry;
 
 	_LOGD ("dispose");
 
@@ -9212,6 +11232,13 @@ dispose (GObject *object)
 	g_ptr_array_set_size (priv->delayed_action.list_master_connected, 0);
 	g_ptr_array_set_size (priv->delayed_action.list_refresh_link, 0);
 
+	nm_clear_g_source (&priv->sysctl_batch.idle_id);
+	while ((entry = c_list_first_entry (&priv->sysctl_batch.lst_pending, SysctlBatchEntry, lst)))
+		_sysctl_batch_entry_complete (platform, entry, TRUE);
+
+	if (priv->sysctl_read_cache.enabled)
+		_sysctl_read_cache_log_stats (platform);
+
 	G_OBJECT_CLASS (nm_linux_platform_parent_class)->dispose (object);
 }
 
@@ -9224,6 +11251,14 @@ finalize (GObject *object)
 	g_ptr_array_unref (priv->delayed_action.list_refresh_link);
 	g_array_unref (priv->delayed_action.list_wait_for_nl_response);
 
+	if (priv->capture_file)
+		fclose (priv->capture_file);
+
+	priv->recv_ring.idx = priv->recv_ring.n_filled;
+	_recv_ring_clear (&priv->recv_ring);
+
+	nm_clear_g_source (&priv->resync.deferred_id);
+
 	nl_socket_free (priv->genl);
 
 	g_source_remove (priv->event_id);
@@ -9237,6 +11272,13 @@ finalize (GObject *object)
 
 	priv->udev_client = nm_udev_client_unref (priv->udev_client);
 
+	nm_clear_pointer (&priv->route_cache_filter.tables, g_hash_table_unref);
+	nm_clear_pointer (&priv->sysctl_read_cache.by_ifname, g_hash_table_unref);
+
+	/* the in-flight batch keeps the platform alive. */
+	nm_assert (c_list_is_empty (&priv->sysctl_batch.lst_in_flight));
+	g_mutex_clear (&priv->sysctl_batch.lock);
+
 	G_OBJECT_CLASS (nm_linux_platform_parent_class)->finalize (object);
 }
 
@@ -9246,12 +11288,30 @@ nm_linux_platform_class_init (NMLinuxPlatformClass *klass)
 	GObjectClass *object_class = G_OBJECT_CLASS (klass);
 	NMPlatformClass *platform_class = NM_PLATFORM_CLASS (klass);
 
+	object_class->set_property = set_property;
 	object_class->constructed = constructed;
 	object_class->dispose = dispose;
 	object_class->finalize = finalize;
 
+	obj_properties[PROP_CACHE_ROUTE_TABLES] =
+	    g_param_spec_string (NM_LINUX_PLATFORM_CACHE_ROUTE_TABLES, "", "",
+	                         NULL,
+	                         G_PARAM_WRITABLE |
+	                         G_PARAM_CONSTRUCT_ONLY |
+	                         G_PARAM_STATIC_STRINGS);
+
+	obj_properties[PROP_CACHE_ROUTE_PROTOCOLS] =
+	    g_param_spec_string (NM_LINUX_PLATFORM_CACHE_ROUTE_PROTOCOLS, "", "",
+	                         NULL,
+	                         G_PARAM_WRITABLE |
+	                         G_PARAM_CONSTRUCT_ONLY |
+	                         G_PARAM_STATIC_STRINGS);
+
+	g_object_class_install_properties (object_class, _PROPERTY_ENUMS_LAST, obj_properties);
+
 	platform_class->sysctl_set = sysctl_set;
 	platform_class->sysctl_set_async = sysctl_set_async;
+	platform_class->sysctl_set_batched = sysctl_set_batched;
 	platform_class->sysctl_get = sysctl_get;
 
 	platform_class->link_add = link_add;
@@ -9335,12 +11395,14 @@ nm_linux_platform_class_init (NMLinuxPlatformClass *klass)
 	platform_class->link_6lowpan_add = link_6lowpan_add;
 
 	platform_class->object_delete = object_delete;
+	platform_class->object_delete_batch = object_delete_batch;
 	platform_class->ip4_address_add = ip4_address_add;
 	platform_class->ip6_address_add = ip6_address_add;
 	platform_class->ip4_address_delete = ip4_address_delete;
 	platform_class->ip6_address_delete = ip6_address_delete;
 
 	platform_class->ip_route_add = ip_route_add;
+	platform_class->ip_route_add_batch = ip_route_add_batch;
 	platform_class->ip_route_get = ip_route_get;
 
 	platform_class->routing_rule_add = routing_rule_add;
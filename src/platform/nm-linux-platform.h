@@ -15,6 +15,16 @@
 #define NM_IS_LINUX_PLATFORM_CLASS(klass) (G_TYPE_CHECK_CLASS_TYPE ((klass), NM_TYPE_LINUX_PLATFORM))
 #define NM_LINUX_PLATFORM_GET_CLASS(obj)  (G_TYPE_INSTANCE_GET_CLASS ((obj), NM_TYPE_LINUX_PLATFORM, NMLinuxPlatformClass))
 
+/* A list of route tables (numbers, or "main", "local" and "default"),
+ * separated by comma or space. If set, routes in other tables are not
+ * cached. */
+#define NM_LINUX_PLATFORM_CACHE_ROUTE_TABLES    "cache-route-tables"
+
+/* A list of route protocols (numbers, or "kernel", "boot", "static", "ra" and
+ * "dhcp"), separated by comma or space. If set, routes with other protocols
+ * are not cached. */
+#define NM_LINUX_PLATFORM_CACHE_ROUTE_PROTOCOLS "cache-route-protocols"
+
 typedef struct _NMLinuxPlatform NMLinuxPlatform;
 typedef struct _NMLinuxPlatformClass NMLinuxPlatformClass;
 
@@ -23,5 +33,56 @@ GType nm_linux_platform_get_type (void);
 NMPlatform *nm_linux_platform_new (gboolean log_with_ptr, gboolean netns_support);
 
 void nm_linux_platform_setup (void);
+void nm_linux_platform_setup_full (const char *cache_route_tables,
+                                   const char *cache_route_protocols);
+
+void nm_linux_platform_set_sysctl_read_cache (NMPlatform *platform,
+                                              gboolean enabled);
+
+gboolean nm_linux_platform_capture_start (NMPlatform *platform,
+                                         const char *filename,
+                                         GError **error);
+void nm_linux_platform_capture_stop (NMPlatform *platform);
+
+gboolean nm_linux_platform_replay (NMPlatform *platform,
+                                   const char *filename,
+                                   gboolean realtime,
+                                   guint *out_n_records,
+                                   GError **error);
+
+typedef struct {
+	/* how often the netlink socket became readable and was drained. */
+	guint64 n_wakeups;
+
+	/* the number of receive calls and the datagrams received by them. */
+	guint64 n_recv_calls;
+	guint64 n_datagrams;
+
+	/* the number of netlink messages processed. */
+	guint64 n_messages;
+
+	/* the number of messages processed during the last wakeup, and the
+	 * maximum seen so far. */
+	guint last_messages_per_wakeup;
+	guint max_messages_per_wakeup;
+
+	/* how often the socket overflowed (ENOBUFS) and how many datagrams
+	 * were lost because the receive buffer was too small. */
+	guint64 n_enobufs;
+	guint64 n_truncated;
+
+	/* how often the cache was resynchronized after losing events, the
+	 * number of object types dumped right away and the number of object types
+	 * whose dump was deferred. */
+	guint64 n_resyncs;
+	guint64 n_resync_types_dumped;
+	guint64 n_resync_types_deferred;
+
+	/* the currently requested size of the socket receive buffer. */
+	int rx_buffer_size;
+} NMLinuxPlatformNetlinkStats;
+
+void nm_linux_platform_get_netlink_stats (NMPlatform *platform,
+                                          NMLinuxPlatformNetlinkStats *out_stats);
 
 #endif /* __NETWORKMANAGER_LINUX_PLATFORM_H__ */
@@ -27,6 +27,10 @@
 #define NETLINK_EXT_ACK         11
 #endif
 
+#ifndef NETLINK_GET_STRICT_CHK
+#define NETLINK_GET_STRICT_CHK  12
+#endif
+
 struct nl_msg {
 	int                     nm_protocol;
 	struct sockaddr_nl      nm_src;
@@ -35,6 +39,7 @@ struct nl_msg {
 	struct nlmsghdr *       nm_nlh;
 	size_t                  nm_size;
 	bool                    nm_creds_has:1;
+	bool                    nm_borrowed:1;
 };
 
 struct nl_sock {
@@ -290,6 +295,24 @@ nlmsg_alloc_convert (struct nlmsghdr *hdr)
 	return nm;
 }
 
+/* Like nlmsg_alloc_convert(), but the message references @hdr instead of
+ * copying it. @hdr must stay valid for the lifetime of the message, and the
+ * message cannot be extended. */
+struct nl_msg *
+nlmsg_alloc_borrow (struct nlmsghdr *hdr)
+{
+	struct nl_msg *nm;
+
+	nm = g_slice_new (struct nl_msg);
+	*nm = (struct nl_msg) {
+		.nm_protocol = -1,
+		.nm_nlh = hdr,
+		.nm_size = 0,
+		.nm_borrowed = TRUE,
+	};
+	return nm;
+}
+
 struct nl_msg *
 nlmsg_alloc_simple (int nlmsgtype, int flags)
 {
@@ -308,7 +331,8 @@ void nlmsg_free (struct nl_msg *msg)
 	if (!msg)
 		return;
 
-	g_free (msg->nm_nlh);
+	if (!msg->nm_borrowed)
+		g_free (msg->nm_nlh);
 	g_slice_free (struct nl_msg, msg);
 }
 
@@ -940,6 +964,26 @@ nl_socket_set_buffer_size (struct nl_sock *sk, int rxbuf, int txbuf)
 	return 0;
 }
 
+/* Set the receive buffer size of the socket. With CAP_NET_ADMIN, this
+ * can exceed net.core.rmem_max (SO_RCVBUFFORCE). Otherwise, kernel caps
+ * the size silently. */
+int
+nl_socket_set_rx_buffer_size (struct nl_sock *sk, int rxbuf)
+{
+	if (sk->s_fd == -1)
+		return -NME_NL_BAD_SOCK;
+
+	if (setsockopt (sk->s_fd, SOL_SOCKET, SO_RCVBUFFORCE,
+	                &rxbuf, sizeof (rxbuf)) == 0)
+		return 0;
+
+	if (setsockopt (sk->s_fd, SOL_SOCKET, SO_RCVBUF,
+	                &rxbuf, sizeof (rxbuf)) < 0)
+		return -nm_errno_from_native (errno);
+
+	return 0;
+}
+
 int
 nl_socket_add_memberships (struct nl_sock *sk, int group, ...)
 {
@@ -990,6 +1034,22 @@ nl_socket_set_ext_ack (struct nl_sock *sk, gboolean enable)
 	return 0;
 }
 
+int
+nl_socket_set_get_strict_chk (struct nl_sock *sk, gboolean enable)
+{
+	int err, val;
+
+	if (sk->s_fd == -1)
+		return -NME_NL_BAD_SOCK;
+
+	val = !!enable;
+	err = setsockopt (sk->s_fd, SOL_NETLINK, NETLINK_GET_STRICT_CHK, &val, sizeof (val));
+	if (err < 0)
+		return -nm_errno_from_native (errno);
+
+	return 0;
+}
+
 void nl_socket_disable_msg_peek (struct nl_sock *sk)
 {
 	sk->s_flags |= NL_MSG_PEEK_EXPLICIT;
@@ -1349,6 +1409,37 @@ int nl_send_auto (struct nl_sock *sk, struct nl_msg *msg)
 	return nl_send (sk, msg);
 }
 
+/* Receive up to @vlen datagrams with one recvmmsg() call. The caller
+ * prepares @msgvec with the buffers. In contrast to nl_recv(), a datagram
+ * that does not fit into its buffer is not retried, but is returned with
+ * MSG_TRUNC set in its msg_flags.
+ *
+ * Returns the number of received datagrams or a negative error code. */
+int
+nl_recvmmsg (struct nl_sock *sk,
+             struct mmsghdr *msgvec,
+             unsigned vlen)
+{
+	int n;
+	int errsv;
+
+	nm_assert (msgvec);
+	nm_assert (vlen > 0);
+
+	if (sk->s_fd == -1)
+		return -NME_NL_BAD_SOCK;
+
+again:
+	n = recvmmsg (sk->s_fd, msgvec, vlen, 0, NULL);
+	if (n < 0) {
+		errsv = errno;
+		if (errsv == EINTR)
+			goto again;
+		return -nm_errno_from_native (errsv);
+	}
+	return n;
+}
+
 int
 nl_recv (struct nl_sock *sk,
          struct sockaddr_nl *nla,
@@ -381,6 +381,8 @@ struct nl_msg *nlmsg_alloc_size (size_t max);
 
 struct nl_msg *nlmsg_alloc_convert (struct nlmsghdr *hdr);
 
+struct nl_msg *nlmsg_alloc_borrow (struct nlmsghdr *hdr);
+
 struct nl_msg *nlmsg_alloc_simple (int nlmsgtype, int flags);
 
 void *nlmsg_reserve (struct nl_msg *n, size_t len, int pad);
@@ -528,6 +530,8 @@ int nl_socket_set_msg_buf_size (struct nl_sock *sk, size_t bufsize);
 
 int nl_socket_set_buffer_size (struct nl_sock *sk, int rxbuf, int txbuf);
 
+int nl_socket_set_rx_buffer_size (struct nl_sock *sk, int rxbuf);
+
 int nl_socket_set_passcred (struct nl_sock *sk, int state);
 
 int nl_socket_set_nonblocking (const struct nl_sock *sk);
@@ -546,6 +550,10 @@ int nl_recv (struct nl_sock *sk,
              struct ucred *out_creds,
              gboolean *out_creds_has);
 
+int nl_recvmmsg (struct nl_sock *sk,
+                 struct mmsghdr *msgvec,
+                 unsigned vlen);
+
 int nl_send (struct nl_sock *sk, struct nl_msg *msg);
 
 int nl_send_auto (struct nl_sock *sk, struct nl_msg *msg);
@@ -593,6 +601,8 @@ int nl_wait_for_ack (struct nl_sock *sk,
 
 int nl_socket_set_ext_ack (struct nl_sock *sk, gboolean enable);
 
+int nl_socket_set_get_strict_chk (struct nl_sock *sk, gboolean enable);
+
 /*****************************************************************************/
 
 void *genlmsg_put (struct nl_msg *msg, uint32_t port, uint32_t seq, int family,
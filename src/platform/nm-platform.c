@@ -169,6 +169,11 @@ typedef struct _NMPlatformPrivate {
 	GHashTable *ip4_dev_route_blacklist_hash;
 	NMDedupMultiIndex *multi_idx;
 	NMPCache *cache;
+
+	/* per ifindex, the addresses and routes from the last sync. See IPSyncState. */
+	GHashTable *ip_sync_states;
+
+	guint64 ip_change_requests;
 } NMPlatformPrivate;
 
 G_DEFINE_TYPE (NMPlatform, nm_platform, G_TYPE_OBJECT)
@@ -193,6 +198,21 @@ nm_platform_get_log_with_ptr (NMPlatform *self)
 	return NM_PLATFORM_GET_PRIVATE (self)->log_with_ptr;
 }
 
+/**
+ * nm_platform_get_ip_change_requests:
+ * @self: the #NMPlatform instance.
+ *
+ * Returns: the number of requests to add or delete addresses and routes,
+ *   that were passed on to the platform implementation. For the linux
+ *   platform, each request corresponds to one netlink message. This
+ *   is useful for testing.
+ */
+guint64
+nm_platform_get_ip_change_requests (NMPlatform *self)
+{
+	return NM_PLATFORM_GET_PRIVATE (self)->ip_change_requests;
+}
+
 /*****************************************************************************/
 
 guint
@@ -558,6 +578,84 @@ void nm_platform_sysctl_set_async (NMPlatform *self,
 	klass->sysctl_set_async (self, pathid, dirfd, path, values, callback, data, cancellable);
 }
 
+static void
+_sysctl_set_batched_return_idle (gpointer user_data,
+                                 GCancellable *cancellable)
+{
+	gs_unref_object NMPlatform *self = NULL;
+	gs_free_error GError *error = NULL;
+	NMPlatformAsyncCallback callback;
+	gpointer callback_data;
+
+	nm_utils_user_data_unpack (user_data, &self, &callback, &callback_data, &error);
+	callback (error, callback_data);
+}
+
+/**
+ * nm_platform_sysctl_set_batched:
+ * @self: platform instance
+ * @pathid: if @dirfd is present, this must be the full path that is looked up
+ * @dirfd: optional file descriptor for parent directory for openat()
+ * @path: absolute option path
+ * @value: the value to write
+ * @callback: (allow-none): function called on completion
+ * @data: data passed to callback function
+ *
+ * Like nm_platform_sysctl_set(), but the write is only queued. All writes
+ * queued during one main loop iteration are performed together on a worker
+ * thread, in the order in which they were queued. The callback is invoked
+ * asynchronously with the result of this write. A later nm_platform_sysctl_set()
+ * to the same path supersedes the queued write.
+ *
+ * Note that a nm_platform_sysctl_get() may not yet see the new value.
+ */
+void
+nm_platform_sysctl_set_batched (NMPlatform *self,
+                                const char *pathid,
+                                int dirfd,
+                                const char *path,
+                                const char *value,
+                                NMPlatformAsyncCallback callback,
+                                gpointer data)
+{
+	_CHECK_SELF_VOID (self, klass);
+
+	g_return_if_fail (path);
+	g_return_if_fail (value);
+	g_return_if_fail (!data || callback);
+
+	if (klass->sysctl_set_batched) {
+		klass->sysctl_set_batched (self, pathid, dirfd, path, value, callback, data);
+		return;
+	}
+
+	/* fallback for platforms without batching: write synchronously, but
+	 * still report the result asynchronously. */
+	if (   !klass->sysctl_set (self, pathid, dirfd, path, value)
+	    && callback) {
+		int errsv = errno;
+		GError *error = NULL;
+
+		g_set_error (&error,
+		             NM_UTILS_ERROR,
+		             NM_UTILS_ERROR_UNKNOWN,
+		             "sysctl: failed setting '%s' to value '%s': %s",
+		             pathid ?: path,
+		             value,
+		             nm_strerror_native (errsv));
+		nm_utils_invoke_on_idle (_sysctl_set_batched_return_idle,
+		                         nm_utils_user_data_pack (g_object_ref (self), callback, data, error),
+		                         NULL);
+		return;
+	}
+
+	if (callback) {
+		nm_utils_invoke_on_idle (_sysctl_set_batched_return_idle,
+		                         nm_utils_user_data_pack (g_object_ref (self), callback, data, NULL),
+		                         NULL);
+	}
+}
+
 
 gboolean
 nm_platform_sysctl_ip_conf_set_ipv6_hop_limit_safe (NMPlatform *self,
@@ -803,6 +901,27 @@ nm_platform_sysctl_ip_conf_set (NMPlatform *self,
 	                               value);
 }
 
+void
+nm_platform_sysctl_ip_conf_set_batched (NMPlatform *self,
+                                        int addr_family,
+                                        const char *ifname,
+                                        const char *property,
+                                        const char *value,
+                                        NMPlatformAsyncCallback callback,
+                                        gpointer data)
+{
+	char buf[NM_UTILS_SYSCTL_IP_CONF_PATH_BUFSIZE];
+
+	nm_platform_sysctl_set_batched (self,
+	                                NMP_SYSCTL_PATHID_ABSOLUTE (nm_utils_sysctl_ip_conf_path (addr_family,
+	                                                                                          buf,
+	                                                                                          ifname,
+	                                                                                          property)),
+	                                value,
+	                                callback,
+	                                data);
+}
+
 gboolean
 nm_platform_sysctl_ip_conf_set_int64 (NMPlatform *self,
                                       int addr_family,
@@ -3704,6 +3823,7 @@ nm_platform_ip4_address_add (NMPlatform *self,
 
 		_LOG3D ("address: adding or updating IPv4 address: %s", nm_platform_ip4_address_to_string (&addr, NULL, 0));
 	}
+	NM_PLATFORM_GET_PRIVATE (self)->ip_change_requests++;
 	return klass->ip4_address_add (self, ifindex, address, plen, peer_address, lifetime, preferred, flags, label);
 }
 
@@ -3738,6 +3858,7 @@ nm_platform_ip6_address_add (NMPlatform *self,
 
 		_LOG3D ("address: adding or updating IPv6 address: %s", nm_platform_ip6_address_to_string (&addr, NULL, 0));
 	}
+	NM_PLATFORM_GET_PRIVATE (self)->ip_change_requests++;
 	return klass->ip6_address_add (self, ifindex, address, plen, peer_address, lifetime, preferred, flags);
 }
 
@@ -3763,6 +3884,7 @@ nm_platform_ip4_address_delete (NMPlatform *self, int ifindex, in_addr_t address
 	                              nm_utils_inet4_ntop (peer_address, b2))
 	            : "",
 	        _to_string_dev (self, ifindex, str_dev, sizeof (str_dev)));
+	NM_PLATFORM_GET_PRIVATE (self)->ip_change_requests++;
 	return klass->ip4_address_delete (self, ifindex, address, plen, peer_address);
 }
 
@@ -3780,6 +3902,7 @@ nm_platform_ip6_address_delete (NMPlatform *self, int ifindex, struct in6_addr a
 	_LOG3D ("address: deleting IPv6 address %s/%d, %s",
 	        nm_utils_inet6_ntop (&address, sbuf), plen,
 	        _to_string_dev (self, ifindex, str_dev, sizeof (str_dev)));
+	NM_PLATFORM_GET_PRIVATE (self)->ip_change_requests++;
 	return klass->ip6_address_delete (self, ifindex, address, plen);
 }
 
@@ -3878,6 +4001,239 @@ clear_and_next:
 	return any_addrs;
 }
 
+/*****************************************************************************/
+
+/* IPSyncState remembers per ifindex which addresses and routes were configured
+ * by the last nm_platform_ip4_address_sync(), nm_platform_ip6_address_sync()
+ * and nm_platform_ip_route_sync() call.
+ *
+ * On the next sync, all committed entries are marked as dirty, and adding the
+ * new objects clears the dirty flag again. Objects that are unchanged since the
+ * last sync are skipped right away, without looking into the platform cache
+ * or sending a netlink request. The entries that are still dirty afterwards are
+ * no longer configured.
+ *
+ * This only works as long as the committed state agrees with the platform
+ * cache. Hence, _ip_sync_state_cache_update() drops committed entries, as
+ * soon as the platform cache no longer has them (or has them with different
+ * attributes). */
+
+typedef enum {
+	IP_SYNC_TYPE_IP4_ADDRESS,
+	IP_SYNC_TYPE_IP6_ADDRESS,
+	IP_SYNC_TYPE_IP4_ROUTE,
+	IP_SYNC_TYPE_IP6_ROUTE,
+	_IP_SYNC_TYPE_NUM,
+} IPSyncType;
+
+typedef struct {
+	NMDedupMultiIndex *multi_idx;
+	int ifindex;
+	NMDedupMultiIdxType idx_types[_IP_SYNC_TYPE_NUM];
+} IPSyncState;
+
+static IPSyncType
+_ip_sync_type_from_obj_type (NMPObjectType obj_type)
+{
+	switch (obj_type) {
+	case NMP_OBJECT_TYPE_IP4_ADDRESS: return IP_SYNC_TYPE_IP4_ADDRESS;
+	case NMP_OBJECT_TYPE_IP6_ADDRESS: return IP_SYNC_TYPE_IP6_ADDRESS;
+	case NMP_OBJECT_TYPE_IP4_ROUTE:   return IP_SYNC_TYPE_IP4_ROUTE;
+	case NMP_OBJECT_TYPE_IP6_ROUTE:   return IP_SYNC_TYPE_IP6_ROUTE;
+	default:
+		return _IP_SYNC_TYPE_NUM;
+	}
+}
+
+static void
+_ip_sync_idx_obj_id_hash_update (const NMDedupMultiIdxType *idx_type,
+                                 const NMDedupMultiObj *obj,
+                                 NMHashState *h)
+{
+	nmp_object_id_hash_update ((NMPObject *) obj, h);
+}
+
+static gboolean
+_ip_sync_idx_obj_id_equal (const NMDedupMultiIdxType *idx_type,
+                           const NMDedupMultiObj *obj_a,
+                           const NMDedupMultiObj *obj_b)
+{
+	return nmp_object_id_equal ((NMPObject *) obj_a, (NMPObject *) obj_b);
+}
+
+static void
+_ip_sync_state_free (gpointer data)
+{
+	IPSyncState *state = data;
+	IPSyncType t;
+
+	for (t = 0; t < _IP_SYNC_TYPE_NUM; t++)
+		nm_dedup_multi_index_remove_idx (state->multi_idx, &state->idx_types[t]);
+	g_slice_free (IPSyncState, state);
+}
+
+static NMDedupMultiIdxType *
+_ip_sync_state_get_idx_type (NMPlatform *self,
+                             int ifindex,
+                             NMPObjectType obj_type,
+                             gboolean create)
+{
+	static const NMDedupMultiIdxTypeClass idx_type_class = {
+		.idx_obj_id_hash_update = _ip_sync_idx_obj_id_hash_update,
+		.idx_obj_id_equal = _ip_sync_idx_obj_id_equal,
+	};
+	NMPlatformPrivate *priv = NM_PLATFORM_GET_PRIVATE (self);
+	IPSyncState *state;
+	IPSyncType t;
+
+	nm_assert (ifindex > 0);
+	nm_assert (_ip_sync_type_from_obj_type (obj_type) < _IP_SYNC_TYPE_NUM);
+
+	state = priv->ip_sync_states
+	        ? g_hash_table_lookup (priv->ip_sync_states, GINT_TO_POINTER (ifindex))
+	        : NULL;
+	if (!state) {
+		if (!create)
+			return NULL;
+		if (!priv->ip_sync_states)
+			priv->ip_sync_states = g_hash_table_new_full (nm_direct_hash, NULL, NULL, _ip_sync_state_free);
+		state = g_slice_new (IPSyncState);
+		state->multi_idx = priv->multi_idx;
+		state->ifindex = ifindex;
+		for (t = 0; t < _IP_SYNC_TYPE_NUM; t++)
+			nm_dedup_multi_idx_type_init (&state->idx_types[t], &idx_type_class);
+		g_hash_table_insert (priv->ip_sync_states, GINT_TO_POINTER (ifindex), state);
+	}
+
+	return &state->idx_types[_ip_sync_type_from_obj_type (obj_type)];
+}
+
+static NMDedupMultiIdxType *
+_ip_sync_state_start (NMPlatform *self,
+                      int ifindex,
+                      NMPObjectType obj_type,
+                      gboolean has_objs)
+{
+	NMDedupMultiIndex *multi_idx = NM_PLATFORM_GET_PRIVATE (self)->multi_idx;
+	NMDedupMultiIdxType *idx_type;
+
+	idx_type = _ip_sync_state_get_idx_type (self, ifindex, obj_type, has_objs);
+	if (!idx_type)
+		return NULL;
+
+	if (!has_objs) {
+		/* we flush everything. Forget about the previous state. */
+		nm_dedup_multi_index_remove_idx (multi_idx, idx_type);
+		return NULL;
+	}
+
+	nm_dedup_multi_index_dirty_set_idx (multi_idx, idx_type);
+	return idx_type;
+}
+
+static gboolean
+_ip_sync_state_commit (NMPlatform *self,
+                       NMDedupMultiIdxType *idx_type,
+                       const NMPObject *obj)
+{
+	/* Returns %FALSE if @obj is unchanged since the last sync (and
+	 * thus, still configured). */
+	return nm_dedup_multi_index_add (NM_PLATFORM_GET_PRIVATE (self)->multi_idx,
+	                                 idx_type,
+	                                 obj,
+	                                 NM_DEDUP_MULTI_IDX_MODE_APPEND,
+	                                 NULL,
+	                                 NULL);
+}
+
+static void
+_ip_sync_state_forget (NMPlatform *self,
+                       NMDedupMultiIdxType *idx_type,
+                       const NMPObject *obj)
+{
+	nm_dedup_multi_index_remove_obj (NM_PLATFORM_GET_PRIVATE (self)->multi_idx,
+	                                 idx_type,
+	                                 obj,
+	                                 NULL);
+}
+
+static void
+_ip_sync_state_finish (NMPlatform *self,
+                       NMDedupMultiIdxType *idx_type)
+{
+	if (!idx_type)
+		return;
+
+	/* all entries that are still dirty are no longer configured (or
+	 * the sync failed before it got to them). */
+	nm_dedup_multi_index_dirty_remove_idx (NM_PLATFORM_GET_PRIVATE (self)->multi_idx,
+	                                       idx_type,
+	                                       FALSE);
+}
+
+static void
+_ip_sync_state_cache_update (NMPlatform *self,
+                             NMPCacheOpsType cache_op,
+                             const NMPObject *obj_old,
+                             const NMPObject *obj_new)
+{
+	NMPlatformPrivate *priv = NM_PLATFORM_GET_PRIVATE (self);
+	NMDedupMultiIdxType *idx_type;
+	const NMDedupMultiEntry *entry;
+	NMPObjectType obj_type;
+	int ifindex;
+
+	if (   !priv->ip_sync_states
+	    || !NM_IN_SET (cache_op, NMP_CACHE_OPS_UPDATED, NMP_CACHE_OPS_REMOVED))
+		return;
+
+	obj_type = NMP_OBJECT_GET_TYPE (obj_old);
+
+	if (obj_type == NMP_OBJECT_TYPE_LINK) {
+		if (   cache_op == NMP_CACHE_OPS_REMOVED
+		    || !nmp_object_is_visible (obj_new))
+			g_hash_table_remove (priv->ip_sync_states, GINT_TO_POINTER (obj_old->link.ifindex));
+		return;
+	}
+
+	if (_ip_sync_type_from_obj_type (obj_type) == _IP_SYNC_TYPE_NUM)
+		return;
+
+	ifindex = NMP_OBJECT_CAST_OBJ_WITH_IFINDEX (obj_old)->ifindex;
+	if (ifindex <= 0)
+		return;
+
+	idx_type = _ip_sync_state_get_idx_type (self, ifindex, obj_type, FALSE);
+	if (!idx_type)
+		return;
+
+	entry = nm_dedup_multi_index_lookup_obj (priv->multi_idx, idx_type, obj_old);
+	if (!entry)
+		return;
+
+	if (   cache_op == NMP_CACHE_OPS_UPDATED
+	    && nmp_object_is_visible (obj_new)) {
+		if (NM_IN_SET (obj_type, NMP_OBJECT_TYPE_IP4_ADDRESS, NMP_OBJECT_TYPE_IP6_ADDRESS)) {
+			const NMPlatformIPAddress *a_old = NMP_OBJECT_CAST_IP_ADDRESS (obj_old);
+			const NMPlatformIPAddress *a_new = NMP_OBJECT_CAST_IP_ADDRESS (obj_new);
+
+			/* kernel updates addresses when DAD completes or when the preferred
+			 * lifetime is over. That doesn't matter. But if the lifetimes or
+			 * other flags change, somebody else modified the address and the
+			 * next sync must configure it again. */
+			if (   nm_platform_ip_address_cmp_expiry (a_old, a_new) == 0
+			    && (  (a_old->n_ifa_flags ^ a_new->n_ifa_flags)
+			        & ~((guint32) (IFA_F_TENTATIVE | IFA_F_DEPRECATED))) == 0)
+				return;
+		} else if (nm_platform_vtable_route.vx[obj_type == NMP_OBJECT_TYPE_IP4_ROUTE].route_cmp (NMP_OBJECT_CAST_IPX_ROUTE (entry->obj),
+		                                                                                         NMP_OBJECT_CAST_IPX_ROUTE (obj_new),
+		                                                                                         NM_PLATFORM_IP_ROUTE_CMP_TYPE_SEMANTICALLY) == 0)
+			return;
+	}
+
+	nm_dedup_multi_index_remove_entry (priv->multi_idx, entry);
+}
+
 static gboolean
 ip4_addr_subnets_is_plain_address (const GPtrArray *addresses, gconstpointer needle)
 {
@@ -4056,6 +4412,7 @@ nm_platform_ip4_address_sync (NMPlatform *self,
 	NMPLookup lookup;
 	guint32 lifetime, preferred;
 	guint32 ifa_flags;
+	NMDedupMultiIdxType *sync_idx;
 
 	_CHECK_SELF (self, klass, FALSE);
 
@@ -4139,8 +4496,14 @@ nm_platform_ip4_address_sync (NMPlatform *self,
 	}
 	ip4_addr_subnets_destroy_index (plat_subnets, plat_addresses);
 
-	if (!known_addresses)
+	/* Deleting addresses above already dropped them from the committed
+	 * state (see _ip_sync_state_cache_update()). */
+	sync_idx = _ip_sync_state_start (self, ifindex, NMP_OBJECT_TYPE_IP4_ADDRESS, !!known_addresses);
+
+	if (!known_addresses) {
+		_ip_sync_state_finish (self, sync_idx);
 		return TRUE;
+	}
 
 	ip4_addr_subnets_destroy_index (known_subnets, known_addresses);
 
@@ -4163,18 +4526,29 @@ nm_platform_ip4_address_sync (NMPlatform *self,
 		if (!lifetime)
 			goto delete_and_next2;
 
+		if (!_ip_sync_state_commit (self, sync_idx, o)) {
+			/* unchanged since the last sync. */
+			continue;
+		}
+
 		if (!nm_platform_ip4_address_add (self, ifindex, known_address->address, known_address->plen,
 		                                  known_address->peer_address, lifetime, preferred,
 		                                  ifa_flags,
 		                                  known_address->label))
 			goto delete_and_next2;
 
+		/* the notification about our own change may have dropped the
+		 * entry again. */
+		_ip_sync_state_commit (self, sync_idx, o);
 		continue;
 delete_and_next2:
+		_ip_sync_state_forget (self, sync_idx, o);
 		nmp_object_unref (o);
 		known_addresses->pdata[i] = NULL;
 	}
 
+	_ip_sync_state_finish (self, sync_idx);
+
 	return TRUE;
 }
 
@@ -4229,6 +4603,8 @@ nm_platform_ip6_address_sync (NMPlatform *self,
 	gs_unref_hashtable GHashTable *known_addresses_idx = NULL;
 	NMPLookup lookup;
 	guint32 ifa_flags;
+	NMDedupMultiIdxType *sync_idx;
+	gboolean success = TRUE;
 
 	/* The order we want to enforce is only among addresses with the same
 	 * scope, as the kernel keeps addresses sorted by scope. Therefore,
@@ -4341,8 +4717,12 @@ next_plat:
 		}
 	}
 
-	if (!known_addresses)
+	sync_idx = _ip_sync_state_start (self, ifindex, NMP_OBJECT_TYPE_IP6_ADDRESS, !!known_addresses);
+
+	if (!known_addresses) {
+		_ip_sync_state_finish (self, sync_idx);
 		return TRUE;
+	}
 
 	ifa_flags =   nm_platform_kernel_support_get (NM_PLATFORM_KERNEL_SUPPORT_TYPE_EXTENDED_IFA_FLAGS)
 	            ? IFA_F_NOPREFIXROUTE
@@ -4361,14 +4741,31 @@ next_plat:
 		lifetime = nm_utils_lifetime_get (known_address->timestamp, known_address->lifetime, known_address->preferred,
 		                                  now, &preferred);
 
+		if (!_ip_sync_state_commit (self, sync_idx, known_addresses->pdata[i_know])) {
+			/* unchanged since the last sync. Re-adding it would not change
+			 * its priority either. */
+			continue;
+		}
+
 		if (!nm_platform_ip6_address_add (self, ifindex, known_address->address,
 		                                  known_address->plen, known_address->peer_address,
 		                                  lifetime, preferred,
-		                                  ifa_flags | known_address->n_ifa_flags))
-			return FALSE;
+		                                  ifa_flags | known_address->n_ifa_flags)) {
+			_ip_sync_state_forget (self, sync_idx, known_addresses->pdata[i_know]);
+			success = FALSE;
+			break;
+		}
+
+		/* the notification about our own change may have dropped the
+		 * entry again. */
+		_ip_sync_state_commit (self, sync_idx, known_addresses->pdata[i_know]);
 	}
 
-	return TRUE;
+	/* also after a failure. The addresses that we didn't get to are
+	 * still dirty and must be configured by the next sync. */
+	_ip_sync_state_finish (self, sync_idx);
+
+	return success;
 }
 
 gboolean
@@ -4480,6 +4877,136 @@ nm_platform_ip_route_get_prune_list (NMPlatform *self,
 	return routes_prune;
 }
 
+static gboolean
+_ip_route_sync_handle_add_result (NMPlatform *self,
+                                  const NMPlatformVTableRoute *vt,
+                                  const NMPObject *conf_o,
+                                  int r,
+                                  GPtrArray **out_temporary_not_available)
+{
+	const int ifindex = NMP_OBJECT_CAST_IP_ROUTE (conf_o)->ifindex;
+	const NMDedupMultiEntry *plat_entry;
+	gboolean gateway_route_added = FALSE;
+	char sbuf1[sizeof (_nm_utils_to_string_buffer)];
+	char sbuf2[sizeof (_nm_utils_to_string_buffer)];
+	int r2;
+
+again:
+	if (r >= 0)
+		return TRUE;
+
+	if (r == -EEXIST) {
+		/* Don't fail for EEXIST. It's not clear that the existing route
+		 * is identical to the one that we were about to add. However,
+		 * above we should have deleted conflicting (non-identical) routes. */
+		if (_LOGD_ENABLED ()) {
+			plat_entry = nm_platform_lookup_entry (self,
+			                                       NMP_CACHE_ID_TYPE_OBJECT_TYPE,
+			                                       conf_o);
+			if (!plat_entry) {
+				_LOG3D ("route-sync: adding route %s failed with EEXIST, however we cannot find such a route",
+				        nmp_object_to_string (conf_o, NMP_OBJECT_TO_STRING_PUBLIC, sbuf1, sizeof (sbuf1)));
+			} else if (vt->route_cmp (NMP_OBJECT_CAST_IPX_ROUTE (conf_o),
+			                          NMP_OBJECT_CAST_IPX_ROUTE (plat_entry->obj),
+			                          NM_PLATFORM_IP_ROUTE_CMP_TYPE_SEMANTICALLY) != 0) {
+				_LOG3D ("route-sync: adding route %s failed due to existing (different!) route %s",
+				        nmp_object_to_string (conf_o, NMP_OBJECT_TO_STRING_PUBLIC, sbuf1, sizeof (sbuf1)),
+				        nmp_object_to_string (plat_entry->obj, NMP_OBJECT_TO_STRING_PUBLIC, sbuf2, sizeof (sbuf2)));
+			}
+		}
+		return TRUE;
+	}
+
+	if (NMP_OBJECT_CAST_IP_ROUTE (conf_o)->rt_source < NM_IP_CONFIG_SOURCE_USER) {
+		_LOG3D ("route-sync: ignore failure to add IPv%c route: %s: %s",
+		       vt->is_ip4 ? '4' : '6',
+		       nmp_object_to_string (conf_o, NMP_OBJECT_TO_STRING_PUBLIC, sbuf1, sizeof (sbuf1)),
+		       nm_strerror (r));
+		return TRUE;
+	}
+
+	if (   r == -EINVAL
+	    && out_temporary_not_available
+	    && _err_inval_due_to_ipv6_tentative_pref_src (self, conf_o)) {
+		_LOG3D ("route-sync: ignore failure to add IPv6 route with tentative IPv6 pref-src: %s: %s",
+		        nmp_object_to_string (conf_o, NMP_OBJECT_TO_STRING_PUBLIC, sbuf1, sizeof (sbuf1)),
+		        nm_strerror (r));
+		if (!*out_temporary_not_available)
+			*out_temporary_not_available = g_ptr_array_new_full (0, (GDestroyNotify) nmp_object_unref);
+		g_ptr_array_add (*out_temporary_not_available, (gpointer) nmp_object_ref (conf_o));
+		return TRUE;
+	}
+
+	if (   !gateway_route_added
+	    && (   (   r == -ENETUNREACH
+	            && vt->is_ip4
+	            && !!NMP_OBJECT_CAST_IP4_ROUTE (conf_o)->gateway)
+	        || (   r == -EHOSTUNREACH
+	            && !vt->is_ip4
+	            && !IN6_IS_ADDR_UNSPECIFIED (&NMP_OBJECT_CAST_IP6_ROUTE (conf_o)->gateway)))) {
+		NMPObject oo;
+
+		if (vt->is_ip4) {
+			const NMPlatformIP4Route *rt = NMP_OBJECT_CAST_IP4_ROUTE (conf_o);
+
+			nmp_object_stackinit (&oo,
+			                      NMP_OBJECT_TYPE_IP4_ROUTE,
+			                      &((NMPlatformIP4Route) {
+			                          .ifindex = rt->ifindex,
+			                          .network = rt->gateway,
+			                          .plen = 32,
+			                          .metric = rt->metric,
+			                          .rt_source = rt->rt_source,
+			                          .table_coerced = rt->table_coerced,
+			                      }));
+		} else {
+			const NMPlatformIP6Route *rt = NMP_OBJECT_CAST_IP6_ROUTE (conf_o);
+
+			nmp_object_stackinit (&oo,
+			                      NMP_OBJECT_TYPE_IP6_ROUTE,
+			                      &((NMPlatformIP6Route) {
+			                          .ifindex = rt->ifindex,
+			                          .network = rt->gateway,
+			                          .plen = 128,
+			                          .metric = rt->metric,
+			                          .rt_source = rt->rt_source,
+			                          .table_coerced = rt->table_coerced,
+			                      }));
+		}
+
+		_LOG3D ("route-sync: failure to add IPv%c route: %s: %s; try adding direct route to gateway %s",
+		        vt->is_ip4 ? '4' : '6',
+		        nmp_object_to_string (conf_o, NMP_OBJECT_TO_STRING_PUBLIC, sbuf1, sizeof (sbuf1)),
+		        nm_strerror (r),
+		        nmp_object_to_string (&oo, NMP_OBJECT_TO_STRING_PUBLIC, sbuf2, sizeof (sbuf2)));
+
+		r2 = nm_platform_ip_route_add (self,
+		                                 NMP_NLM_FLAG_APPEND
+		                               | NMP_NLM_FLAG_SUPPRESS_NETLINK_FAILURE,
+		                               &oo);
+
+		if (r2 < 0) {
+			_LOG3D ("route-sync: failure to add gateway IPv%c route: %s: %s",
+			        vt->is_ip4 ? '4' : '6',
+			        nmp_object_to_string (conf_o, NMP_OBJECT_TO_STRING_PUBLIC, sbuf1, sizeof (sbuf1)),
+			        nm_strerror (r2));
+		}
+
+		gateway_route_added = TRUE;
+		r = nm_platform_ip_route_add (self,
+		                                NMP_NLM_FLAG_APPEND
+		                              | NMP_NLM_FLAG_SUPPRESS_NETLINK_FAILURE,
+		                              conf_o);
+		goto again;
+	}
+
+	_LOG3W ("route-sync: failure to add IPv%c route: %s: %s",
+	       vt->is_ip4 ? '4' : '6',
+	       nmp_object_to_string (conf_o, NMP_OBJECT_TO_STRING_PUBLIC, sbuf1, sizeof (sbuf1)),
+	       nm_strerror (r));
+	return FALSE;
+}
+
 /**
  * nm_platform_ip_route_sync:
  * @self: the #NMPlatform instance.
@@ -4495,6 +5022,10 @@ nm_platform_ip_route_get_prune_list (NMPlatform *self,
  * @out_temporary_not_available: (allow-none) (out): routes that could
  *   currently not be synced. The caller shall keep them and try later again.
  *
+ * The routes are added and deleted in batches (see nm_platform_ip_route_add_batch()),
+ * so that the platform does not need to wait for each request to complete
+ * before sending the next one.
+ *
  * Returns: %TRUE on success.
  */
 gboolean
@@ -4507,13 +5038,17 @@ nm_platform_ip_route_sync (NMPlatform *self,
 {
 	const NMPlatformVTableRoute *vt;
 	gs_unref_hashtable GHashTable *routes_idx = NULL;
+	gs_unref_ptrarray GPtrArray *routes_add = NULL;
+	gs_unref_ptrarray GPtrArray *routes_del = NULL;
+	gs_free int *results_add = NULL;
+	gs_free gboolean *results_del = NULL;
 	const NMPObject *conf_o;
 	const NMDedupMultiEntry *plat_entry;
+	NMDedupMultiIdxType *sync_idx;
 	guint i;
 	int i_type;
 	gboolean success = TRUE;
 	char sbuf1[sizeof (_nm_utils_to_string_buffer)];
-	char sbuf2[sizeof (_nm_utils_to_string_buffer)];
 	const gboolean IS_IPv4 = (addr_family == AF_INET);
 
 	nm_assert (NM_IS_PLATFORM (self));
@@ -4522,11 +5057,21 @@ nm_platform_ip_route_sync (NMPlatform *self,
 
 	vt = &nm_platform_vtable_route.vx[IS_IPv4];
 
+	sync_idx = _ip_sync_state_start (self, ifindex, vt->obj_type, !!routes);
+
+	if (routes) {
+		routes_add = g_ptr_array_sized_new (routes->len);
+		routes_del = g_ptr_array_new_with_free_func ((GDestroyNotify) nmp_object_unref);
+		results_add = g_new (int, routes->len);
+		results_del = g_new (gboolean, routes->len);
+	}
+
 	for (i_type = 0; routes && i_type < 2; i_type++) {
-		for (i = 0; i < routes->len; i++) {
-			int r, r2;
-			gboolean gateway_route_added = FALSE;
 
+		g_ptr_array_set_size (routes_add, 0);
+		g_ptr_array_set_size (routes_del, 0);
+
+		for (i = 0; i < routes->len; i++) {
 			conf_o = routes->pdata[i];
 
 #define VTABLE_IS_DEVICE_ROUTE(vt, o) (vt->is_ip4 \
@@ -4551,6 +5096,12 @@ nm_platform_ip_route_sync (NMPlatform *self,
 				continue;
 			}
 
+			if (   NMP_OBJECT_CAST_IP_ROUTE (conf_o)->ifindex == ifindex
+			    && !_ip_sync_state_commit (self, sync_idx, conf_o)) {
+				/* unchanged since the last sync, and platform still has it. */
+				continue;
+			}
+
 			plat_entry = nm_platform_lookup_entry (self,
 			                                       NMP_CACHE_ID_TYPE_OBJECT_TYPE,
 			                                       conf_o);
@@ -4565,120 +5116,62 @@ nm_platform_ip_route_sync (NMPlatform *self,
 					continue;
 
 				/* we need to replace the existing route with a (slightly) different
-				 * one. Delete it first. */
-				if (!nm_platform_object_delete (self, plat_o)) {
-					/* ignore error. */
-				}
+				 * one. Delete it first. The cache entry may go away while we
+				 * process the batch, so keep a reference. */
+				g_ptr_array_add (routes_del, (gpointer) nmp_object_ref (plat_o));
 			}
 
-sync_route_add:
-			r = nm_platform_ip_route_add (self,
-			                                NMP_NLM_FLAG_APPEND
-			                              | NMP_NLM_FLAG_SUPPRESS_NETLINK_FAILURE,
-			                              conf_o);
-			if (r < 0) {
-				if (r == -EEXIST) {
-					/* Don't fail for EEXIST. It's not clear that the existing route
-					 * is identical to the one that we were about to add. However,
-					 * above we should have deleted conflicting (non-identical) routes. */
-					if (_LOGD_ENABLED ()) {
-						plat_entry = nm_platform_lookup_entry (self,
-						                                       NMP_CACHE_ID_TYPE_OBJECT_TYPE,
-						                                       conf_o);
-						if (!plat_entry) {
-							_LOG3D ("route-sync: adding route %s failed with EEXIST, however we cannot find such a route",
-							        nmp_object_to_string (conf_o, NMP_OBJECT_TO_STRING_PUBLIC, sbuf1, sizeof (sbuf1)));
-						} else if (vt->route_cmp (NMP_OBJECT_CAST_IPX_ROUTE (conf_o),
-						                          NMP_OBJECT_CAST_IPX_ROUTE (plat_entry->obj),
-						                          NM_PLATFORM_IP_ROUTE_CMP_TYPE_SEMANTICALLY) != 0) {
-							_LOG3D ("route-sync: adding route %s failed due to existing (different!) route %s",
-							        nmp_object_to_string (conf_o, NMP_OBJECT_TO_STRING_PUBLIC, sbuf1, sizeof (sbuf1)),
-							        nmp_object_to_string (plat_entry->obj, NMP_OBJECT_TO_STRING_PUBLIC, sbuf2, sizeof (sbuf2)));
-						}
-					}
-				} else if (NMP_OBJECT_CAST_IP_ROUTE (conf_o)->rt_source < NM_IP_CONFIG_SOURCE_USER) {
-					_LOG3D ("route-sync: ignore failure to add IPv%c route: %s: %s",
-					       vt->is_ip4 ? '4' : '6',
-					       nmp_object_to_string (conf_o, NMP_OBJECT_TO_STRING_PUBLIC, sbuf1, sizeof (sbuf1)),
-					       nm_strerror (r));
-				} else if (   r == -EINVAL
-				           && out_temporary_not_available
-				           && _err_inval_due_to_ipv6_tentative_pref_src (self, conf_o)) {
-					_LOG3D ("route-sync: ignore failure to add IPv6 route with tentative IPv6 pref-src: %s: %s",
-					        nmp_object_to_string (conf_o, NMP_OBJECT_TO_STRING_PUBLIC, sbuf1, sizeof (sbuf1)),
-					        nm_strerror (r));
-					if (!*out_temporary_not_available)
-						*out_temporary_not_available = g_ptr_array_new_full (0, (GDestroyNotify) nmp_object_unref);
-					g_ptr_array_add (*out_temporary_not_available, (gpointer) nmp_object_ref (conf_o));
-				} else if (   !gateway_route_added
-				           && (   (   r == -ENETUNREACH
-				                   && vt->is_ip4
-				                   && !!NMP_OBJECT_CAST_IP4_ROUTE (conf_o)->gateway)
-				               || (   r == -EHOSTUNREACH
-				                   && !vt->is_ip4
-				                   && !IN6_IS_ADDR_UNSPECIFIED (&NMP_OBJECT_CAST_IP6_ROUTE (conf_o)->gateway)))) {
-					NMPObject oo;
-
-					if (vt->is_ip4) {
-						const NMPlatformIP4Route *rt = NMP_OBJECT_CAST_IP4_ROUTE (conf_o);
-
-						nmp_object_stackinit (&oo,
-						                      NMP_OBJECT_TYPE_IP4_ROUTE,
-						                      &((NMPlatformIP4Route) {
-						                          .ifindex = rt->ifindex,
-						                          .network = rt->gateway,
-						                          .plen = 32,
-						                          .metric = rt->metric,
-						                          .rt_source = rt->rt_source,
-						                          .table_coerced = rt->table_coerced,
-						                      }));
-					} else {
-						const NMPlatformIP6Route *rt = NMP_OBJECT_CAST_IP6_ROUTE (conf_o);
-
-						nmp_object_stackinit (&oo,
-						                      NMP_OBJECT_TYPE_IP6_ROUTE,
-						                      &((NMPlatformIP6Route) {
-						                          .ifindex = rt->ifindex,
-						                          .network = rt->gateway,
-						                          .plen = 128,
-						                          .metric = rt->metric,
-						                          .rt_source = rt->rt_source,
-						                          .table_coerced = rt->table_coerced,
-						                      }));
-					}
-
-					_LOG3D ("route-sync: failure to add IPv%c route: %s: %s; try adding direct route to gateway %s",
-					        vt->is_ip4 ? '4' : '6',
-					        nmp_object_to_string (conf_o, NMP_OBJECT_TO_STRING_PUBLIC, sbuf1, sizeof (sbuf1)),
-					        nm_strerror (r),
-					        nmp_object_to_string (&oo, NMP_OBJECT_TO_STRING_PUBLIC, sbuf2, sizeof (sbuf2)));
-
-					r2 = nm_platform_ip_route_add (self,
-					                                 NMP_NLM_FLAG_APPEND
-					                               | NMP_NLM_FLAG_SUPPRESS_NETLINK_FAILURE,
-					                               &oo);
-
-					if (r2 < 0) {
-						_LOG3D ("route-sync: failure to add gateway IPv%c route: %s: %s",
-						        vt->is_ip4 ? '4' : '6',
-						        nmp_object_to_string (conf_o, NMP_OBJECT_TO_STRING_PUBLIC, sbuf1, sizeof (sbuf1)),
-						        nm_strerror (r2));
-					}
-
-					gateway_route_added = TRUE;
-					goto sync_route_add;
-				} else {
-					_LOG3W ("route-sync: failure to add IPv%c route: %s: %s",
-					       vt->is_ip4 ? '4' : '6',
-					       nmp_object_to_string (conf_o, NMP_OBJECT_TO_STRING_PUBLIC, sbuf1, sizeof (sbuf1)),
-					       nm_strerror (r));
-					success = FALSE;
-				}
-			}
+			g_ptr_array_add (routes_add, (gpointer) conf_o);
+		}
+
+		/* ignore errors for deleting the conflicting routes. */
+		nm_platform_object_delete_batch (self,
+		                                 (const NMPObject *const *) routes_del->pdata,
+		                                 routes_del->len,
+		                                 results_del);
+
+		nm_platform_ip_route_add_batch (self,
+		                                  NMP_NLM_FLAG_APPEND
+		                                | NMP_NLM_FLAG_SUPPRESS_NETLINK_FAILURE,
+		                                (const NMPObject *const *) routes_add->pdata,
+		                                routes_add->len,
+		                                results_add);
+
+		for (i = 0; i < routes_add->len; i++) {
+			conf_o = routes_add->pdata[i];
+
+			if (!_ip_route_sync_handle_add_result (self,
+			                                       vt,
+			                                       conf_o,
+			                                       results_add[i],
+			                                       out_temporary_not_available))
+				success = FALSE;
+
+			if (NMP_OBJECT_CAST_IP_ROUTE (conf_o)->ifindex != ifindex)
+				continue;
+
+			/* only remember the route as committed, if platform really has it
+			 * now. Note that deleting the conflicting route above might already
+			 * have dropped the entry again. */
+			plat_entry = nm_platform_lookup_entry (self,
+			                                       NMP_CACHE_ID_TYPE_OBJECT_TYPE,
+			                                       conf_o);
+			if (   plat_entry
+			    && vt->route_cmp (NMP_OBJECT_CAST_IPX_ROUTE (conf_o),
+			                      NMP_OBJECT_CAST_IPX_ROUTE (plat_entry->obj),
+			                      NM_PLATFORM_IP_ROUTE_CMP_TYPE_SEMANTICALLY) == 0)
+				_ip_sync_state_commit (self, sync_idx, conf_o);
+			else
+				_ip_sync_state_forget (self, sync_idx, conf_o);
 		}
 	}
 
+	_ip_sync_state_finish (self, sync_idx);
+
 	if (routes_prune) {
+		gs_unref_ptrarray GPtrArray *routes_prune_del = NULL;
+		gs_free gboolean *results_prune_del = NULL;
+
 		for (i = 0; i < routes_prune->len; i++) {
 			const NMPObject *prune_o;
 
@@ -4696,9 +5189,18 @@ sync_route_add:
 			                               prune_o))
 				continue;
 
-			if (!nm_platform_object_delete (self, prune_o)) {
-				/* ignore error... */
-			}
+			if (!routes_prune_del)
+				routes_prune_del = g_ptr_array_new_with_free_func ((GDestroyNotify) nmp_object_unref);
+			g_ptr_array_add (routes_prune_del, (gpointer) nmp_object_ref (prune_o));
+		}
+
+		if (routes_prune_del) {
+			results_prune_del = g_new (gboolean, routes_prune_del->len);
+			/* ignore errors... */
+			nm_platform_object_delete_batch (self,
+			                                 (const NMPObject *const *) routes_prune_del->pdata,
+			                                 routes_prune_del->len,
+			                                 results_prune_del);
 		}
 	}
 
@@ -4835,6 +5337,7 @@ _ip_route_add (NMPlatform *self,
 	          ? nm_platform_ip4_route_to_string (route, sbuf, sizeof (sbuf))
 	          : nm_platform_ip6_route_to_string (route, sbuf, sizeof (sbuf)));
 
+	NM_PLATFORM_GET_PRIVATE (self)->ip_change_requests++;
 	return klass->ip_route_add (self, flags, addr_family, route);
 }
 
@@ -4875,6 +5378,59 @@ nm_platform_ip6_route_add (NMPlatform *self,
 	return _ip_route_add (self, flags, AF_INET6, route);
 }
 
+/**
+ * nm_platform_ip_route_add_batch:
+ * @self: the #NMPlatform instance.
+ * @flags: the flags for adding the routes.
+ * @routes: the routes to add. Must be IPv4 or IPv6 route
+ *   #NMPObject instances.
+ * @len: the number of routes in @routes.
+ * @out_results: (out): an array of length @len. For each route, it
+ *   contains the result as nm_platform_ip_route_add() would return it.
+ *
+ * Like calling nm_platform_ip_route_add() for each route, but the
+ * platform implementation may pipeline the requests, instead of
+ * waiting for each result before sending the next one.
+ */
+void
+nm_platform_ip_route_add_batch (NMPlatform *self,
+                                NMPNlmFlags flags,
+                                const NMPObject *const *routes,
+                                guint len,
+                                int *out_results)
+{
+	char sbuf[sizeof (_nm_utils_to_string_buffer)];
+	guint i;
+
+	_CHECK_SELF_VOID (self, klass);
+
+	nm_assert (routes || len == 0);
+	nm_assert (out_results || len == 0);
+
+	if (len == 0)
+		return;
+
+	if (!klass->ip_route_add_batch) {
+		for (i = 0; i < len; i++)
+			out_results[i] = nm_platform_ip_route_add (self, flags, routes[i]);
+		return;
+	}
+
+	if (_LOGD_ENABLED ()) {
+		for (i = 0; i < len; i++) {
+			int ifindex = NMP_OBJECT_CAST_IP_ROUTE (routes[i])->ifindex;
+
+			_LOG3D ("route: %-10s IPv%c route: %s (batch)",
+			        _nmp_nlm_flag_to_string (flags & NMP_NLM_FLAG_FMASK),
+			        nm_utils_addr_family_to_char (NMP_OBJECT_GET_CLASS (routes[i])->addr_family),
+			        nmp_object_to_string (routes[i], NMP_OBJECT_TO_STRING_PUBLIC, sbuf, sizeof (sbuf)));
+		}
+	}
+
+	NM_PLATFORM_GET_PRIVATE (self)->ip_change_requests += len;
+	klass->ip_route_add_batch (self, flags, routes, len, out_results);
+}
+
 gboolean
 nm_platform_object_delete (NMPlatform *self,
                            const NMPObject *obj)
@@ -4902,9 +5458,59 @@ nm_platform_object_delete (NMPlatform *self,
 		g_return_val_if_reached (FALSE);
 	}
 
+	NM_PLATFORM_GET_PRIVATE (self)->ip_change_requests++;
 	return klass->object_delete (self, obj);
 }
 
+/**
+ * nm_platform_object_delete_batch:
+ * @self: the #NMPlatform instance.
+ * @objs: the routes to delete.
+ * @len: the number of objects in @objs.
+ * @out_results: (out): an array of length @len. For each object,
+ *   it contains the result as nm_platform_object_delete() would
+ *   return it.
+ *
+ * Like calling nm_platform_object_delete() for each object, but the
+ * platform implementation may pipeline the requests. Currently only
+ * routes are supported.
+ */
+void
+nm_platform_object_delete_batch (NMPlatform *self,
+                                 const NMPObject *const *objs,
+                                 guint len,
+                                 gboolean *out_results)
+{
+	guint i;
+
+	_CHECK_SELF_VOID (self, klass);
+
+	nm_assert (objs || len == 0);
+	nm_assert (out_results || len == 0);
+
+	if (len == 0)
+		return;
+
+	if (!klass->object_delete_batch) {
+		for (i = 0; i < len; i++)
+			out_results[i] = nm_platform_object_delete (self, objs[i]);
+		return;
+	}
+
+	if (_LOGD_ENABLED ()) {
+		for (i = 0; i < len; i++) {
+			int ifindex = NMP_OBJECT_CAST_IP_ROUTE (objs[i])->ifindex;
+
+			_LOG3D ("%s: delete %s (batch)",
+			        NMP_OBJECT_GET_CLASS (objs[i])->obj_type_name,
+			        nmp_object_to_string (objs[i], NMP_OBJECT_TO_STRING_PUBLIC, NULL, 0));
+		}
+	}
+
+	NM_PLATFORM_GET_PRIVATE (self)->ip_change_requests += len;
+	klass->object_delete_batch (self, objs, len, out_results);
+}
+
 /*****************************************************************************/
 
 int
@@ -8040,6 +8646,8 @@ nm_platform_cache_update_emit_signal (NMPlatform *self,
 
 	NMTST_ASSERT_PLATFORM_NETNS_CURRENT (self);
 
+	_ip_sync_state_cache_update (self, cache_op, obj_old, obj_new);
+
 	switch (cache_op) {
 	case NMP_CACHE_OPS_ADDED:
 		if (!nmp_object_is_visible (obj_new))
@@ -8234,6 +8842,7 @@ finalize (GObject *object)
 	nm_clear_g_source (&priv->ip4_dev_route_blacklist_gc_timeout_id);
 	g_clear_pointer (&priv->ip4_dev_route_blacklist_hash, g_hash_table_unref);
 	g_clear_object (&self->_netns);
+	g_clear_pointer (&priv->ip_sync_states, g_hash_table_unref);
 	nm_dedup_multi_index_unref (priv->multi_idx);
 	nmp_cache_free (priv->cache);
 }
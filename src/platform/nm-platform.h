@@ -957,6 +957,13 @@ typedef struct {
 	                           NMPlatformAsyncCallback callback,
 	                           gpointer data,
 	                           GCancellable *cancellable);
+	void (*sysctl_set_batched) (NMPlatform *self,
+	                            const char *pathid,
+	                            int dirfd,
+	                            const char *path,
+	                            const char *value,
+	                            NMPlatformAsyncCallback callback,
+	                            gpointer data);
 	char * (*sysctl_get) (NMPlatform *self, const char *pathid, int dirfd, const char *path);
 
 	void (*refresh_all) (NMPlatform *self, NMPObjectType obj_type);
@@ -1108,6 +1115,10 @@ typedef struct {
 	gboolean    (*wpan_set_channel)      (NMPlatform *self, int ifindex, guint8 page, guint8 channel);
 
 	gboolean (*object_delete) (NMPlatform *self, const NMPObject *obj);
+	void (*object_delete_batch) (NMPlatform *self,
+	                             const NMPObject *const *objs,
+	                             guint len,
+	                             gboolean *out_results);
 
 	gboolean (*ip4_address_add) (NMPlatform *self,
 	                             int ifindex,
@@ -1133,6 +1144,11 @@ typedef struct {
 	                     NMPNlmFlags flags,
 	                     int addr_family,
 	                     const NMPlatformIPRoute *route);
+	void (*ip_route_add_batch) (NMPlatform *self,
+	                            NMPNlmFlags flags,
+	                            const NMPObject *const *routes,
+	                            guint len,
+	                            int *out_results);
 	int (*ip_route_get) (NMPlatform *self,
 	                     int addr_family,
 	                     gconstpointer address,
@@ -1270,6 +1286,7 @@ _nm_platform_uint8_inv (guint8 scope)
 
 gboolean nm_platform_get_use_udev (NMPlatform *self);
 gboolean nm_platform_get_log_with_ptr (NMPlatform *self);
+guint64 nm_platform_get_ip_change_requests (NMPlatform *self);
 
 NMPNetns *nm_platform_netns_get (NMPlatform *self);
 gboolean nm_platform_netns_push (NMPlatform *self, NMPNetns **netns);
@@ -1306,6 +1323,13 @@ void nm_platform_sysctl_set_async (NMPlatform *self,
                                    NMPlatformAsyncCallback callback,
                                    gpointer data,
                                    GCancellable *cancellable);
+void nm_platform_sysctl_set_batched (NMPlatform *self,
+                                     const char *pathid,
+                                     int dirfd,
+                                     const char *path,
+                                     const char *value,
+                                     NMPlatformAsyncCallback callback,
+                                     gpointer data);
 char *nm_platform_sysctl_get (NMPlatform *self, const char *pathid, int dirfd, const char *path);
 gint32 nm_platform_sysctl_get_int32 (NMPlatform *self, const char *pathid, int dirfd, const char *path, gint32 fallback);
 gint64 nm_platform_sysctl_get_int_checked (NMPlatform *self, const char *pathid, int dirfd, const char *path, guint base, gint64 min, gint64 max, gint64 fallback);
@@ -1330,6 +1354,14 @@ gboolean nm_platform_sysctl_ip_conf_set (NMPlatform *self,
                                          const char *property,
                                          const char *value);
 
+void nm_platform_sysctl_ip_conf_set_batched (NMPlatform *self,
+                                             int addr_family,
+                                             const char *ifname,
+                                             const char *property,
+                                             const char *value,
+                                             NMPlatformAsyncCallback callback,
+                                             gpointer data);
+
 gboolean nm_platform_sysctl_ip_conf_set_int64 (NMPlatform *self,
                                                int addr_family,
                                                const char *ifname,
@@ -1606,6 +1638,10 @@ int nm_platform_link_wireguard_change (NMPlatform *self,
 const NMPlatformIP6Address *nm_platform_ip6_address_get (NMPlatform *self, int ifindex, struct in6_addr address);
 
 gboolean nm_platform_object_delete (NMPlatform *self, const NMPObject *route);
+void nm_platform_object_delete_batch (NMPlatform *self,
+                                      const NMPObject *const *objs,
+                                      guint len,
+                                      gboolean *out_results);
 
 gboolean nm_platform_ip4_address_add (NMPlatform *self,
                                       int ifindex,
@@ -1640,6 +1676,11 @@ int nm_platform_ip_route_add (NMPlatform *self,
                               const NMPObject *route);
 int nm_platform_ip4_route_add (NMPlatform *self, NMPNlmFlags flags, const NMPlatformIP4Route *route);
 int nm_platform_ip6_route_add (NMPlatform *self, NMPNlmFlags flags, const NMPlatformIP6Route *route);
+void nm_platform_ip_route_add_batch (NMPlatform *self,
+                                     NMPNlmFlags flags,
+                                     const NMPObject *const *routes,
+                                     guint len,
+                                     int *out_results);
 
 GPtrArray *nm_platform_ip_route_get_prune_list (NMPlatform *self,
                                                 int addr_family,
@@ -0,0 +1,415 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Copyright (C) 2019 Red Hat, Inc.
+ */
+
+/* Micro benchmark for NMPCache and NMDedupMultiIndex.
+ *
+ * This is not a unit test. It populates a cache with a large number of
+ * links and routes and measures the time per operation, the change of the
+ * heap and the resident set size. Compare the output between two builds to
+ * catch scaling regressions. */
+
+#include "nm-default.h"
+
+#include <malloc.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "platform/nmp-object.h"
+
+#include "nm-test-utils-core.h"
+
+NMTST_DEFINE ();
+
+static struct {
+	char *routes;
+	int links;
+} global_opt = {
+	.links = 10000,
+};
+
+/*****************************************************************************/
+
+typedef struct {
+	const char *name;
+	gint64 start_ns;
+	gint64 start_heap;
+} Bench;
+
+static gint64
+_heap_in_use (void)
+{
+#if defined (__GLIBC__)
+#if __GLIBC_PREREQ (2, 33)
+	return mallinfo2 ().uordblks;
+#else
+	return (guint) mallinfo ().uordblks;
+#endif
+#else
+	return 0;
+#endif
+}
+
+static gint64
+_rss_kb (void)
+{
+	gs_free char *contents = NULL;
+	gint64 pages;
+	const char *s;
+
+	if (!g_file_get_contents ("/proc/self/statm", &contents, NULL, NULL))
+		return -1;
+
+	/* the second field is the resident set size in pages. */
+	s = strchr (contents, ' ');
+	if (!s)
+		return -1;
+	pages = _nm_utils_ascii_str_to_int64 (s + 1, 10, 0, G_MAXINT64, -1);
+	if (pages < 0)
+		return -1;
+	return pages * (sysconf (_SC_PAGESIZE) / 1024);
+}
+
+static void
+_bench_start (Bench *b, const char *name)
+{
+	b->name = name;
+	b->start_heap = _heap_in_use ();
+	b->start_ns = nm_utils_clock_gettime_ns (CLOCK_MONOTONIC);
+}
+
+static void
+_bench_end (Bench *b, guint n, guint n_ops)
+{
+	gint64 ns;
+	gint64 heap;
+
+	ns = nm_utils_clock_gettime_ns (CLOCK_MONOTONIC) - b->start_ns;
+	heap = _heap_in_use () - b->start_heap;
+
+	g_print ("%-32s %8u %10u ops %10.1f ns/op %+12"G_GINT64_FORMAT" heap-bytes %10"G_GINT64_FORMAT" rss-kb\n",
+	         b->name,
+	         n,
+	         n_ops,
+	         n_ops > 0 ? ((double) ns) / n_ops : 0.0,
+	         heap,
+	         _rss_kb ());
+}
+
+/*****************************************************************************/
+
+static NMPObject *
+_link_new (int ifindex)
+{
+	NMPlatformLink pl = {
+		.ifindex = ifindex,
+		.type = NM_LINK_TYPE_DUMMY,
+		.n_ifi_flags = IFF_UP,
+		.mtu = 1500,
+	};
+	NMPObject *obj;
+
+	nm_sprintf_buf (pl.name, "bench%d", ifindex);
+	obj = nmp_object_new (NMP_OBJECT_TYPE_LINK, (const NMPlatformObject *) &pl);
+	obj->_link.netlink.is_in_netlink = TRUE;
+	return obj;
+}
+
+static NMPObject *
+_ip4_route_new (guint i, guint32 mss)
+{
+	/* spread the routes over 100 interfaces, so that the by-ifindex
+	 * indexes have more than one head. */
+	return nmp_object_new (NMP_OBJECT_TYPE_IP4_ROUTE,
+	                       (const NMPlatformObject *) &((NMPlatformIP4Route) {
+	                           .ifindex = 1 + (i % 100),
+	                           .network = htonl (0x0A000000u /* 10.0.0.0 */ + i),
+	                           .plen = 32,
+	                           .metric = 100,
+	                           .mss = mss,
+	                           .rt_source = NM_IP_CONFIG_SOURCE_RTPROT_STATIC,
+	                       }));
+}
+
+static guint
+_lookup_all_count (NMPCache *cache, NMPObjectType obj_type)
+{
+	NMPLookup lookup;
+	NMDedupMultiIter iter;
+	const NMPObject *obj;
+	guint n = 0;
+
+	nmp_cache_iter_for_each (&iter,
+	                         nmp_cache_lookup (cache,
+	                                           nmp_lookup_init_obj_type (&lookup, obj_type)),
+	                         &obj)
+		n++;
+	return n;
+}
+
+/*****************************************************************************/
+
+static void
+bench_links (guint n)
+{
+	nm_auto_unref_dedup_multi_index NMDedupMultiIndex *multi_idx = NULL;
+	gs_unref_ptrarray GPtrArray *objs = NULL;
+	NMPCache *cache;
+	Bench b;
+	guint i;
+
+	multi_idx = nm_dedup_multi_index_new ();
+	cache = nmp_cache_new (multi_idx, FALSE);
+
+	objs = g_ptr_array_new_full (n, (GDestroyNotify) nmp_object_unref);
+	for (i = 0; i < n; i++)
+		g_ptr_array_add (objs, _link_new (i + 1));
+
+	_bench_start (&b, "link: update-netlink (add)");
+	for (i = 0; i < n; i++) {
+		nm_auto_nmpobj const NMPObject *obj_old = NULL;
+		nm_auto_nmpobj const NMPObject *obj_new = NULL;
+
+		nmp_cache_update_netlink (cache, objs->pdata[i], TRUE, &obj_old, &obj_new);
+	}
+	_bench_end (&b, n, n);
+
+	_bench_start (&b, "link: update-netlink (same)");
+	for (i = 0; i < n; i++) {
+		nm_auto_nmpobj const NMPObject *obj_old = NULL;
+		nm_auto_nmpobj const NMPObject *obj_new = NULL;
+
+		nmp_cache_update_netlink (cache, objs->pdata[i], TRUE, &obj_old, &obj_new);
+	}
+	_bench_end (&b, n, n);
+
+	_bench_start (&b, "link: lookup-link");
+	for (i = 0; i < n; i++) {
+		if (!nmp_cache_lookup_link (cache, i + 1))
+			g_assert_not_reached ();
+	}
+	_bench_end (&b, n, n);
+
+	_bench_start (&b, "link: lookup-all (iterate)");
+	if (_lookup_all_count (cache, NMP_OBJECT_TYPE_LINK) != n)
+		g_assert_not_reached ();
+	_bench_end (&b, n, n);
+
+	_bench_start (&b, "link: remove");
+	for (i = 0; i < n; i++) {
+		nm_auto_nmpobj const NMPObject *obj_old = NULL;
+
+		nmp_cache_remove (cache, objs->pdata[i], FALSE, FALSE, &obj_old);
+	}
+	_bench_end (&b, n, n);
+
+	nmp_cache_free (cache);
+}
+
+static void
+bench_routes (guint n)
+{
+	nm_auto_unref_dedup_multi_index NMDedupMultiIndex *multi_idx = NULL;
+	gs_unref_ptrarray GPtrArray *objs = NULL;
+	NMPCache *cache;
+	Bench b;
+	guint i;
+
+	multi_idx = nm_dedup_multi_index_new ();
+	cache = nmp_cache_new (multi_idx, FALSE);
+
+	objs = g_ptr_array_new_full (n, (GDestroyNotify) nmp_object_unref);
+	for (i = 0; i < n; i++)
+		g_ptr_array_add (objs, _ip4_route_new (i, 0));
+
+	_bench_start (&b, "ip4-route: update-netlink (add)");
+	for (i = 0; i < n; i++) {
+		nm_auto_nmpobj const NMPObject *obj_old = NULL;
+		nm_auto_nmpobj const NMPObject *obj_new = NULL;
+		nm_auto_nmpobj const NMPObject *obj_replace = NULL;
+		gboolean resync_required;
+
+		nmp_cache_update_netlink_route (cache, objs->pdata[i], TRUE, 0,
+		                                &obj_old, &obj_new, &obj_replace, &resync_required);
+	}
+	_bench_end (&b, n, n);
+
+	_bench_start (&b, "ip4-route: update-netlink (same)");
+	for (i = 0; i < n; i++) {
+		nm_auto_nmpobj const NMPObject *obj_old = NULL;
+		nm_auto_nmpobj const NMPObject *obj_new = NULL;
+		nm_auto_nmpobj const NMPObject *obj_replace = NULL;
+		gboolean resync_required;
+
+		nmp_cache_update_netlink_route (cache, objs->pdata[i], TRUE, 0,
+		                                &obj_old, &obj_new, &obj_replace, &resync_required);
+	}
+	_bench_end (&b, n, n);
+
+	/* replace every route by a modified one. */
+	for (i = 0; i < n; i++) {
+		nmp_object_unref (objs->pdata[i]);
+		objs->pdata[i] = _ip4_route_new (i, 1400);
+	}
+
+	_bench_start (&b, "ip4-route: update-netlink (change)");
+	for (i = 0; i < n; i++) {
+		nm_auto_nmpobj const NMPObject *obj_old = NULL;
+		nm_auto_nmpobj const NMPObject *obj_new = NULL;
+		nm_auto_nmpobj const NMPObject *obj_replace = NULL;
+		gboolean resync_required;
+
+		nmp_cache_update_netlink_route (cache, objs->pdata[i], TRUE, 0,
+		                                &obj_old, &obj_new, &obj_replace, &resync_required);
+	}
+	_bench_end (&b, n, n);
+
+	_bench_start (&b, "ip4-route: lookup-obj");
+	for (i = 0; i < n; i++) {
+		if (!nmp_cache_lookup_obj (cache, objs->pdata[i]))
+			g_assert_not_reached ();
+	}
+	_bench_end (&b, n, n);
+
+	_bench_start (&b, "ip4-route: lookup-all (iterate)");
+	if (_lookup_all_count (cache, NMP_OBJECT_TYPE_IP4_ROUTE) != n)
+		g_assert_not_reached ();
+	_bench_end (&b, n, n);
+
+	_bench_start (&b, "ip4-route: lookup-all (by ifindex)");
+	for (i = 0; i < 100; i++) {
+		NMPLookup lookup;
+
+		nmp_cache_lookup (cache, nmp_lookup_init_object (&lookup, NMP_OBJECT_TYPE_IP4_ROUTE, i + 1));
+	}
+	_bench_end (&b, n, 100);
+
+	_bench_start (&b, "ip4-route: remove");
+	for (i = 0; i < n; i++) {
+		nm_auto_nmpobj const NMPObject *obj_old = NULL;
+
+		nmp_cache_remove (cache, objs->pdata[i], FALSE, FALSE, &obj_old);
+	}
+	_bench_end (&b, n, n);
+
+	nmp_cache_free (cache);
+}
+
+/*****************************************************************************/
+
+static void
+_idx_obj_id_hash_update (const NMDedupMultiIdxType *idx_type,
+                         const NMDedupMultiObj *obj,
+                         NMHashState *h)
+{
+	nmp_object_id_hash_update ((NMPObject *) obj, h);
+}
+
+static gboolean
+_idx_obj_id_equal (const NMDedupMultiIdxType *idx_type,
+                   const NMDedupMultiObj *obj_a,
+                   const NMDedupMultiObj *obj_b)
+{
+	return nmp_object_id_equal ((NMPObject *) obj_a, (NMPObject *) obj_b);
+}
+
+static void
+bench_dedup_multi (guint n)
+{
+	static const NMDedupMultiIdxTypeClass idx_type_class = {
+		.idx_obj_id_hash_update = _idx_obj_id_hash_update,
+		.idx_obj_id_equal = _idx_obj_id_equal,
+	};
+	nm_auto_unref_dedup_multi_index NMDedupMultiIndex *multi_idx = NULL;
+	gs_unref_ptrarray GPtrArray *objs = NULL;
+	NMDedupMultiIdxType idx_type;
+	Bench b;
+	guint i;
+
+	multi_idx = nm_dedup_multi_index_new ();
+	nm_dedup_multi_idx_type_init (&idx_type, &idx_type_class);
+
+	objs = g_ptr_array_new_full (n, (GDestroyNotify) nmp_object_unref);
+	for (i = 0; i < n; i++)
+		g_ptr_array_add (objs, _ip4_route_new (i, 0));
+
+	_bench_start (&b, "dedup-multi: add-full (append)");
+	for (i = 0; i < n; i++) {
+		nm_dedup_multi_index_add_full (multi_idx, &idx_type, objs->pdata[i],
+		                               NM_DEDUP_MULTI_IDX_MODE_APPEND,
+		                               NULL, NULL, NULL, NULL, NULL);
+	}
+	_bench_end (&b, n, n);
+
+	_bench_start (&b, "dedup-multi: add-full (same)");
+	for (i = 0; i < n; i++) {
+		nm_dedup_multi_index_add_full (multi_idx, &idx_type, objs->pdata[i],
+		                               NM_DEDUP_MULTI_IDX_MODE_APPEND,
+		                               NULL, NULL, NULL, NULL, NULL);
+	}
+	_bench_end (&b, n, n);
+
+	_bench_start (&b, "dedup-multi: remove-idx");
+	nm_dedup_multi_index_remove_idx (multi_idx, &idx_type);
+	_bench_end (&b, n, n);
+}
+
+/*****************************************************************************/
+
+static gboolean
+read_argv (int *argc, char ***argv)
+{
+	GOptionContext *context;
+	GOptionEntry options[] = {
+		{ "routes", 'r', 0, G_OPTION_ARG_STRING, &global_opt.routes, "Comma separated list of route counts (default: 1000,100000,1000000)", "N,..." },
+		{ "links", 'l', 0, G_OPTION_ARG_INT, &global_opt.links, "Number of links (default: 10000)", "N" },
+		{ 0 },
+	};
+	gs_free_error GError *error = NULL;
+
+	context = g_option_context_new (NULL);
+	g_option_context_set_summary (context, "Benchmark the platform cache.");
+	g_option_context_add_main_entries (context, options, NULL);
+
+	if (!g_option_context_parse (context, argc, argv, &error)) {
+		g_warning ("Error parsing command line arguments: %s", error->message);
+		g_option_context_free (context);
+		return FALSE;
+	}
+
+	g_option_context_free (context);
+	return TRUE;
+}
+
+int
+main (int argc, char **argv)
+{
+	gs_free const char **routes = NULL;
+	gsize i;
+
+	nmtst_init_with_logging (&argc, &argv, "WARN", "ALL");
+
+	if (!read_argv (&argc, &argv))
+		return 2;
+
+	routes = nm_utils_strsplit_set (global_opt.routes ?: "1000,100000,1000000", ",");
+
+	if (global_opt.links > 0)
+		bench_links (global_opt.links);
+
+	for (i = 0; routes && routes[i]; i++) {
+		gint64 n;
+
+		n = _nm_utils_ascii_str_to_int64 (routes[i], 10, 1, G_MAXUINT32, -1);
+		if (n < 0) {
+			g_printerr ("invalid number of routes \"%s\"\n", routes[i]);
+			return 2;
+		}
+		bench_routes (n);
+		bench_dedup_multi (n);
+	}
+
+	g_free (global_opt.routes);
+	return EXIT_SUCCESS;
+}
@@ -16,6 +16,7 @@ NMTST_DEFINE ();
 
 static struct {
 	gboolean persist;
+	char *record;
 } global_opt = {
 	.persist = TRUE,
 };
@@ -26,6 +27,7 @@ read_argv (int *argc, char ***argv)
 	GOptionContext *context;
 	GOptionEntry options[] = {
 		{ "no-persist", 'P', G_OPTION_FLAG_REVERSE, G_OPTION_ARG_NONE, &global_opt.persist, "Exit after processing netlink messages", NULL },
+		{ "record", 'r', 0, G_OPTION_ARG_FILENAME, &global_opt.record, "Record the netlink messages to a capture file (see replay)", "FILE" },
 		{ 0 },
 	};
 	gs_free_error GError *error = NULL;
@@ -63,6 +65,15 @@ main (int argc, char **argv)
 
 	nm_linux_platform_setup ();
 
+	if (global_opt.record) {
+		gs_free_error GError *error = NULL;
+
+		if (!nm_linux_platform_capture_start (NM_PLATFORM_GET, global_opt.record, &error)) {
+			g_printerr ("%s\n", error->message);
+			return EXIT_FAILURE;
+		}
+	}
+
 	if (global_opt.persist)
 		g_main_loop_run (loop);
 
@@ -0,0 +1,130 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Copyright (C) 2019 Red Hat, Inc.
+ */
+
+/* Replay a netlink capture, as recorded by "monitor --record", into a
+ * NMLinuxPlatform instance. Use it to profile the platform cache and
+ * signal emission with a realistic workload, for example with perf. */
+
+#include "nm-default.h"
+
+#include <sched.h>
+#include <stdlib.h>
+
+#include "platform/nm-linux-platform.h"
+#include "platform/nmp-object.h"
+
+#include "nm-test-utils-core.h"
+
+NMTST_DEFINE ();
+
+static struct {
+	gboolean realtime;
+	gboolean netns;
+} global_opt = {
+	.netns = TRUE,
+};
+
+static guint signal_counts[NMP_OBJECT_TYPE_MAX + 1];
+
+static void
+_signal_cb (NMPlatform *platform,
+            int obj_type_i,
+            int ifindex,
+            gconstpointer platform_object,
+            int change_type_i,
+            gpointer user_data)
+{
+	signal_counts[obj_type_i]++;
+}
+
+static gboolean
+read_argv (int *argc, char ***argv)
+{
+	GOptionContext *context;
+	GOptionEntry options[] = {
+		{ "realtime", 't', 0, G_OPTION_ARG_NONE, &global_opt.realtime, "Keep the timing of the capture", NULL },
+		{ "no-netns", 'N', G_OPTION_FLAG_REVERSE, G_OPTION_ARG_NONE, &global_opt.netns, "Don't create a new network namespace for the replay", NULL },
+		{ 0 },
+	};
+	gs_free_error GError *error = NULL;
+
+	context = g_option_context_new ("FILE");
+	g_option_context_set_summary (context, "Replay a netlink capture into NMPlatform.");
+	g_option_context_add_main_entries (context, options, NULL);
+
+	if (!g_option_context_parse (context, argc, argv, &error)) {
+		g_warning ("Error parsing command line arguments: %s", error->message);
+		g_option_context_free (context);
+		return FALSE;
+	}
+
+	g_option_context_free (context);
+	return TRUE;
+}
+
+int
+main (int argc, char **argv)
+{
+	gs_free_error GError *error = NULL;
+	static const char *const signals[] = {
+		NM_PLATFORM_SIGNAL_LINK_CHANGED,
+		NM_PLATFORM_SIGNAL_IP4_ADDRESS_CHANGED,
+		NM_PLATFORM_SIGNAL_IP6_ADDRESS_CHANGED,
+		NM_PLATFORM_SIGNAL_IP4_ROUTE_CHANGED,
+		NM_PLATFORM_SIGNAL_IP6_ROUTE_CHANGED,
+	};
+	gint64 start_ns;
+	guint n_records;
+	guint i;
+
+	nmtst_init_with_logging (&argc, &argv, "WARN", "ALL");
+
+	if (!read_argv (&argc, &argv))
+		return 2;
+
+	if (argc != 2) {
+		g_printerr ("Missing capture file argument\n");
+		return 2;
+	}
+
+	/* the platform still sends its own requests to kernel. Don't let
+	 * it touch the real interfaces. */
+	if (   global_opt.netns
+	    && unshare (CLONE_NEWNET) != 0) {
+		int errsv = errno;
+
+		g_printerr ("Cannot create network namespace (%s). Use --no-netns\n",
+		            nm_strerror_native (errsv));
+		return EXIT_FAILURE;
+	}
+
+	nm_linux_platform_setup ();
+
+	for (i = 0; i < G_N_ELEMENTS (signals); i++)
+		g_signal_connect (NM_PLATFORM_GET, signals[i], G_CALLBACK (_signal_cb), NULL);
+
+	start_ns = nm_utils_get_monotonic_timestamp_ns ();
+	if (!nm_linux_platform_replay (NM_PLATFORM_GET,
+	                               argv[1],
+	                               global_opt.realtime,
+	                               &n_records,
+	                               &error)) {
+		g_printerr ("%s\n", error->message);
+		return EXIT_FAILURE;
+	}
+
+	g_print ("replayed %u records in %.3f msec\n",
+	         n_records,
+	         (nm_utils_get_monotonic_timestamp_ns () - start_ns) / 1000000.0);
+	for (i = 1; i <= NMP_OBJECT_TYPE_MAX; i++) {
+		const NMPClass *klass = nmp_class_from_type (i);
+
+		if (!signal_counts[i])
+			continue;
+		g_print ("  %-16s %8u signals\n", klass->obj_type_name, signal_counts[i]);
+	}
+
+	return EXIT_SUCCESS;
+}
@@ -336,6 +336,61 @@ test_ip4_address_peer_zero (void)
 	}
 }
 
+static void
+test_ip6_address_sync_incremental (void)
+{
+	const int ifindex = DEVICE_IFINDEX;
+	gs_unref_ptrarray GPtrArray *known_addresses = NULL;
+	const NMPlatformIP6Address *a;
+	struct in6_addr addr;
+	guint64 n_requests;
+
+	inet_pton (AF_INET6, IP6_ADDRESS, &addr);
+
+	known_addresses = g_ptr_array_new_with_free_func ((GDestroyNotify) nmp_object_unref);
+	g_ptr_array_add (known_addresses,
+	                 nmp_object_new (NMP_OBJECT_TYPE_IP6_ADDRESS,
+	                                 (const NMPlatformObject *) &((NMPlatformIP6Address) {
+	                                     .ifindex = ifindex,
+	                                     .address = addr,
+	                                     .plen = IP6_PLEN,
+	                                     .lifetime = NM_PLATFORM_LIFETIME_PERMANENT,
+	                                     .preferred = NM_PLATFORM_LIFETIME_PERMANENT,
+	                                     .n_ifa_flags = IFA_F_NODAD,
+	                                 })));
+
+	n_requests = nm_platform_get_ip_change_requests (NM_PLATFORM_GET);
+	g_assert (nm_platform_ip6_address_sync (NM_PLATFORM_GET, ifindex, known_addresses, FALSE));
+	g_assert_cmpint (nm_platform_get_ip_change_requests (NM_PLATFORM_GET) - n_requests, ==, 1);
+	g_assert (nm_platform_ip6_address_get (NM_PLATFORM_GET, ifindex, addr));
+
+	/* nothing changed. No requests are sent. */
+	n_requests = nm_platform_get_ip_change_requests (NM_PLATFORM_GET);
+	g_assert (nm_platform_ip6_address_sync (NM_PLATFORM_GET, ifindex, known_addresses, FALSE));
+	g_assert_cmpint (nm_platform_get_ip_change_requests (NM_PLATFORM_GET) - n_requests, ==, 0);
+
+	/* somebody else changes the lifetime. The next sync restores it. */
+	nmtstp_ip6_address_add (NULL, EX, ifindex, addr, IP6_PLEN, in6addr_any, 2000, 1000, IFA_F_NODAD);
+	a = nm_platform_ip6_address_get (NM_PLATFORM_GET, ifindex, addr);
+	g_assert (a);
+	g_assert_cmpint (a->lifetime, !=, NM_PLATFORM_LIFETIME_PERMANENT);
+
+	n_requests = nm_platform_get_ip_change_requests (NM_PLATFORM_GET);
+	g_assert (nm_platform_ip6_address_sync (NM_PLATFORM_GET, ifindex, known_addresses, FALSE));
+	g_assert_cmpint (nm_platform_get_ip_change_requests (NM_PLATFORM_GET) - n_requests, ==, 1);
+	a = nm_platform_ip6_address_get (NM_PLATFORM_GET, ifindex, addr);
+	g_assert (a);
+	g_assert_cmpint (a->lifetime, ==, NM_PLATFORM_LIFETIME_PERMANENT);
+
+	/* our own change did not drop the committed state. */
+	n_requests = nm_platform_get_ip_change_requests (NM_PLATFORM_GET);
+	g_assert (nm_platform_ip6_address_sync (NM_PLATFORM_GET, ifindex, known_addresses, FALSE));
+	g_assert_cmpint (nm_platform_get_ip_change_requests (NM_PLATFORM_GET) - n_requests, ==, 0);
+
+	g_assert (nm_platform_ip6_address_sync (NM_PLATFORM_GET, ifindex, NULL, TRUE));
+	g_assert (!nm_platform_ip6_address_get (NM_PLATFORM_GET, ifindex, addr));
+}
+
 /*****************************************************************************/
 
 NMTstpSetupFunc const _nmtstp_setup_platform_func = SETUP;
@@ -362,4 +417,6 @@ _nmtstp_setup_tests (void)
 
 	add_test_func ("/address/ipv4/peer", test_ip4_address_peer);
 	add_test_func ("/address/ipv4/peer/zero", test_ip4_address_peer_zero);
+
+	add_test_func ("/address/ipv6/sync-incremental", test_ip6_address_sync_incremental);
 }
@@ -2087,9 +2087,14 @@ test_create_many_links_do (guint n_devices)
 	const NMPlatformLink *pllink;
 	gs_unref_array GArray *ifindexes = g_array_sized_new (FALSE, FALSE, sizeof (int), n_devices);
 	const int EX = ((int) (nmtst_get_rand_uint32 () % 4)) - 1;
+	NMLinuxPlatformNetlinkStats stats_before = { 0 };
+	NMLinuxPlatformNetlinkStats stats;
 
 	g_assert (EX >= -1 && EX <= 2);
 
+	if (NM_IS_LINUX_PLATFORM (NM_PLATFORM_GET))
+		nm_linux_platform_get_netlink_stats (NM_PLATFORM_GET, &stats_before);
+
 	_LOGI (">>> create devices (EX=%d)...", EX);
 
 	for (i = 0; i < n_devices; i++) {
@@ -2135,6 +2140,17 @@ test_create_many_links_do (guint n_devices)
 	_LOGI (">>> process events after deleting devices...");
 	nm_platform_process_events (NM_PLATFORM_GET);
 
+	if (NM_IS_LINUX_PLATFORM (NM_PLATFORM_GET)) {
+		nm_linux_platform_get_netlink_stats (NM_PLATFORM_GET, &stats);
+		_LOGI (">>> netlink: %"G_GUINT64_FORMAT" messages in %"G_GUINT64_FORMAT" datagrams with %"G_GUINT64_FORMAT" receive calls",
+		       stats.n_messages - stats_before.n_messages,
+		       stats.n_datagrams - stats_before.n_datagrams,
+		       stats.n_recv_calls - stats_before.n_recv_calls);
+		/* at least one RTM_NEWLINK and RTM_DELLINK per device. */
+		g_assert_cmpint (stats.n_messages - stats_before.n_messages, >=, 2 * n_devices);
+		g_assert_cmpint (stats.n_datagrams - stats_before.n_datagrams, >=, stats.n_recv_calls - stats_before.n_recv_calls);
+	}
+
 	time = nm_utils_get_monotonic_timestamp_ns () - start_time;
 	_LOGI (">>> finished in %ld.%09ld seconds", (long) (time / NM_UTILS_NS_PER_SECOND), (long) (time % NM_UTILS_NS_PER_SECOND));
 }
@@ -3073,6 +3089,119 @@ test_sysctl_set_async (void)
 	nmtstp_link_delete (NULL, -1, ifindex, IFNAME, TRUE);
 }
 
+typedef struct {
+	GMainLoop *loop;
+	guint n_pending;
+	guint n_failed;
+} SysctlBatchedData;
+
+static void
+sysctl_set_batched_cb (GError *error, gpointer user_data)
+{
+	SysctlBatchedData *data = user_data;
+
+	g_assert (data->n_pending > 0);
+	if (error)
+		data->n_failed++;
+	if (--data->n_pending == 0)
+		g_main_loop_quit (data->loop);
+}
+
+static void
+test_sysctl_set_batched (void)
+{
+	NMPlatform *const PL = NM_PLATFORM_GET;
+	const char *const IFNAME = "nm-dummy-0";
+	const char *const PATH_RP_FILTER = "/proc/sys/net/ipv4/conf/nm-dummy-0/rp_filter";
+	const char *const PATH_LOG_MARTIANS = "/proc/sys/net/ipv4/conf/nm-dummy-0/log_martians";
+	const char *const PATH_INVALID = "/proc/sys/net/ipv4/conf/nm-dummy-0/does-not-exist";
+	gs_free GMainLoop *loop = NULL;
+	SysctlBatchedData data = { };
+	int ifindex;
+
+	ifindex = nmtstp_link_dummy_add (PL, -1, IFNAME)->ifindex;
+	loop = g_main_loop_new (NULL, FALSE);
+	data.loop = loop;
+
+	/* the writes are performed in order, so the last write to a path wins. */
+	data.n_pending = 4;
+	nm_platform_sysctl_set_batched (PL, NMP_SYSCTL_PATHID_ABSOLUTE (PATH_RP_FILTER), "2", sysctl_set_batched_cb, &data);
+	nm_platform_sysctl_set_batched (PL, NMP_SYSCTL_PATHID_ABSOLUTE (PATH_LOG_MARTIANS), "1", sysctl_set_batched_cb, &data);
+	nm_platform_sysctl_set_batched (PL, NMP_SYSCTL_PATHID_ABSOLUTE (PATH_INVALID), "1", sysctl_set_batched_cb, &data);
+	nm_platform_sysctl_set_batched (PL, NMP_SYSCTL_PATHID_ABSOLUTE (PATH_RP_FILTER), "1", sysctl_set_batched_cb, &data);
+
+	if (!nmtst_main_loop_run (loop, 2000))
+		g_assert_not_reached ();
+
+	g_assert_cmpint (data.n_failed, ==, 1);
+	g_assert_cmpint (nm_platform_sysctl_get_int32 (PL, NMP_SYSCTL_PATHID_ABSOLUTE (PATH_RP_FILTER), -1), ==, 1);
+	g_assert_cmpint (nm_platform_sysctl_get_int32 (PL, NMP_SYSCTL_PATHID_ABSOLUTE (PATH_LOG_MARTIANS), -1), ==, 1);
+
+	/* a synchronous write supersedes the queued one. */
+	data.n_pending = 1;
+	data.n_failed = 0;
+	nm_platform_sysctl_set_batched (PL, NMP_SYSCTL_PATHID_ABSOLUTE (PATH_RP_FILTER), "2", sysctl_set_batched_cb, &data);
+	g_assert (nm_platform_sysctl_set (PL, NMP_SYSCTL_PATHID_ABSOLUTE (PATH_RP_FILTER), "0"));
+
+	if (!nmtst_main_loop_run (loop, 2000))
+		g_assert_not_reached ();
+
+	g_assert_cmpint (data.n_failed, ==, 1);
+	g_assert_cmpint (nm_platform_sysctl_get_int32 (PL, NMP_SYSCTL_PATHID_ABSOLUTE (PATH_RP_FILTER), -1), ==, 0);
+
+	nmtstp_link_delete (NULL, -1, ifindex, IFNAME, TRUE);
+}
+
+static void
+_sysctl_write_behind_platform (const char *path, const char *value)
+{
+	FILE *f;
+
+	f = fopen (path, "we");
+	g_assert (f);
+	g_assert (fputs (value, f) >= 0);
+	g_assert (fclose (f) == 0);
+}
+
+static void
+test_sysctl_read_cache (void)
+{
+	NMPlatform *const PL = NM_PLATFORM_GET;
+	const char *const IFNAME = "nm-dummy-0";
+	const char *const PATH = "/proc/sys/net/ipv4/conf/nm-dummy-0/rp_filter";
+	int ifindex;
+
+	if (!NM_IS_LINUX_PLATFORM (PL)) {
+		g_test_skip ("the sysctl read cache is only implemented by the linux platform");
+		return;
+	}
+
+	ifindex = nmtstp_link_dummy_add (PL, -1, IFNAME)->ifindex;
+	nm_linux_platform_set_sysctl_read_cache (PL, TRUE);
+
+	g_assert (nm_platform_sysctl_set (PL, NMP_SYSCTL_PATHID_ABSOLUTE (PATH), "1"));
+	g_assert_cmpint (nm_platform_sysctl_get_int32 (PL, NMP_SYSCTL_PATHID_ABSOLUTE (PATH), -1), ==, 1);
+
+	/* changes by somebody else are not noticed... */
+	_sysctl_write_behind_platform (PATH, "2");
+	g_assert_cmpint (nm_platform_sysctl_get_int32 (PL, NMP_SYSCTL_PATHID_ABSOLUTE (PATH), -1), ==, 1);
+
+	/* ... until the link changes. */
+	nmtstp_link_set_updown (PL, -1, ifindex, TRUE);
+	g_assert_cmpint (nm_platform_sysctl_get_int32 (PL, NMP_SYSCTL_PATHID_ABSOLUTE (PATH), -1), ==, 2);
+
+	/* our own writes always invalidate the cached value. */
+	g_assert (nm_platform_sysctl_set (PL, NMP_SYSCTL_PATHID_ABSOLUTE (PATH), "0"));
+	g_assert_cmpint (nm_platform_sysctl_get_int32 (PL, NMP_SYSCTL_PATHID_ABSOLUTE (PATH), -1), ==, 0);
+
+	nm_linux_platform_set_sysctl_read_cache (PL, FALSE);
+
+	_sysctl_write_behind_platform (PATH, "1");
+	g_assert_cmpint (nm_platform_sysctl_get_int32 (PL, NMP_SYSCTL_PATHID_ABSOLUTE (PATH), -1), ==, 1);
+
+	nmtstp_link_delete (NULL, -1, ifindex, IFNAME, TRUE);
+}
+
 static void
 test_sysctl_set_async_fail (void)
 {
@@ -3325,6 +3454,8 @@ _nmtstp_setup_tests (void)
 		g_test_add_func ("/general/sysctl/netns-switch", test_sysctl_netns_switch);
 		g_test_add_func ("/general/sysctl/set-async", test_sysctl_set_async);
 		g_test_add_func ("/general/sysctl/set-async-fail", test_sysctl_set_async_fail);
+		g_test_add_func ("/general/sysctl/set-batched", test_sysctl_set_batched);
+		g_test_add_func ("/general/sysctl/read-cache", test_sysctl_read_cache);
 
 		g_test_add_func ("/link/ethtool/features/get", test_ethtool_features_get);
 	}
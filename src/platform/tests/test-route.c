@@ -306,6 +306,181 @@ test_ip4_route (void)
 	free_signal (route_removed);
 }
 
+static void
+test_ip4_route_sync_batch (void)
+{
+	const int ifindex = nm_platform_link_get_ifindex (NM_PLATFORM_GET, DEVICE_NAME);
+	const guint n_routes = nmtst_test_quick () ? 300 : 3000;
+	gs_unref_ptrarray GPtrArray *routes = NULL;
+	gs_unref_ptrarray GPtrArray *routes_cur = NULL;
+	in_addr_t gateway;
+	guint i;
+
+	inet_pton (AF_INET, "198.51.100.1", &gateway);
+
+	/* sync more routes than fit into one batch. Every second route is a gateway
+	 * route, that depends on the device route to the gateway (which is added
+	 * first by nm_platform_ip_route_sync()). */
+	routes = g_ptr_array_new_with_free_func ((GDestroyNotify) nmp_object_unref);
+	g_ptr_array_add (routes,
+	                 nmp_object_new (NMP_OBJECT_TYPE_IP4_ROUTE,
+	                                 (const NMPlatformObject *) &((NMPlatformIP4Route) {
+	                                     .ifindex = ifindex,
+	                                     .network = gateway,
+	                                     .plen = 32,
+	                                     .metric = 22987,
+	                                     .rt_source = NM_IP_CONFIG_SOURCE_USER,
+	                                 })));
+	for (i = 0; i < n_routes; i++) {
+		g_ptr_array_add (routes,
+		                 nmp_object_new (NMP_OBJECT_TYPE_IP4_ROUTE,
+		                                 (const NMPlatformObject *) &((NMPlatformIP4Route) {
+		                                     .ifindex = ifindex,
+		                                     .network = htonl (0xC6120000u /* 198.18.0.0 */ + i),
+		                                     .plen = 32,
+		                                     .gateway = (i % 2) ? gateway : INADDR_ANY,
+		                                     .metric = 22987,
+		                                     .rt_source = NM_IP_CONFIG_SOURCE_USER,
+		                                 })));
+	}
+
+	g_assert (nm_platform_ip_route_sync (NM_PLATFORM_GET, AF_INET, ifindex, routes, NULL, NULL));
+
+	routes_cur = nmtstp_ip4_route_get_all (NM_PLATFORM_GET, ifindex);
+	g_assert_cmpint (routes_cur->len, ==, routes->len);
+	for (i = 0; i < routes->len; i++)
+		g_assert (nm_platform_lookup_obj (NM_PLATFORM_GET, NMP_CACHE_ID_TYPE_OBJECT_TYPE, routes->pdata[i]));
+	g_clear_pointer (&routes_cur, g_ptr_array_unref);
+
+	/* syncing the same routes again is a no-op. */
+	g_assert (nm_platform_ip_route_sync (NM_PLATFORM_GET, AF_INET, ifindex, routes, NULL, NULL));
+	routes_cur = nmtstp_ip4_route_get_all (NM_PLATFORM_GET, ifindex);
+	g_assert_cmpint (routes_cur->len, ==, routes->len);
+	g_clear_pointer (&routes_cur, g_ptr_array_unref);
+
+	/* prune them all. */
+	g_assert (nm_platform_ip_route_sync (NM_PLATFORM_GET, AF_INET, ifindex, NULL, routes, NULL));
+	routes_cur = nmtstp_ip4_route_get_all (NM_PLATFORM_GET, ifindex);
+	g_assert_cmpint (routes_cur->len, ==, 0);
+}
+
+static NMPObject *
+_ip4_route_sync_incremental_new (int ifindex, guint i, guint32 mss)
+{
+	return nmp_object_new (NMP_OBJECT_TYPE_IP4_ROUTE,
+	                       (const NMPlatformObject *) &((NMPlatformIP4Route) {
+	                           .ifindex = ifindex,
+	                           .network = htonl (0xC6130000u /* 198.19.0.0 */ + i),
+	                           .plen = 32,
+	                           .metric = 22987,
+	                           .mss = mss,
+	                           .rt_source = NM_IP_CONFIG_SOURCE_USER,
+	                       }));
+}
+
+static void
+test_ip4_route_sync_incremental (void)
+{
+	const int ifindex = nm_platform_link_get_ifindex (NM_PLATFORM_GET, DEVICE_NAME);
+	const guint n_routes = 20;
+	gs_unref_ptrarray GPtrArray *routes = NULL;
+	gs_unref_ptrarray GPtrArray *routes_prune = NULL;
+	gs_unref_ptrarray GPtrArray *routes_cur = NULL;
+	guint64 n_requests;
+	guint i;
+
+	routes = g_ptr_array_new_with_free_func ((GDestroyNotify) nmp_object_unref);
+	for (i = 0; i < n_routes; i++)
+		g_ptr_array_add (routes, _ip4_route_sync_incremental_new (ifindex, i, 0));
+
+	n_requests = nm_platform_get_ip_change_requests (NM_PLATFORM_GET);
+	g_assert (nm_platform_ip_route_sync (NM_PLATFORM_GET, AF_INET, ifindex, routes, NULL, NULL));
+	g_assert_cmpint (nm_platform_get_ip_change_requests (NM_PLATFORM_GET) - n_requests, ==, n_routes);
+
+	/* nothing changed. No requests are sent. */
+	n_requests = nm_platform_get_ip_change_requests (NM_PLATFORM_GET);
+	g_assert (nm_platform_ip_route_sync (NM_PLATFORM_GET, AF_INET, ifindex, routes, NULL, NULL));
+	g_assert_cmpint (nm_platform_get_ip_change_requests (NM_PLATFORM_GET) - n_requests, ==, 0);
+
+	/* modify one route. It gets replaced (delete and add). */
+	nmp_object_unref (routes->pdata[3]);
+	routes->pdata[3] = _ip4_route_sync_incremental_new (ifindex, 3, 1400);
+	n_requests = nm_platform_get_ip_change_requests (NM_PLATFORM_GET);
+	g_assert (nm_platform_ip_route_sync (NM_PLATFORM_GET, AF_INET, ifindex, routes, NULL, NULL));
+	g_assert_cmpint (nm_platform_get_ip_change_requests (NM_PLATFORM_GET) - n_requests, ==, 2);
+	g_assert (nm_platform_lookup_obj (NM_PLATFORM_GET, NMP_CACHE_ID_TYPE_OBJECT_TYPE, routes->pdata[3]));
+	g_assert_cmpint (NMP_OBJECT_CAST_IP4_ROUTE (nm_platform_lookup_obj (NM_PLATFORM_GET, NMP_CACHE_ID_TYPE_OBJECT_TYPE, routes->pdata[3]))->mss, ==, 1400);
+
+	/* drop one route. Only that one gets deleted. */
+	routes_prune = nm_platform_ip_route_get_prune_list (NM_PLATFORM_GET,
+	                                                    AF_INET,
+	                                                    ifindex,
+	                                                    NM_IP_ROUTE_TABLE_SYNC_MODE_ALL);
+	g_ptr_array_remove_index (routes, 7);
+	n_requests = nm_platform_get_ip_change_requests (NM_PLATFORM_GET);
+	g_assert (nm_platform_ip_route_sync (NM_PLATFORM_GET, AF_INET, ifindex, routes, routes_prune, NULL));
+	g_assert_cmpint (nm_platform_get_ip_change_requests (NM_PLATFORM_GET) - n_requests, ==, 1);
+	routes_cur = nmtstp_ip4_route_get_all (NM_PLATFORM_GET, ifindex);
+	g_assert_cmpint (routes_cur->len, ==, routes->len);
+	g_clear_pointer (&routes_cur, g_ptr_array_unref);
+
+	/* a route that was deleted behind our back gets added again. */
+	g_assert (nm_platform_object_delete (NM_PLATFORM_GET, routes->pdata[0]));
+	n_requests = nm_platform_get_ip_change_requests (NM_PLATFORM_GET);
+	g_assert (nm_platform_ip_route_sync (NM_PLATFORM_GET, AF_INET, ifindex, routes, NULL, NULL));
+	g_assert_cmpint (nm_platform_get_ip_change_requests (NM_PLATFORM_GET) - n_requests, ==, 1);
+	g_assert (nm_platform_lookup_obj (NM_PLATFORM_GET, NMP_CACHE_ID_TYPE_OBJECT_TYPE, routes->pdata[0]));
+
+	g_assert (nm_platform_ip_route_sync (NM_PLATFORM_GET, AF_INET, ifindex, NULL, routes, NULL));
+	routes_cur = nmtstp_ip4_route_get_all (NM_PLATFORM_GET, ifindex);
+	g_assert_cmpint (routes_cur->len, ==, 0);
+}
+
+static void
+test_ip4_route_cache_filter (void)
+{
+	const int ifindex = nm_platform_link_get_ifindex (NM_PLATFORM_GET, DEVICE_NAME);
+	gs_unref_object NMPlatform *platform2 = NULL;
+	NMPlatformIP4Route rts[3];
+	guint i;
+
+	for (i = 0; i < G_N_ELEMENTS (rts); i++) {
+		rts[i] = (NMPlatformIP4Route) {
+			.ifindex = ifindex,
+			.network = htonl (0xC6140000u /* 198.20.0.0 */ + i),
+			.plen = 32,
+			.metric = 22987,
+			.rt_source = i == 2 ? NM_IP_CONFIG_SOURCE_RTPROT_KERNEL : NM_IP_CONFIG_SOURCE_USER,
+			.table_coerced = nm_platform_route_table_coerce (i == 1 ? 10001 : RT_TABLE_MAIN),
+		};
+		g_assert (NMTST_NM_ERR_SUCCESS (nm_platform_ip4_route_add (NM_PLATFORM_GET, NMP_NLM_FLAG_REPLACE, &rts[i])));
+	}
+
+	/* a second platform instance only caches routes in the main table with
+	 * protocol static. */
+	platform2 = g_object_new (NM_TYPE_LINUX_PLATFORM,
+	                          NM_PLATFORM_LOG_WITH_PTR, TRUE,
+	                          NM_LINUX_PLATFORM_CACHE_ROUTE_TABLES, "main",
+	                          NM_LINUX_PLATFORM_CACHE_ROUTE_PROTOCOLS, "static, 42",
+	                          NULL);
+
+	for (i = 0; i < G_N_ELEMENTS (rts); i++) {
+		NMPObject obj_stack;
+		const NMPObject *obj;
+
+		nmp_object_stackinit (&obj_stack, NMP_OBJECT_TYPE_IP4_ROUTE, &rts[i]);
+
+		if (i == 0)
+			g_assert (nm_platform_lookup_obj (platform2, NMP_CACHE_ID_TYPE_OBJECT_TYPE, &obj_stack));
+		else
+			g_assert (!nm_platform_lookup_obj (platform2, NMP_CACHE_ID_TYPE_OBJECT_TYPE, &obj_stack));
+
+		obj = nm_platform_lookup_obj (NM_PLATFORM_GET, NMP_CACHE_ID_TYPE_OBJECT_TYPE, &obj_stack);
+		g_assert (obj);
+		g_assert (nm_platform_object_delete (NM_PLATFORM_GET, obj));
+	}
+}
+
 static void
 test_ip6_route (void)
 {
@@ -1733,6 +1908,8 @@ _nmtstp_setup_tests (void)
 #define add_test_func(testpath, test_func) nmtstp_env1_add_test_func(testpath, test_func, TRUE)
 #define add_test_func_data(testpath, test_func, arg) nmtstp_env1_add_test_func_data(testpath, test_func, arg, TRUE)
 	add_test_func ("/route/ip4", test_ip4_route);
+	add_test_func ("/route/ip4_sync_batch", test_ip4_route_sync_batch);
+	add_test_func ("/route/ip4_sync_incremental", test_ip4_route_sync_incremental);
 	add_test_func ("/route/ip6", test_ip6_route);
 	add_test_func ("/route/ip4_metric0", test_ip4_route_metric0);
 	add_test_func_data ("/route/ip4_options/1", test_ip4_route_options, GINT_TO_POINTER (1));
@@ -1747,6 +1924,7 @@ _nmtstp_setup_tests (void)
 		add_test_func ("/route/ip4_route_get", test_ip4_route_get);
 		add_test_func ("/route/ip6_route_get", test_ip6_route_get);
 		add_test_func ("/route/ip4_zero_gateway", test_ip4_zero_gateway);
+		add_test_func ("/route/ip4_cache_filter", test_ip4_route_cache_filter);
 	}
 
 	if (nmtstp_is_root_test ()) {
@@ -1378,7 +1378,6 @@ impl_settings_connection_get_settings (NMDBusObject *obj,
 
 typedef struct {
 	GDBusMethodInvocation *context;
-	NMAgentManager *agent_mgr;
 	NMAuthSubject *subject;
 	NMConnection *new_settings;
 	NMSettingsUpdate2Flags flags;
@@ -1406,101 +1405,117 @@ update_complete (NMSettingsConnection *self,
 	                            info->subject, error ? error->message : NULL);
 
 	g_clear_object (&info->subject);
-	g_clear_object (&info->agent_mgr);
 	g_clear_object (&info->new_settings);
 	g_free (info->audit_args);
 	g_slice_free (UpdateInfo, info);
 }
 
-static void
-update_auth_cb (NMSettingsConnection *self,
-                GDBusMethodInvocation *context,
-                NMAuthSubject *subject,
-                GError *error,
-                gpointer data)
+/**
+ * nm_settings_connection_update_from_dbus:
+ * @self: the #NMSettingsConnection
+ * @new_settings: (allow-none): the new settings or %NULL to only
+ *   change the persist mode.
+ * @flags: the #NMSettingsUpdate2Flags of the request
+ * @subject: the authorized #NMAuthSubject of the requester
+ * @out_audit_args: (allow-none) (out) (transfer full): the diff
+ *   for the audit log, if auditing is enabled.
+ * @error: the failure reason
+ *
+ * Performs an update that was requested via D-Bus and that is
+ * already authorized.
+ *
+ * Returns: %TRUE on success.
+ */
+gboolean
+nm_settings_connection_update_from_dbus (NMSettingsConnection *self,
+                                         NMConnection *new_settings,
+                                         NMSettingsUpdate2Flags flags,
+                                         NMAuthSubject *subject,
+                                         char **out_audit_args,
+                                         GError **error)
 {
 	NMSettingsConnectionPrivate *priv;
-	UpdateInfo *info = data;
-	gs_free_error GError *local = NULL;
+	gs_unref_object NMConnection *for_agent = NULL;
 	NMSettingsConnectionPersistMode persist_mode;
+	gboolean success;
 
-	if (error) {
-		update_complete (self, info, error);
-		return;
-	}
+	g_return_val_if_fail (NM_IS_SETTINGS_CONNECTION (self), FALSE);
+	g_return_val_if_fail (!new_settings || NM_IS_CONNECTION (new_settings), FALSE);
+	g_return_val_if_fail (NM_IS_AUTH_SUBJECT (subject), FALSE);
 
 	priv = NM_SETTINGS_CONNECTION_GET_PRIVATE (self);
 
-	if (info->new_settings) {
-		if (!_nm_connection_aggregate (info->new_settings, NM_CONNECTION_AGGREGATE_ANY_SECRETS, NULL)) {
+	NM_SET_OUT (out_audit_args, NULL);
+
+	if (new_settings) {
+		if (!_nm_connection_aggregate (new_settings, NM_CONNECTION_AGGREGATE_ANY_SECRETS, NULL)) {
 			/* If the new connection has no secrets, we do not want to remove all
 			 * secrets, rather we keep all the existing ones. Do that by merging
 			 * them in to the new connection.
 			 */
 			if (priv->agent_secrets)
-				nm_connection_update_secrets (info->new_settings, NULL, priv->agent_secrets, NULL);
+				nm_connection_update_secrets (new_settings, NULL, priv->agent_secrets, NULL);
 			if (priv->system_secrets)
-				nm_connection_update_secrets (info->new_settings, NULL, priv->system_secrets, NULL);
+				nm_connection_update_secrets (new_settings, NULL, priv->system_secrets, NULL);
 		} else {
 			/* Cache the new secrets from the agent, as stuff like inotify-triggered
 			 * changes to connection's backing config files will blow them away if
 			 * they're in the main connection.
 			 */
-			update_agent_secrets_cache (self, info->new_settings);
+			update_agent_secrets_cache (self, new_settings);
 		}
 	}
 
-	if (info->new_settings) {
+	if (   new_settings
+	    && out_audit_args) {
 		if (nm_audit_manager_audit_enabled (nm_audit_manager_get ())) {
 			gs_unref_hashtable GHashTable *diff = NULL;
 			gboolean same;
 
-			same = nm_connection_diff (nm_settings_connection_get_connection (self), info->new_settings,
+			same = nm_connection_diff (nm_settings_connection_get_connection (self), new_settings,
 			                           NM_SETTING_COMPARE_FLAG_EXACT |
 			                           NM_SETTING_COMPARE_FLAG_DIFF_RESULT_NO_DEFAULT,
 			                           &diff);
 			if (!same && diff)
-				info->audit_args = nm_utils_format_con_diff_for_audit (diff);
+				*out_audit_args = nm_utils_format_con_diff_for_audit (diff);
 		}
 	}
 
-	nm_assert (   !NM_FLAGS_ANY (info->flags, _NM_SETTINGS_UPDATE2_FLAG_ALL_PERSIST_MODES)
-	           || nm_utils_is_power_of_two (info->flags & _NM_SETTINGS_UPDATE2_FLAG_ALL_PERSIST_MODES));
+	nm_assert (   !NM_FLAGS_ANY (flags, _NM_SETTINGS_UPDATE2_FLAG_ALL_PERSIST_MODES)
+	           || nm_utils_is_power_of_two (flags & _NM_SETTINGS_UPDATE2_FLAG_ALL_PERSIST_MODES));
 
-	if (NM_FLAGS_HAS (info->flags, NM_SETTINGS_UPDATE2_FLAG_TO_DISK))
+	if (NM_FLAGS_HAS (flags, NM_SETTINGS_UPDATE2_FLAG_TO_DISK))
 		persist_mode = NM_SETTINGS_CONNECTION_PERSIST_MODE_TO_DISK;
-	else if (NM_FLAGS_ANY (info->flags, NM_SETTINGS_UPDATE2_FLAG_IN_MEMORY))
+	else if (NM_FLAGS_ANY (flags, NM_SETTINGS_UPDATE2_FLAG_IN_MEMORY))
 		persist_mode = NM_SETTINGS_CONNECTION_PERSIST_MODE_IN_MEMORY;
-	else if (NM_FLAGS_ANY (info->flags, NM_SETTINGS_UPDATE2_FLAG_IN_MEMORY_DETACHED))
+	else if (NM_FLAGS_ANY (flags, NM_SETTINGS_UPDATE2_FLAG_IN_MEMORY_DETACHED))
 		persist_mode = NM_SETTINGS_CONNECTION_PERSIST_MODE_IN_MEMORY_DETACHED;
-	else if (NM_FLAGS_HAS (info->flags, NM_SETTINGS_UPDATE2_FLAG_IN_MEMORY_ONLY)) {
+	else if (NM_FLAGS_HAS (flags, NM_SETTINGS_UPDATE2_FLAG_IN_MEMORY_ONLY)) {
 		persist_mode = NM_SETTINGS_CONNECTION_PERSIST_MODE_IN_MEMORY_ONLY;
 	} else
 		persist_mode = NM_SETTINGS_CONNECTION_PERSIST_MODE_KEEP;
 
-	nm_settings_connection_update (self,
-	                               info->new_settings,
-	                               persist_mode,
-	                               (  NM_FLAGS_HAS (info->flags, NM_SETTINGS_UPDATE2_FLAG_VOLATILE)
-	                                ? NM_SETTINGS_CONNECTION_INT_FLAGS_VOLATILE
-	                                : NM_SETTINGS_CONNECTION_INT_FLAGS_NONE),
-	                                 NM_SETTINGS_CONNECTION_INT_FLAGS_NM_GENERATED
-	                               | NM_SETTINGS_CONNECTION_INT_FLAGS_VOLATILE,
-	                                 NM_SETTINGS_CONNECTION_UPDATE_REASON_FORCE_RENAME
-	                               | (  NM_FLAGS_HAS (info->flags, NM_SETTINGS_UPDATE2_FLAG_NO_REAPPLY)
-	                                  ? NM_SETTINGS_CONNECTION_UPDATE_REASON_NONE
-	                                  : NM_SETTINGS_CONNECTION_UPDATE_REASON_REAPPLY_PARTIAL)
-	                               | NM_SETTINGS_CONNECTION_UPDATE_REASON_RESET_SYSTEM_SECRETS
-	                               | NM_SETTINGS_CONNECTION_UPDATE_REASON_RESET_AGENT_SECRETS
-	                               | (  NM_FLAGS_HAS (info->flags, NM_SETTINGS_UPDATE2_FLAG_BLOCK_AUTOCONNECT)
-	                                  ? NM_SETTINGS_CONNECTION_UPDATE_REASON_BLOCK_AUTOCONNECT
-	                                  : NM_SETTINGS_CONNECTION_UPDATE_REASON_NONE),
-	                               "update-from-dbus",
-	                               &local);
-
-	if (!local) {
-		gs_unref_object NMConnection *for_agent = NULL;
-
+	success = nm_settings_connection_update (self,
+	                                         new_settings,
+	                                         persist_mode,
+	                                         (  NM_FLAGS_HAS (flags, NM_SETTINGS_UPDATE2_FLAG_VOLATILE)
+	                                          ? NM_SETTINGS_CONNECTION_INT_FLAGS_VOLATILE
+	                                          : NM_SETTINGS_CONNECTION_INT_FLAGS_NONE),
+	                                           NM_SETTINGS_CONNECTION_INT_FLAGS_NM_GENERATED
+	                                         | NM_SETTINGS_CONNECTION_INT_FLAGS_VOLATILE,
+	                                           NM_SETTINGS_CONNECTION_UPDATE_REASON_FORCE_RENAME
+	                                         | (  NM_FLAGS_HAS (flags, NM_SETTINGS_UPDATE2_FLAG_NO_REAPPLY)
+	                                            ? NM_SETTINGS_CONNECTION_UPDATE_REASON_NONE
+	                                            : NM_SETTINGS_CONNECTION_UPDATE_REASON_REAPPLY_PARTIAL)
+	                                         | NM_SETTINGS_CONNECTION_UPDATE_REASON_RESET_SYSTEM_SECRETS
+	                                         | NM_SETTINGS_CONNECTION_UPDATE_REASON_RESET_AGENT_SECRETS
+	                                         | (  NM_FLAGS_HAS (flags, NM_SETTINGS_UPDATE2_FLAG_BLOCK_AUTOCONNECT)
+	                                            ? NM_SETTINGS_CONNECTION_UPDATE_REASON_BLOCK_AUTOCONNECT
+	                                            : NM_SETTINGS_CONNECTION_UPDATE_REASON_NONE),
+	                                         "update-from-dbus",
+	                                         error);
+
+	if (success) {
 		/* Dupe the connection so we can clear out non-agent-owned secrets,
 		 * as agent-owned secrets are the only ones we send back be saved.
 		 * Only send secrets to agents of the same UID that called update too.
@@ -1508,20 +1523,44 @@ update_auth_cb (NMSettingsConnection *self,
 		for_agent = nm_simple_connection_new_clone (nm_settings_connection_get_connection (self));
 		_nm_connection_clear_secrets_by_secret_flags (for_agent,
 		                                              NM_SETTING_SECRET_FLAG_AGENT_OWNED);
-		nm_agent_manager_save_secrets (info->agent_mgr,
+		nm_agent_manager_save_secrets (priv->agent_mgr,
 		                               nm_dbus_object_get_path (NM_DBUS_OBJECT (self)),
 		                               for_agent,
-		                               info->subject);
+		                               subject);
 	}
 
 	/* Reset auto retries back to default since connection was updated */
 	nm_settings_connection_autoconnect_retries_reset (self);
 
+	return success;
+}
+
+static void
+update_auth_cb (NMSettingsConnection *self,
+                GDBusMethodInvocation *context,
+                NMAuthSubject *subject,
+                GError *error,
+                gpointer data)
+{
+	UpdateInfo *info = data;
+	gs_free_error GError *local = NULL;
+
+	if (error) {
+		update_complete (self, info, error);
+		return;
+	}
+
+	nm_settings_connection_update_from_dbus (self,
+	                                         info->new_settings,
+	                                         info->flags,
+	                                         info->subject,
+	                                         &info->audit_args,
+	                                         &local);
 	update_complete (self, info, local);
 }
 
-static const char *
-get_update_modify_permission (NMConnection *old, NMConnection *new)
+const char *
+nm_settings_connection_get_update_modify_permission (NMConnection *old, NMConnection *new)
 {
 	NMSettingConnection *s_con;
 	guint32 orig_num = 0, new_num = 0;
@@ -1551,7 +1590,6 @@ settings_connection_update (NMSettingsConnection *self,
                             GVariant *new_settings,
                             NMSettingsUpdate2Flags flags)
 {
-	NMSettingsConnectionPrivate *priv = NM_SETTINGS_CONNECTION_GET_PRIVATE (self);
 	NMAuthSubject *subject = NULL;
 	NMConnection *tmp = NULL;
 	GError *error = NULL;
@@ -1599,13 +1637,12 @@ settings_connection_update (NMSettingsConnection *self,
 	info = g_slice_new0 (UpdateInfo);
 	info->is_update2 = is_update2;
 	info->context = context;
-	info->agent_mgr = g_object_ref (priv->agent_mgr);
 	info->subject = subject;
 	info->flags = flags;
 	info->new_settings = tmp;
 
-	permission = get_update_modify_permission (nm_settings_connection_get_connection (self),
-	                                           tmp ?: nm_settings_connection_get_connection (self));
+	permission = nm_settings_connection_get_update_modify_permission (nm_settings_connection_get_connection (self),
+	                                                                  tmp ?: nm_settings_connection_get_connection (self));
 	auth_start (self, context, subject, permission, update_auth_cb, info);
 	return;
 
@@ -1665,6 +1702,44 @@ impl_settings_connection_save (NMDBusObject *obj,
 	settings_connection_update (self, FALSE, invocation, NULL, NM_SETTINGS_UPDATE2_FLAG_TO_DISK);
 }
 
+/**
+ * nm_settings_connection_check_update2_flags:
+ * @flags: the flags argument of an Update2() request
+ * @error: the failure reason
+ *
+ * Returns: %TRUE, if @flags is a valid combination of
+ *   #NMSettingsUpdate2Flags.
+ */
+gboolean
+nm_settings_connection_check_update2_flags (guint32 flags, GError **error)
+{
+	if (NM_FLAGS_ANY (flags, ~((guint32) (  _NM_SETTINGS_UPDATE2_FLAG_ALL_PERSIST_MODES
+	                                      | NM_SETTINGS_UPDATE2_FLAG_VOLATILE
+	                                      | NM_SETTINGS_UPDATE2_FLAG_BLOCK_AUTOCONNECT
+	                                      | NM_SETTINGS_UPDATE2_FLAG_NO_REAPPLY)))) {
+		g_set_error_literal (error,
+		                     NM_SETTINGS_ERROR,
+		                     NM_SETTINGS_ERROR_INVALID_ARGUMENTS,
+		                     "Unknown flags");
+		return FALSE;
+	}
+
+	if (   (   NM_FLAGS_ANY (flags, _NM_SETTINGS_UPDATE2_FLAG_ALL_PERSIST_MODES)
+	        && !nm_utils_is_power_of_two (flags & _NM_SETTINGS_UPDATE2_FLAG_ALL_PERSIST_MODES))
+	    || (   NM_FLAGS_HAS (flags, NM_SETTINGS_UPDATE2_FLAG_VOLATILE)
+	        && !NM_FLAGS_ANY (flags,   NM_SETTINGS_UPDATE2_FLAG_IN_MEMORY
+	                                 | NM_SETTINGS_UPDATE2_FLAG_IN_MEMORY_DETACHED
+	                                 | NM_SETTINGS_UPDATE2_FLAG_IN_MEMORY_ONLY))) {
+		g_set_error_literal (error,
+		                     NM_SETTINGS_ERROR,
+		                     NM_SETTINGS_ERROR_INVALID_ARGUMENTS,
+		                     "Conflicting flags");
+		return FALSE;
+	}
+
+	return TRUE;
+}
+
 static void
 impl_settings_connection_update2 (NMDBusObject *obj,
                                   const NMDBusInterfaceInfoExtended *interface_info,
@@ -1685,32 +1760,13 @@ impl_settings_connection_update2 (NMDBusObject *obj,
 
 	g_variant_get (parameters, "(@a{sa{sv}}u@a{sv})", &settings, &flags_u, &args);
 
-	if (NM_FLAGS_ANY (flags_u, ~((guint32) (  _NM_SETTINGS_UPDATE2_FLAG_ALL_PERSIST_MODES
-	                                        | NM_SETTINGS_UPDATE2_FLAG_VOLATILE
-	                                        | NM_SETTINGS_UPDATE2_FLAG_BLOCK_AUTOCONNECT
-	                                        | NM_SETTINGS_UPDATE2_FLAG_NO_REAPPLY)))) {
-		error = g_error_new_literal (NM_SETTINGS_ERROR,
-		                             NM_SETTINGS_ERROR_INVALID_ARGUMENTS,
-		                             "Unknown flags");
+	if (!nm_settings_connection_check_update2_flags (flags_u, &error)) {
 		g_dbus_method_invocation_take_error (invocation, error);
 		return;
 	}
 
 	flags = (NMSettingsUpdate2Flags) flags_u;
 
-	if (   (   NM_FLAGS_ANY (flags, _NM_SETTINGS_UPDATE2_FLAG_ALL_PERSIST_MODES)
-	        && !nm_utils_is_power_of_two (flags & _NM_SETTINGS_UPDATE2_FLAG_ALL_PERSIST_MODES))
-	    || (   NM_FLAGS_HAS (flags, NM_SETTINGS_UPDATE2_FLAG_VOLATILE)
-	        && !NM_FLAGS_ANY (flags,   NM_SETTINGS_UPDATE2_FLAG_IN_MEMORY
-	                                 | NM_SETTINGS_UPDATE2_FLAG_IN_MEMORY_DETACHED
-	                                 | NM_SETTINGS_UPDATE2_FLAG_IN_MEMORY_ONLY))) {
-		error = g_error_new_literal (NM_SETTINGS_ERROR,
-		                             NM_SETTINGS_ERROR_INVALID_ARGUMENTS,
-		                             "Conflicting flags");
-		g_dbus_method_invocation_take_error (invocation, error);
-		return;
-	}
-
 	nm_assert (g_variant_is_of_type (args, G_VARIANT_TYPE ("a{sv}")));
 
 	g_variant_iter_init (&iter, args);
@@ -2103,6 +2159,17 @@ nm_settings_connection_cmp_autoconnect_priority_p_with_data (gconstpointer pa, g
 
 /*****************************************************************************/
 
+/* incremented whenever the timestamp of any profile changes. Users that
+ * keep lists sorted by nm_settings_connection_cmp_autoconnect_priority()
+ * use it to notice that they need to re-sort. */
+static guint _timestamp_generation = 1;
+
+guint
+nm_settings_connection_get_timestamp_generation (void)
+{
+	return _timestamp_generation;
+}
+
 /**
  * nm_settings_connection_get_timestamp:
  * @self: the #NMSettingsConnection
@@ -2144,6 +2211,10 @@ nm_settings_connection_update_timestamp (NMSettingsConnection *self,
 
 	g_return_if_fail (NM_IS_SETTINGS_CONNECTION (self));
 
+	if (   !priv->timestamp_set
+	    || priv->timestamp != timestamp)
+		_timestamp_generation++;
+
 	priv->timestamp = timestamp;
 	priv->timestamp_set = TRUE;
 
@@ -2187,6 +2258,7 @@ _nm_settings_connection_register_kf_dbs (NMSettingsConnection *self,
 		if (timestamp != G_MAXUINT64) {
 			priv->timestamp = timestamp;
 			priv->timestamp_set = TRUE;
+			_timestamp_generation++;
 			_LOGT ("read timestamp %"G_GUINT64_FORMAT" from keyfile database \"%s\"",
 			       timestamp, nm_key_file_db_get_filename (priv->kf_db_timestamps));
 		} else
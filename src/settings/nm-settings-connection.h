@@ -239,6 +239,18 @@ gboolean nm_settings_connection_update (NMSettingsConnection *self,
                                         const char *log_context_name,
                                         GError **error);
 
+gboolean nm_settings_connection_update_from_dbus (NMSettingsConnection *self,
+                                                  NMConnection *new_settings,
+                                                  NMSettingsUpdate2Flags flags,
+                                                  NMAuthSubject *subject,
+                                                  char **out_audit_args,
+                                                  GError **error);
+
+gboolean nm_settings_connection_check_update2_flags (guint32 flags, GError **error);
+
+const char *nm_settings_connection_get_update_modify_permission (NMConnection *old,
+                                                                 NMConnection *new);
+
 void nm_settings_connection_delete (NMSettingsConnection *self,
                                     gboolean allow_add_to_no_auto_default);
 
@@ -316,6 +328,8 @@ void _nm_settings_connection_register_kf_dbs (NMSettingsConnection *self,
                                               struct _NMKeyFileDB *kf_db_timestamps,
                                               struct _NMKeyFileDB *kf_db_seen_bssids);
 
+guint nm_settings_connection_get_timestamp_generation (void);
+
 gboolean nm_settings_connection_get_timestamp (NMSettingsConnection *self,
                                                guint64 *out_timestamp);
 
@@ -12,10 +12,17 @@
 #include <sys/types.h>
 #include <unistd.h>
 
+#include "nm-glib-aux/nm-io-utils.h"
+#include "nm-core-internal.h"
 #include "nm-settings-plugin.h"
 
 /*****************************************************************************/
 
+#define _NMLOG_DOMAIN      LOGD_SETTINGS
+#define _NMLOG(level, ...) __NMLOG_DEFAULT (level, _NMLOG_DOMAIN, "settings-utils", __VA_ARGS__)
+
+/*****************************************************************************/
+
 const struct timespec *
 nm_sett_util_stat_mtime (const char *filename,
                          gboolean do_lstat,
@@ -159,3 +166,751 @@ nm_sett_util_storages_steal (NMSettUtilStorages *storages,
 
 	return storage;
 }
+
+/*****************************************************************************/
+
+/* The profile cache stores already parsed and normalized profiles, so that
+ * unchanged files don't need to be parsed again on the next start. The
+ * cache is a serialized GVariant of type PROFILE_CACHE_TYPE. It contains the
+ * cache-key and a list of entries. Each entry is valid as long as the file
+ * still has the same stat() information.
+ *
+ * Profiles contain secrets, so the cache file is only readable by root. */
+
+#define PROFILE_CACHE_FORMAT_VERSION "2"
+
+#define PROFILE_CACHE_ENTRY_TYPE_STR "(sttttttvv)"
+#define PROFILE_CACHE_TYPE           G_VARIANT_TYPE ("(sa"PROFILE_CACHE_ENTRY_TYPE_STR")")
+
+struct _NMSettUtilProfileCache {
+	char *cache_filename;
+	char *cache_key;
+
+	/* the entries that were loaded from disk, indexed by filename. */
+	GHashTable *loaded;
+
+	/* the entries that will be written by nm_sett_util_profile_cache_save(),
+	 * indexed by filename. */
+	GHashTable *entries;
+
+	bool dirty:1;
+};
+
+static const char *
+_profile_cache_entry_get_filename (GVariant *entry)
+{
+	const char *filename;
+
+	g_variant_get_child (entry, 0, "&s", &filename);
+	return filename;
+}
+
+static gboolean
+_profile_cache_entry_matches (GVariant *entry,
+                              const struct stat *st)
+{
+	guint64 dev, ino, size, mtime_sec, mtime_nsec, ctime_nsec;
+
+	g_variant_get_child (entry, 1, "t", &dev);
+	g_variant_get_child (entry, 2, "t", &ino);
+	g_variant_get_child (entry, 3, "t", &size);
+	g_variant_get_child (entry, 4, "t", &mtime_sec);
+	g_variant_get_child (entry, 5, "t", &mtime_nsec);
+	g_variant_get_child (entry, 6, "t", &ctime_nsec);
+
+	/* the change time is included in nanoseconds, so that files that are
+	 * modified while preserving the modification time are also detected. */
+	return    dev        == (guint64) st->st_dev
+	       && ino        == (guint64) st->st_ino
+	       && size       == (guint64) st->st_size
+	       && mtime_sec  == (guint64) st->st_mtim.tv_sec
+	       && mtime_nsec == (guint64) st->st_mtim.tv_nsec
+	       && ctime_nsec == (  ((guint64) st->st_ctim.tv_sec) * NM_UTILS_NS_PER_SECOND
+	                         + ((guint64) st->st_ctim.tv_nsec));
+}
+
+static NMConnection *
+_profile_cache_connection_from_dict (GVariant *connection_dict,
+                                     GError **error)
+{
+	return _nm_simple_connection_new_from_dbus (connection_dict,
+	                                            NM_SETTING_PARSE_FLAGS_STRICT
+	                                            | NM_SETTING_PARSE_FLAGS_NORMALIZE,
+	                                            error);
+}
+
+/**
+ * nm_sett_util_profile_cache_load:
+ * @cache_filename: the file of the cache.
+ * @cache_key: the content of the cache is only used if it was
+ *   written with the same key.
+ *
+ * Returns: a new profile cache. If the cache file does not exist
+ *   or cannot be used, the cache is empty.
+ */
+NMSettUtilProfileCache *
+nm_sett_util_profile_cache_load (const char *cache_filename,
+                                 const char *cache_key)
+{
+	NMSettUtilProfileCache *cache;
+	gs_free_error GError *error = NULL;
+	gs_unref_variant GVariant *variant = NULL;
+	gs_unref_variant GVariant *entries = NULL;
+	gs_unref_bytes GBytes *bytes = NULL;
+	const char *key;
+	char *contents = NULL;
+	gsize length;
+	struct stat st;
+	gsize i, n;
+
+	nm_assert (cache_filename && cache_filename[0] == '/');
+	nm_assert (cache_key);
+
+	cache = g_slice_new (NMSettUtilProfileCache);
+	*cache = (NMSettUtilProfileCache) {
+		.cache_filename = g_strdup (cache_filename),
+		.cache_key      = g_strdup_printf ("%s,%s", PROFILE_CACHE_FORMAT_VERSION, cache_key),
+		.loaded         = g_hash_table_new_full (nm_str_hash, g_str_equal, NULL, (GDestroyNotify) g_variant_unref),
+		.entries        = g_hash_table_new_full (nm_str_hash, g_str_equal, NULL, (GDestroyNotify) g_variant_unref),
+	};
+
+	if (stat (cache_filename, &st) != 0)
+		return cache;
+
+	if (   st.st_uid != geteuid ()
+	    || (st.st_mode & 0077)) {
+		_LOGW ("ignore cache \"%s\" with insecure permissions", cache_filename);
+		return cache;
+	}
+
+	if (!g_file_get_contents (cache_filename, &contents, &length, &error)) {
+		_LOGD ("failure to read cache \"%s\": %s", cache_filename, error->message);
+		return cache;
+	}
+
+	bytes = g_bytes_new_take (contents, length);
+	variant = g_variant_ref_sink (g_variant_new_from_bytes (PROFILE_CACHE_TYPE, bytes, FALSE));
+	if (!g_variant_is_normal_form (variant)) {
+		_LOGD ("ignore invalid cache \"%s\"", cache_filename);
+		return cache;
+	}
+
+	g_variant_get_child (variant, 0, "&s", &key);
+	if (!nm_streq (key, cache->cache_key)) {
+		_LOGD ("ignore outdated cache \"%s\"", cache_filename);
+		return cache;
+	}
+
+	entries = g_variant_get_child_value (variant, 1);
+	n = g_variant_n_children (entries);
+	for (i = 0; i < n; i++) {
+		GVariant *entry;
+
+		entry = g_variant_get_child_value (entries, i);
+		g_hash_table_replace (cache->loaded,
+		                      (char *) _profile_cache_entry_get_filename (entry),
+		                      entry);
+	}
+
+	_LOGD ("loaded %u entries from cache \"%s\"", g_hash_table_size (cache->loaded), cache_filename);
+	return cache;
+}
+
+/**
+ * nm_sett_util_profile_cache_lookup_entry:
+ * @cache: the profile cache
+ * @filename: the filename of the profile
+ * @st: the current stat() information of @filename.
+ *
+ * Returns: (transfer none): the cache entry for @filename, or %NULL,
+ *   if there is no entry or the file changed. The entry stays valid
+ *   as long as @cache exists. Restore the profile with
+ *   nm_sett_util_profile_cache_entry_restore().
+ */
+GVariant *
+nm_sett_util_profile_cache_lookup_entry (NMSettUtilProfileCache *cache,
+                                         const char *filename,
+                                         const struct stat *st)
+{
+	GVariant *entry;
+
+	nm_assert (cache);
+	nm_assert (filename);
+	nm_assert (st);
+
+	entry = g_hash_table_lookup (cache->loaded, filename);
+	if (   !entry
+	    || !_profile_cache_entry_matches (entry, st))
+		return NULL;
+	return entry;
+}
+
+/**
+ * nm_sett_util_profile_cache_entry_restore:
+ * @entry: an entry from nm_sett_util_profile_cache_lookup_entry().
+ * @out_plugin_data: (allow-none): the plugin data that was passed
+ *   to nm_sett_util_profile_cache_entry_new().
+ * @error: the failure reason.
+ *
+ * Creates the profile from a cache entry. This does not access the
+ * cache and may be called on any thread.
+ *
+ * Returns: (transfer full): the restored profile or %NULL, if the
+ *   entry is invalid.
+ */
+NMConnection *
+nm_sett_util_profile_cache_entry_restore (GVariant *entry,
+                                          GVariant **out_plugin_data,
+                                          GError **error)
+{
+	gs_unref_variant GVariant *connection_dict = NULL;
+	NMConnection *connection;
+
+	nm_assert (entry);
+
+	g_variant_get_child (entry, 8, "v", &connection_dict);
+	if (!g_variant_is_of_type (connection_dict, NM_VARIANT_TYPE_CONNECTION)) {
+		nm_utils_error_set_literal (error, NM_UTILS_ERROR_UNKNOWN, "invalid profile in cache entry");
+		return NULL;
+	}
+
+	connection = _profile_cache_connection_from_dict (connection_dict, error);
+	if (!connection)
+		return NULL;
+
+	if (out_plugin_data)
+		g_variant_get_child (entry, 7, "v", out_plugin_data);
+	return connection;
+}
+
+/**
+ * nm_sett_util_profile_cache_keep_entry:
+ * @cache: the profile cache
+ * @entry: an entry from nm_sett_util_profile_cache_lookup_entry().
+ *
+ * Keeps @entry in the cache on the next nm_sett_util_profile_cache_save().
+ */
+void
+nm_sett_util_profile_cache_keep_entry (NMSettUtilProfileCache *cache,
+                                       GVariant *entry)
+{
+	nm_assert (cache);
+	nm_assert (entry);
+
+	g_hash_table_replace (cache->entries,
+	                      (char *) _profile_cache_entry_get_filename (entry),
+	                      g_variant_ref (entry));
+}
+
+/**
+ * nm_sett_util_profile_cache_lookup:
+ * @cache: the profile cache
+ * @filename: the filename of the profile
+ * @st: the current stat() information of @filename.
+ * @out_plugin_data: (allow-none): the plugin data that was passed
+ *   to nm_sett_util_profile_cache_add().
+ *
+ * Returns: (transfer full): the cached profile for @filename, or %NULL,
+ *   if there is no cached profile or the file changed. A found entry
+ *   is kept in the cache on the next nm_sett_util_profile_cache_save().
+ */
+NMConnection *
+nm_sett_util_profile_cache_lookup (NMSettUtilProfileCache *cache,
+                                   const char *filename,
+                                   const struct stat *st,
+                                   GVariant **out_plugin_data)
+{
+	gs_free_error GError *error = NULL;
+	NMConnection *connection;
+	GVariant *entry;
+
+	entry = nm_sett_util_profile_cache_lookup_entry (cache, filename, st);
+	if (!entry)
+		return NULL;
+
+	connection = nm_sett_util_profile_cache_entry_restore (entry, out_plugin_data, &error);
+	if (!connection) {
+		_LOGT ("invalid cache entry for \"%s\": %s", filename, error->message);
+		return NULL;
+	}
+
+	nm_sett_util_profile_cache_keep_entry (cache, entry);
+	return connection;
+}
+
+/**
+ * nm_sett_util_profile_cache_entry_new:
+ * @filename: the filename of the profile
+ * @st: the stat() information of @filename, at the time when it was read.
+ * @connection: the profile that was read from @filename.
+ * @plugin_data: data of the settings plugin, that is returned together
+ *   with the profile by nm_sett_util_profile_cache_entry_restore(). If
+ *   floating, the reference is taken.
+ *
+ * Creates a cache entry for nm_sett_util_profile_cache_add_entry(). This
+ * does not access the cache and may be called on any thread.
+ *
+ * The cache is persisted, so secrets are not serialized. Profiles that
+ * cannot be restored exactly from their serialized form, including
+ * profiles that contain secrets, are not cached.
+ *
+ * Returns: (transfer full): the new entry or %NULL, if @connection
+ *   cannot be cached.
+ */
+GVariant *
+nm_sett_util_profile_cache_entry_new (const char *filename,
+                                      const struct stat *st,
+                                      NMConnection *connection,
+                                      GVariant *plugin_data)
+{
+	gs_unref_variant GVariant *plugin_data_free = NULL;
+	gs_unref_object NMConnection *connection_restored = NULL;
+	gs_unref_variant GVariant *connection_dict = NULL;
+
+	nm_assert (filename);
+	nm_assert (st);
+	nm_assert (NM_IS_CONNECTION (connection));
+	nm_assert (plugin_data);
+
+	plugin_data_free = g_variant_ref_sink (plugin_data);
+
+	connection_dict = g_variant_ref_sink (nm_connection_to_dbus (connection, NM_CONNECTION_SERIALIZE_NO_SECRETS));
+
+	connection_restored = _profile_cache_connection_from_dict (connection_dict, NULL);
+	if (   !connection_restored
+	    || !nm_connection_compare (connection, connection_restored, NM_SETTING_COMPARE_FLAG_EXACT))
+		return NULL;
+
+	return g_variant_ref_sink (g_variant_new ("(sttttttvv)",
+	                                          filename,
+	                                          (guint64) st->st_dev,
+	                                          (guint64) st->st_ino,
+	                                          (guint64) st->st_size,
+	                                          (guint64) st->st_mtim.tv_sec,
+	                                          (guint64) st->st_mtim.tv_nsec,
+	                                            ((guint64) st->st_ctim.tv_sec) * NM_UTILS_NS_PER_SECOND
+	                                          + ((guint64) st->st_ctim.tv_nsec),
+	                                          plugin_data,
+	                                          connection_dict));
+}
+
+/**
+ * nm_sett_util_profile_cache_add_entry:
+ * @cache: the profile cache
+ * @entry: (transfer full): an entry from nm_sett_util_profile_cache_entry_new().
+ */
+void
+nm_sett_util_profile_cache_add_entry (NMSettUtilProfileCache *cache,
+                                      GVariant *entry)
+{
+	nm_assert (cache);
+	nm_assert (entry && g_variant_is_of_type (entry, G_VARIANT_TYPE (PROFILE_CACHE_ENTRY_TYPE_STR)));
+
+	g_hash_table_replace (cache->entries,
+	                      (char *) _profile_cache_entry_get_filename (entry),
+	                      entry);
+	cache->dirty = TRUE;
+}
+
+/**
+ * nm_sett_util_profile_cache_add:
+ * @cache: the profile cache
+ * @filename: the filename of the profile
+ * @st: the stat() information of @filename, at the time when it was read.
+ * @connection: the profile that was read from @filename.
+ * @plugin_data: see nm_sett_util_profile_cache_entry_new().
+ *
+ * Adds @connection to the cache, unless it cannot be cached.
+ */
+void
+nm_sett_util_profile_cache_add (NMSettUtilProfileCache *cache,
+                                const char *filename,
+                                const struct stat *st,
+                                NMConnection *connection,
+                                GVariant *plugin_data)
+{
+	GVariant *entry;
+
+	nm_assert (cache);
+
+	entry = nm_sett_util_profile_cache_entry_new (filename, st, connection, plugin_data);
+	if (!entry) {
+		_LOGT ("don't cache \"%s\" which cannot be restored from the cache", filename);
+		return;
+	}
+
+	nm_sett_util_profile_cache_add_entry (cache, entry);
+}
+
+/**
+ * nm_sett_util_profile_cache_save:
+ * @cache: the profile cache
+ *
+ * Writes the cache file with all entries that were looked up or added.
+ * Entries that were not used are dropped. If nothing changed, the file
+ * is not rewritten.
+ */
+void
+nm_sett_util_profile_cache_save (NMSettUtilProfileCache *cache)
+{
+	gs_free_error GError *error = NULL;
+	gs_unref_variant GVariant *variant = NULL;
+	gs_free const char **filenames = NULL;
+	GVariantBuilder builder;
+	guint i, n;
+
+	nm_assert (cache);
+
+	if (   !cache->dirty
+	    && g_hash_table_size (cache->entries) == g_hash_table_size (cache->loaded))
+		return;
+
+	/* sort the entries, so that the same content results in the same file. */
+	filenames = (const char **) g_hash_table_get_keys_as_array (cache->entries, &n);
+	g_qsort_with_data (filenames, n, sizeof (const char *), nm_strcmp_p_with_data, NULL);
+
+	g_variant_builder_init (&builder, G_VARIANT_TYPE ("a"PROFILE_CACHE_ENTRY_TYPE_STR));
+	for (i = 0; i < n; i++)
+		g_variant_builder_add_value (&builder, g_hash_table_lookup (cache->entries, filenames[i]));
+
+	variant = g_variant_ref_sink (g_variant_new ("(s@a"PROFILE_CACHE_ENTRY_TYPE_STR")",
+	                                             cache->cache_key,
+	                                             g_variant_builder_end (&builder)));
+
+	if (!nm_utils_file_set_contents (cache->cache_filename,
+	                                 g_variant_get_data (variant),
+	                                 g_variant_get_size (variant),
+	                                 0600,
+	                                 NULL,
+	                                 &error)) {
+		_LOGD ("failure to write cache \"%s\": %s", cache->cache_filename, error->message);
+		return;
+	}
+
+	_LOGD ("wrote %u entries to cache \"%s\"", n, cache->cache_filename);
+
+	cache->dirty = FALSE;
+}
+
+void
+nm_sett_util_profile_cache_free (NMSettUtilProfileCache *cache)
+{
+	if (!cache)
+		return;
+
+	/* first drop the entries, they may reference the loaded data. */
+	g_hash_table_destroy (cache->entries);
+	g_hash_table_destroy (cache->loaded);
+	g_free (cache->cache_filename);
+	g_free (cache->cache_key);
+	g_slice_free (NMSettUtilProfileCache, cache);
+}
+
+/*****************************************************************************/
+
+/* The autoconnect index buckets the profiles that have autoconnect enabled by
+ * their connection type and their interface name (%NULL for profiles that are
+ * not restricted to an interface name). The profiles in a bucket are sorted by
+ * the compare function of the caller. Since the order may also depend on other
+ * state (like the timestamp of the profile), the buckets are re-sorted lazily,
+ * when the caller indicates that with a different compare generation.
+ *
+ * Additionally, the buckets are indexed by interface name, so that the candidates
+ * for a device that accepts any connection type can be found without visiting
+ * the buckets of other interfaces. */
+
+typedef struct {
+	char *connection_type;
+	char *ifname;
+	GPtrArray *items;
+	guint sorted_cmp_generation;
+	bool sorted:1;
+} AutoconnectIdxBucket;
+
+static guint
+_autoconnect_idx_bucket_hash (gconstpointer ptr)
+{
+	const AutoconnectIdxBucket *bucket = ptr;
+	NMHashState h;
+
+	nm_hash_init (&h, 1553483893u);
+	nm_hash_update_str0 (&h, bucket->connection_type);
+	nm_hash_update_str0 (&h, bucket->ifname);
+	return nm_hash_complete (&h);
+}
+
+static gboolean
+_autoconnect_idx_bucket_equal (gconstpointer ptr_a, gconstpointer ptr_b)
+{
+	const AutoconnectIdxBucket *a = ptr_a;
+	const AutoconnectIdxBucket *b = ptr_b;
+
+	return    nm_streq0 (a->connection_type, b->connection_type)
+	       && nm_streq0 (a->ifname, b->ifname);
+}
+
+static void
+_autoconnect_idx_bucket_free (AutoconnectIdxBucket *bucket)
+{
+	nm_assert (bucket->items->len == 0);
+
+	g_ptr_array_unref (bucket->items);
+	g_free (bucket->connection_type);
+	g_free (bucket->ifname);
+	g_slice_free (AutoconnectIdxBucket, bucket);
+}
+
+static AutoconnectIdxBucket *
+_autoconnect_idx_bucket_lookup (NMSettUtilAutoconnectIdx *idx,
+                                const char *connection_type,
+                                const char *ifname)
+{
+	const AutoconnectIdxBucket needle = {
+		.connection_type = (char *) connection_type,
+		.ifname          = (char *) ifname,
+	};
+
+	return g_hash_table_lookup (idx->buckets, &needle);
+}
+
+static GPtrArray *
+_autoconnect_idx_ifname_buckets (NMSettUtilAutoconnectIdx *idx,
+                                 const char *ifname,
+                                 gboolean create)
+{
+	GPtrArray *arr;
+
+	if (!ifname)
+		return idx->no_ifname;
+
+	arr = g_hash_table_lookup (idx->by_ifname, ifname);
+	if (   !arr
+	    && create) {
+		arr = g_ptr_array_new ();
+		g_hash_table_insert (idx->by_ifname, g_strdup (ifname), arr);
+	}
+	return arr;
+}
+
+static void
+_autoconnect_idx_bucket_ensure_sorted (AutoconnectIdxBucket *bucket,
+                                       GCompareDataFunc cmp,
+                                       gpointer cmp_data,
+                                       guint cmp_generation)
+{
+	if (   bucket->sorted
+	    && bucket->sorted_cmp_generation == cmp_generation)
+		return;
+
+	if (bucket->items->len > 1) {
+		g_qsort_with_data (bucket->items->pdata,
+		                   bucket->items->len,
+		                   sizeof (gpointer),
+		                   cmp,
+		                   cmp_data);
+	}
+	bucket->sorted = TRUE;
+	bucket->sorted_cmp_generation = cmp_generation;
+}
+
+void
+nm_sett_util_autoconnect_idx_init (NMSettUtilAutoconnectIdx *idx)
+{
+	*idx = (NMSettUtilAutoconnectIdx) {
+		.buckets   = g_hash_table_new_full (_autoconnect_idx_bucket_hash,
+		                                    _autoconnect_idx_bucket_equal,
+		                                    (GDestroyNotify) _autoconnect_idx_bucket_free,
+		                                    NULL),
+		.by_item   = g_hash_table_new (nm_direct_hash, NULL),
+		.by_ifname = g_hash_table_new_full (nm_str_hash, g_str_equal, g_free, (GDestroyNotify) g_ptr_array_unref),
+		.no_ifname = g_ptr_array_new (),
+	};
+}
+
+void
+nm_sett_util_autoconnect_idx_clear (NMSettUtilAutoconnectIdx *idx)
+{
+	nm_assert (!idx->by_item || g_hash_table_size (idx->by_item) == 0);
+
+	nm_clear_pointer (&idx->by_item, g_hash_table_destroy);
+	nm_clear_pointer (&idx->by_ifname, g_hash_table_destroy);
+	nm_clear_pointer (&idx->no_ifname, g_ptr_array_unref);
+	nm_clear_pointer (&idx->buckets, g_hash_table_destroy);
+}
+
+/**
+ * nm_sett_util_autoconnect_idx_remove:
+ * @idx: the autoconnect index
+ * @item: the indexed item for the profile
+ *
+ * Removes @item from the index. It's fine if it isn't indexed.
+ */
+void
+nm_sett_util_autoconnect_idx_remove (NMSettUtilAutoconnectIdx *idx,
+                                     gpointer item)
+{
+	AutoconnectIdxBucket *bucket;
+	GPtrArray *ifname_buckets;
+
+	bucket = g_hash_table_lookup (idx->by_item, item);
+	if (!bucket)
+		return;
+
+	g_hash_table_remove (idx->by_item, item);
+
+	/* removing an element does not change the order of the others. */
+	if (!g_ptr_array_remove (bucket->items, item))
+		nm_assert_not_reached ();
+
+	if (bucket->items->len > 0)
+		return;
+
+	ifname_buckets = _autoconnect_idx_ifname_buckets (idx, bucket->ifname, FALSE);
+	if (!g_ptr_array_remove_fast (ifname_buckets, bucket))
+		nm_assert_not_reached ();
+	if (   ifname_buckets->len == 0
+	    && bucket->ifname)
+		g_hash_table_remove (idx->by_ifname, bucket->ifname);
+
+	g_hash_table_remove (idx->buckets, bucket);
+}
+
+/**
+ * nm_sett_util_autoconnect_idx_update:
+ * @idx: the autoconnect index
+ * @item: the item to index, for example the #NMSettingsConnection.
+ * @connection: the current profile of @item.
+ *
+ * Adds @item to the index or moves it to the bucket that matches
+ * the connection type and interface name of @connection. Profiles
+ * without autoconnect enabled are removed from the index. The index
+ * does not take a reference, the caller must remove the item before it
+ * is destroyed.
+ */
+void
+nm_sett_util_autoconnect_idx_update (NMSettUtilAutoconnectIdx *idx,
+                                     gpointer item,
+                                     NMConnection *connection)
+{
+	NMSettingConnection *s_con;
+	AutoconnectIdxBucket *bucket;
+	const char *connection_type;
+	const char *ifname;
+
+	nm_assert (item);
+	nm_assert (NM_IS_CONNECTION (connection));
+
+	/* the autoconnect priority might have changed. Always re-add the profile. */
+	nm_sett_util_autoconnect_idx_remove (idx, item);
+
+	s_con = nm_connection_get_setting_connection (connection);
+	if (   !s_con
+	    || !nm_setting_connection_get_autoconnect (s_con))
+		return;
+
+	connection_type = nm_setting_connection_get_connection_type (s_con);
+	ifname = nm_setting_connection_get_interface_name (s_con);
+
+	bucket = _autoconnect_idx_bucket_lookup (idx, connection_type, ifname);
+	if (!bucket) {
+		bucket = g_slice_new (AutoconnectIdxBucket);
+		*bucket = (AutoconnectIdxBucket) {
+			.connection_type = g_strdup (connection_type),
+			.ifname          = g_strdup (ifname),
+			.items           = g_ptr_array_new (),
+		};
+		g_hash_table_add (idx->buckets, bucket);
+		g_ptr_array_add (_autoconnect_idx_ifname_buckets (idx, ifname, TRUE), bucket);
+	}
+
+	g_ptr_array_add (bucket->items, item);
+	bucket->sorted = FALSE;
+	g_hash_table_insert (idx->by_item, item, bucket);
+}
+
+/**
+ * nm_sett_util_autoconnect_idx_get_candidates:
+ * @idx: the autoconnect index
+ * @connection_type: (allow-none): the connection type of the profiles, or
+ *   %NULL to return profiles of any type.
+ * @ifname: (allow-none): the interface name of the device.
+ * @cmp: the sort order of the result. It is called with pointers
+ *   to the items.
+ * @cmp_data: user data for @cmp.
+ * @cmp_generation: the order of @cmp must not change as long as the
+ *   caller passes the same @cmp_generation.
+ * @out_len: (allow-none): returns the number of candidates.
+ *
+ * Returns the items whose profiles have autoconnect enabled and that
+ * are either not restricted to an interface name, or that are restricted
+ * to @ifname.
+ *
+ * Returns: (transfer container): a %NULL terminated list of items, sorted by
+ *   @cmp. Free with g_free().
+ */
+gpointer *
+nm_sett_util_autoconnect_idx_get_candidates (NMSettUtilAutoconnectIdx *idx,
+                                             const char *connection_type,
+                                             const char *ifname,
+                                             GCompareDataFunc cmp,
+                                             gpointer cmp_data,
+                                             guint cmp_generation,
+                                             guint *out_len)
+{
+	AutoconnectIdxBucket *buckets_stack[2];
+	gs_free AutoconnectIdxBucket **buckets_heap = NULL;
+	AutoconnectIdxBucket **buckets;
+	gpointer *list;
+	guint n_buckets = 0;
+	guint len = 0;
+	guint i;
+
+	if (connection_type) {
+		AutoconnectIdxBucket *bucket;
+
+		buckets = buckets_stack;
+		bucket = _autoconnect_idx_bucket_lookup (idx, connection_type, NULL);
+		if (bucket)
+			buckets[n_buckets++] = bucket;
+		if (ifname) {
+			bucket = _autoconnect_idx_bucket_lookup (idx, connection_type, ifname);
+			if (bucket)
+				buckets[n_buckets++] = bucket;
+		}
+	} else {
+		GPtrArray *ifname_buckets = NULL;
+
+		if (ifname)
+			ifname_buckets = _autoconnect_idx_ifname_buckets (idx, ifname, FALSE);
+
+		buckets_heap = g_new (AutoconnectIdxBucket *,
+		                      (gsize) idx->no_ifname->len + (ifname_buckets ? ifname_buckets->len : 0u));
+		buckets = buckets_heap;
+		for (i = 0; i < idx->no_ifname->len; i++)
+			buckets[n_buckets++] = idx->no_ifname->pdata[i];
+		for (i = 0; ifname_buckets && i < ifname_buckets->len; i++)
+			buckets[n_buckets++] = ifname_buckets->pdata[i];
+	}
+
+	for (i = 0; i < n_buckets; i++)
+		len += buckets[i]->items->len;
+
+	list = g_new (gpointer, (gsize) len + 1);
+
+	len = 0;
+	for (i = 0; i < n_buckets; i++) {
+		_autoconnect_idx_bucket_ensure_sorted (buckets[i], cmp, cmp_data, cmp_generation);
+		memcpy (&list[len], buckets[i]->items->pdata, sizeof (gpointer) * buckets[i]->items->len);
+		len += buckets[i]->items->len;
+	}
+	list[len] = NULL;
+
+	/* the buckets are sorted, but when we combine several of them, we need to
+	 * sort the result again. */
+	if (   n_buckets > 1
+	    && len > 1)
+		g_qsort_with_data (list, len, sizeof (gpointer), cmp, cmp_data);
+
+	NM_SET_OUT (out_len, len);
+	return list;
+}
@@ -93,4 +93,82 @@ typedef struct {
 gboolean nm_sett_util_allow_filename_cb (const char *filename,
                                          gpointer user_data);
 
+/*****************************************************************************/
+
+struct stat;
+
+typedef struct _NMSettUtilProfileCache NMSettUtilProfileCache;
+
+NMSettUtilProfileCache *nm_sett_util_profile_cache_load (const char *cache_filename,
+                                                         const char *cache_key);
+
+GVariant *nm_sett_util_profile_cache_lookup_entry (NMSettUtilProfileCache *cache,
+                                                   const char *filename,
+                                                   const struct stat *st);
+
+NMConnection *nm_sett_util_profile_cache_entry_restore (GVariant *entry,
+                                                        GVariant **out_plugin_data,
+                                                        GError **error);
+
+void nm_sett_util_profile_cache_keep_entry (NMSettUtilProfileCache *cache,
+                                            GVariant *entry);
+
+GVariant *nm_sett_util_profile_cache_entry_new (const char *filename,
+                                                const struct stat *st,
+                                                NMConnection *connection,
+                                                GVariant *plugin_data);
+
+void nm_sett_util_profile_cache_add_entry (NMSettUtilProfileCache *cache,
+                                           GVariant *entry);
+
+NMConnection *nm_sett_util_profile_cache_lookup (NMSettUtilProfileCache *cache,
+                                                 const char *filename,
+                                                 const struct stat *st,
+                                                 GVariant **out_plugin_data);
+
+void nm_sett_util_profile_cache_add (NMSettUtilProfileCache *cache,
+                                     const char *filename,
+                                     const struct stat *st,
+                                     NMConnection *connection,
+                                     GVariant *plugin_data);
+
+void nm_sett_util_profile_cache_save (NMSettUtilProfileCache *cache);
+
+void nm_sett_util_profile_cache_free (NMSettUtilProfileCache *cache);
+
+NM_AUTO_DEFINE_FCN0 (NMSettUtilProfileCache *, _nm_auto_free_sett_util_profile_cache, nm_sett_util_profile_cache_free);
+#define nm_auto_free_sett_util_profile_cache nm_auto(_nm_auto_free_sett_util_profile_cache)
+
+/*****************************************************************************/
+
+typedef struct {
+	/* the buckets of items, keyed by connection type and interface name. */
+	GHashTable *buckets;
+	/* item -> bucket */
+	GHashTable *by_item;
+	/* interface name -> GPtrArray of the buckets with that interface name. */
+	GHashTable *by_ifname;
+	/* the buckets without interface name. */
+	GPtrArray *no_ifname;
+} NMSettUtilAutoconnectIdx;
+
+void nm_sett_util_autoconnect_idx_init (NMSettUtilAutoconnectIdx *idx);
+
+void nm_sett_util_autoconnect_idx_clear (NMSettUtilAutoconnectIdx *idx);
+
+void nm_sett_util_autoconnect_idx_update (NMSettUtilAutoconnectIdx *idx,
+                                          gpointer item,
+                                          NMConnection *connection);
+
+void nm_sett_util_autoconnect_idx_remove (NMSettUtilAutoconnectIdx *idx,
+                                          gpointer item);
+
+gpointer *nm_sett_util_autoconnect_idx_get_candidates (NMSettUtilAutoconnectIdx *idx,
+                                                       const char *connection_type,
+                                                       const char *ifname,
+                                                       GCompareDataFunc cmp,
+                                                       gpointer cmp_data,
+                                                       guint cmp_generation,
+                                                       guint *out_len);
+
 #endif /* __NM_SETTINGS_UTILS_H__ */
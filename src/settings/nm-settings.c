@@ -359,6 +359,9 @@ typedef struct {
 
 	GHashTable *sce_idx;
 
+	/* the index of profiles that have autoconnect enabled. */
+	NMSettUtilAutoconnectIdx autoconnect_idx;
+
 	CList sce_dirty_lst_head;
 
 	CList connections_lst_head;
@@ -809,6 +812,43 @@ _sett_conn_entries_remove_and_destroy (NMSettings *self,
 
 /*****************************************************************************/
 
+/**
+ * nm_settings_get_autoconnect_candidates:
+ * @self: the #NMSettings
+ * @connection_type: (allow-none): the connection type of the profiles, or
+ *   %NULL to return profiles of any type.
+ * @ifname: (allow-none): the interface name of the device.
+ * @out_len: (allow-none): returns the number of candidates.
+ *
+ * Returns the profiles that have autoconnect enabled and that are
+ * either not restricted to an interface name, or that are restricted
+ * to @ifname. This is a superset of the profiles that can autoconnect
+ * on a device of that type and name, the caller still needs to check whether
+ * the profile is compatible and allowed to autoconnect.
+ *
+ * Returns: (transfer container): a %NULL terminated list of profiles, sorted by
+ *   nm_settings_connection_cmp_autoconnect_priority(). Free with g_free().
+ */
+NMSettingsConnection **
+nm_settings_get_autoconnect_candidates (NMSettings *self,
+                                        const char *connection_type,
+                                        const char *ifname,
+                                        guint *out_len)
+{
+	g_return_val_if_fail (NM_IS_SETTINGS (self), NULL);
+
+	/* the order also depends on the timestamps of the profiles. */
+	return (NMSettingsConnection **) nm_sett_util_autoconnect_idx_get_candidates (&NM_SETTINGS_GET_PRIVATE (self)->autoconnect_idx,
+	                                                                              connection_type,
+	                                                                              ifname,
+	                                                                              nm_settings_connection_cmp_autoconnect_priority_p_with_data,
+	                                                                              NULL,
+	                                                                              nm_settings_connection_get_timestamp_generation (),
+	                                                                              out_len);
+}
+
+/*****************************************************************************/
+
 static int
 _sett_conn_entry_sds_update_cmp_ascending (const StorageData *sd_a,
                                            const StorageData *sd_b,
@@ -1069,6 +1109,10 @@ _connection_changed_update (NMSettings *self,
 		g_signal_connect (sett_conn, NM_SETTINGS_CONNECTION_FLAGS_CHANGED, G_CALLBACK (connection_flags_changed), self);
 	}
 
+	nm_sett_util_autoconnect_idx_update (&priv->autoconnect_idx,
+	                                     sett_conn,
+	                                     nm_settings_connection_get_connection (sett_conn));
+
 	if (NM_FLAGS_HAS (update_reason, NM_SETTINGS_CONNECTION_UPDATE_REASON_BLOCK_AUTOCONNECT)) {
 		nm_settings_connection_autoconnect_blocked_reason_set (sett_conn,
 		                                                       NM_SETTINGS_AUTO_CONNECT_BLOCKED_REASON_USER_REQUEST,
@@ -1172,6 +1216,8 @@ _connection_changed_delete (NMSettings *self,
 
 	g_signal_handlers_disconnect_by_func (sett_conn, G_CALLBACK (connection_flags_changed), self);
 
+	nm_sett_util_autoconnect_idx_remove (&priv->autoconnect_idx, sett_conn);
+
 	_clear_connections_cached_list (priv);
 	c_list_unlink (&sett_conn->_connections_lst);
 	priv->connections_len--;
@@ -2603,6 +2649,60 @@ settings_add_connection_helper (NMSettings *self,
 	                                 GINT_TO_POINTER (!!is_add_connection_2));
 }
 
+static gboolean
+_add_connection2_check_flags (guint32 flags, GError **error)
+{
+	if (NM_FLAGS_ANY (flags, ~((guint32) (  NM_SETTINGS_ADD_CONNECTION2_FLAG_TO_DISK
+	                                      | NM_SETTINGS_ADD_CONNECTION2_FLAG_IN_MEMORY
+	                                      | NM_SETTINGS_ADD_CONNECTION2_FLAG_BLOCK_AUTOCONNECT)))) {
+		g_set_error_literal (error,
+		                     NM_SETTINGS_ERROR,
+		                     NM_SETTINGS_ERROR_INVALID_ARGUMENTS,
+		                     "Unknown flags");
+		return FALSE;
+	}
+
+	if (!NM_FLAGS_ANY (flags,   NM_SETTINGS_ADD_CONNECTION2_FLAG_TO_DISK
+	                          | NM_SETTINGS_ADD_CONNECTION2_FLAG_IN_MEMORY)) {
+		g_set_error_literal (error,
+		                     NM_SETTINGS_ERROR,
+		                     NM_SETTINGS_ERROR_INVALID_ARGUMENTS,
+		                     "Requires either to-disk (0x1) or in-memory (0x2) flags");
+		return FALSE;
+	}
+
+	if (NM_FLAGS_ALL (flags,   NM_SETTINGS_ADD_CONNECTION2_FLAG_TO_DISK
+	                         | NM_SETTINGS_ADD_CONNECTION2_FLAG_IN_MEMORY)) {
+		g_set_error_literal (error,
+		                     NM_SETTINGS_ERROR,
+		                     NM_SETTINGS_ERROR_INVALID_ARGUMENTS,
+		                     "Cannot set to-disk (0x1) and in-memory (0x2) flags together");
+		return FALSE;
+	}
+
+	return TRUE;
+}
+
+static gboolean
+_check_no_args (GVariant *args, GError **error)
+{
+	const char *args_name;
+	GVariantIter iter;
+
+	nm_assert (g_variant_is_of_type (args, G_VARIANT_TYPE ("a{sv}")));
+
+	g_variant_iter_init (&iter, args);
+	while (g_variant_iter_next (&iter, "{&sv}", &args_name, NULL)) {
+		g_set_error (error,
+		             NM_SETTINGS_ERROR,
+		             NM_SETTINGS_ERROR_INVALID_ARGUMENTS,
+		             "Unsupported argument '%s'", args_name);
+		return FALSE;
+	}
+
+	return TRUE;
+}
+
 static void
 impl_settings_add_connection (NMDBusObject *obj,
                               const NMDBusInterfaceInfoExtended *interface_info,
@@ -2648,54 +2748,540 @@ impl_settings_add_connection2 (NMDBusObject *obj,
 	gs_unref_variant GVariant *settings = NULL;
 	gs_unref_variant GVariant *args = NULL;
 	NMSettingsAddConnection2Flags flags;
-	const char *args_name;
-	GVariantIter iter;
+	GError *error = NULL;
 	guint32 flags_u;
 
 	g_variant_get (parameters, "(@a{sa{sv}}u@a{sv})", &settings, &flags_u, &args);
 
-	if (NM_FLAGS_ANY (flags_u, ~((guint32) (  NM_SETTINGS_ADD_CONNECTION2_FLAG_TO_DISK
-	                                        | NM_SETTINGS_ADD_CONNECTION2_FLAG_IN_MEMORY
-	                                        | NM_SETTINGS_ADD_CONNECTION2_FLAG_BLOCK_AUTOCONNECT)))) {
-		g_dbus_method_invocation_take_error (invocation,
-		                                     g_error_new_literal (NM_SETTINGS_ERROR,
-		                                                          NM_SETTINGS_ERROR_INVALID_ARGUMENTS,
-		                                                          "Unknown flags"));
+	if (   !_add_connection2_check_flags (flags_u, &error)
+	    || !_check_no_args (args, &error)) {
+		g_dbus_method_invocation_take_error (invocation, error);
 		return;
 	}
 
 	flags = flags_u;
 
-	if (!NM_FLAGS_ANY (flags,   NM_SETTINGS_ADD_CONNECTION2_FLAG_TO_DISK
-	                          | NM_SETTINGS_ADD_CONNECTION2_FLAG_IN_MEMORY)) {
-		g_dbus_method_invocation_take_error (invocation,
-		                                     g_error_new_literal (NM_SETTINGS_ERROR,
-		                                                          NM_SETTINGS_ERROR_INVALID_ARGUMENTS,
-		                                                          "Requires either to-disk (0x1) or in-memory (0x2) flags"));
+	settings_add_connection_helper (self, invocation, TRUE, settings, flags);
+}
+
+/*****************************************************************************/
+
+typedef struct {
+	NMAuthSubject *subject;
+
+	/* the new profiles. For UpdateConnections(), an entry may be %NULL
+	 * to only change the persist mode of the existing profile. */
+	GPtrArray *connections;
+
+	/* for UpdateConnections(), the profiles to update. */
+	GPtrArray *sett_conns;
+
+	guint32 flags;
+	bool is_update:1;
+	bool need_modify_own:1;
+	bool need_modify_system:1;
+} BatchRequest;
+
+static BatchRequest *
+_batch_request_new (NMAuthSubject *subject, gboolean is_update, guint32 flags)
+{
+	BatchRequest *req;
+
+	req = g_slice_new0 (BatchRequest);
+	req->subject = g_object_ref (subject);
+	req->connections = g_ptr_array_new_with_free_func ((GDestroyNotify) nm_g_object_unref);
+	if (is_update)
+		req->sett_conns = g_ptr_array_new_with_free_func (g_object_unref);
+	req->flags = flags;
+	req->is_update = is_update;
+	return req;
+}
+
+static void
+_batch_request_free (gpointer user_data)
+{
+	BatchRequest *req = user_data;
+
+	g_object_unref (req->subject);
+	g_ptr_array_unref (req->connections);
+	if (req->sett_conns)
+		g_ptr_array_unref (req->sett_conns);
+	g_slice_free (BatchRequest, req);
+}
+
+static void
+_batch_request_add_permission (BatchRequest *req, const char *perm)
+{
+	if (nm_streq (perm, NM_AUTH_PERMISSION_SETTINGS_MODIFY_OWN))
+		req->need_modify_own = TRUE;
+	else {
+		nm_assert (nm_streq (perm, NM_AUTH_PERMISSION_SETTINGS_MODIFY_SYSTEM));
+		req->need_modify_system = TRUE;
+	}
+}
+
+static gboolean
+_batch_add (NMSettings *self,
+            BatchRequest *req,
+            GVariantBuilder *paths,
+            GError **error)
+{
+	gs_unref_ptrarray GPtrArray *added = NULL;
+	NMSettingsConnectionPersistMode persist_mode;
+	NMSettingsConnectionAddReason add_reason;
+	guint i;
+
+	if (NM_FLAGS_HAS (req->flags, NM_SETTINGS_ADD_CONNECTION2_FLAG_TO_DISK))
+		persist_mode = NM_SETTINGS_CONNECTION_PERSIST_MODE_TO_DISK;
+	else {
+		nm_assert (NM_FLAGS_HAS (req->flags, NM_SETTINGS_ADD_CONNECTION2_FLAG_IN_MEMORY));
+		persist_mode = NM_SETTINGS_CONNECTION_PERSIST_MODE_IN_MEMORY_ONLY;
+	}
+
+	add_reason =   NM_FLAGS_HAS (req->flags, NM_SETTINGS_ADD_CONNECTION2_FLAG_BLOCK_AUTOCONNECT)
+	             ? NM_SETTINGS_CONNECTION_ADD_REASON_BLOCK_AUTOCONNECT
+	             : NM_SETTINGS_CONNECTION_ADD_REASON_NONE;
+
+	added = g_ptr_array_new_with_free_func (g_object_unref);
+
+	for (i = 0; i < req->connections->len; i++) {
+		NMConnection *connection = req->connections->pdata[i];
+		gs_free_error GError *local = NULL;
+		NMSettingsConnection *sett_conn;
+
+		if (!nm_settings_add_connection (self,
+		                                 connection,
+		                                 persist_mode,
+		                                 add_reason,
+		                                 NM_SETTINGS_CONNECTION_INT_FLAGS_NONE,
+		                                 &sett_conn,
+		                                 &local)) {
+			nm_audit_log_connection_op (NM_AUDIT_OP_CONN_ADD, NULL, FALSE, NULL,
+			                            req->subject, local->message);
+			g_set_error (error,
+			             local->domain,
+			             local->code,
+			             "failure to add profile #%u (%s): %s",
+			             i,
+			             nm_connection_get_id (connection),
+			             local->message);
+			goto rollback;
+		}
+
+		g_ptr_array_add (added, g_object_ref (sett_conn));
+	}
+
+	for (i = 0; i < added->len; i++) {
+		NMSettingsConnection *sett_conn = added->pdata[i];
+
+		g_variant_builder_add (paths, "o", nm_dbus_object_get_path (NM_DBUS_OBJECT (sett_conn)));
+		nm_audit_log_connection_op (NM_AUDIT_OP_CONN_ADD, sett_conn, TRUE, NULL,
+		                            req->subject, NULL);
+
+		/* Send agent-owned secrets to the agents */
+		if (nm_settings_has_connection (self, sett_conn))
+			send_agent_owned_secrets (self, sett_conn, req->subject);
+	}
+
+	return TRUE;
+
+rollback:
+	/* the batch is all-or-nothing. Delete again what we added so far. */
+	for (i = added->len; i > 0; i--) {
+		NMSettingsConnection *sett_conn = added->pdata[i - 1];
+
+		if (nm_settings_has_connection (self, sett_conn))
+			nm_settings_connection_delete (sett_conn, FALSE);
+	}
+	return FALSE;
+}
+
+static gboolean
+_batch_update (NMSettings *self,
+               BatchRequest *req,
+               GError **error)
+{
+	gs_unref_ptrarray GPtrArray *old_connections = NULL;
+	guint n_updated;
+	guint i;
+
+	nm_assert (req->sett_conns->len == req->connections->len);
+
+	old_connections = g_ptr_array_new_full (req->sett_conns->len, g_object_unref);
+
+	for (i = 0; i < req->sett_conns->len; i++) {
+		NMSettingsConnection *sett_conn = req->sett_conns->pdata[i];
+
+		if (!nm_settings_has_connection (self, sett_conn)) {
+			g_set_error (error,
+			             NM_SETTINGS_ERROR,
+			             NM_SETTINGS_ERROR_INVALID_CONNECTION,
+			             "failure to update profile #%u (%s): profile was deleted",
+			             i,
+			             nm_settings_connection_get_id (sett_conn));
+			return FALSE;
+		}
+		g_ptr_array_add (old_connections,
+		                 nm_simple_connection_new_clone (nm_settings_connection_get_connection (sett_conn)));
+	}
+
+	for (n_updated = 0; n_updated < req->sett_conns->len; n_updated++) {
+		NMSettingsConnection *sett_conn = req->sett_conns->pdata[n_updated];
+		gs_free_error GError *local = NULL;
+		gs_free char *audit_args = NULL;
+
+		if (!nm_settings_connection_update_from_dbus (sett_conn,
+		                                              req->connections->pdata[n_updated],
+		                                              req->flags,
+		                                              req->subject,
+		                                              &audit_args,
+		                                              &local)) {
+			nm_audit_log_connection_op (NM_AUDIT_OP_CONN_UPDATE, sett_conn, FALSE, NULL,
+			                            req->subject, local->message);
+			g_set_error (error,
+			             local->domain,
+			             local->code,
+			             "failure to update profile #%u (%s): %s",
+			             n_updated,
+			             nm_settings_connection_get_id (sett_conn),
+			             local->message);
+			goto rollback;
+		}
+
+		nm_audit_log_connection_op (NM_AUDIT_OP_CONN_UPDATE, sett_conn, TRUE, audit_args,
+		                            req->subject, NULL);
+	}
+
+	return TRUE;
+
+rollback:
+	/* Restore the previous content of the profiles that we already updated.
+	 * This is best-effort. A changed persist mode is kept. */
+	for (i = n_updated; i > 0; i--) {
+		NMSettingsConnection *sett_conn = req->sett_conns->pdata[i - 1];
+		gs_free_error GError *local = NULL;
+
+		if (!nm_settings_has_connection (self, sett_conn))
+			continue;
+
+		if (!nm_settings_connection_update (sett_conn,
+		                                    old_connections->pdata[i - 1],
+		                                    NM_SETTINGS_CONNECTION_PERSIST_MODE_KEEP,
+		                                    NM_SETTINGS_CONNECTION_INT_FLAGS_NONE,
+		                                    NM_SETTINGS_CONNECTION_INT_FLAGS_NONE,
+		                                      NM_SETTINGS_CONNECTION_UPDATE_REASON_FORCE_RENAME
+		                                    | NM_SETTINGS_CONNECTION_UPDATE_REASON_RESET_SYSTEM_SECRETS,
+		                                    "update-from-dbus-rollback",
+		                                    &local)) {
+			_LOGW ("update: failure to restore profile %s (%s) after failed batch update: %s",
+			       nm_settings_connection_get_uuid (sett_conn),
+			       nm_settings_connection_get_id (sett_conn),
+			       local->message);
+		}
+	}
+	return FALSE;
+}
+
+static void
+pk_batch_cb (NMAuthChain *chain,
+             GDBusMethodInvocation *context,
+             gpointer user_data)
+{
+	NMSettings *self = NM_SETTINGS (user_data);
+	gs_free_error GError *error = NULL;
+	GVariantBuilder paths;
+	GVariantBuilder result;
+	BatchRequest *req;
+	gboolean success;
+
+	nm_assert (G_IS_DBUS_METHOD_INVOCATION (context));
+
+	c_list_unlink (nm_auth_chain_parent_lst_list (chain));
+
+	req = nm_auth_chain_get_data (chain, "request");
+	nm_assert (req);
+
+	if (   (   req->need_modify_own
+	        && nm_auth_chain_get_result (chain, NM_AUTH_PERMISSION_SETTINGS_MODIFY_OWN) != NM_AUTH_CALL_RESULT_YES)
+	    || (   req->need_modify_system
+	        && nm_auth_chain_get_result (chain, NM_AUTH_PERMISSION_SETTINGS_MODIFY_SYSTEM) != NM_AUTH_CALL_RESULT_YES)) {
+		error = g_error_new_literal (NM_SETTINGS_ERROR,
+		                             NM_SETTINGS_ERROR_PERMISSION_DENIED,
+		                             NM_UTILS_ERROR_MSG_INSUFF_PRIV);
+		nm_audit_log_connection_op (req->is_update ? NM_AUDIT_OP_CONN_UPDATE : NM_AUDIT_OP_CONN_ADD,
+		                            NULL, FALSE, NULL, req->subject, error->message);
+		g_dbus_method_invocation_return_gerror (context, error);
 		return;
 	}
 
-	if (NM_FLAGS_ALL (flags,   NM_SETTINGS_ADD_CONNECTION2_FLAG_TO_DISK
-	                         | NM_SETTINGS_ADD_CONNECTION2_FLAG_IN_MEMORY)) {
-		g_dbus_method_invocation_take_error (invocation,
-		                                     g_error_new_literal (NM_SETTINGS_ERROR,
-		                                                          NM_SETTINGS_ERROR_INVALID_ARGUMENTS,
-		                                                          "Cannot set to-disk (0x1) and in-memory (0x2) flags together"));
+	_LOGD ("%s: %u profiles in one batch",
+	       req->is_update ? "update" : "add",
+	       req->connections->len);
+
+	g_variant_builder_init (&paths, G_VARIANT_TYPE ("ao"));
+
+	/* Changing many profiles at once would notify the "Connections" property
+	 * for each of them. Only notify once at the end. */
+	g_object_freeze_notify (G_OBJECT (self));
+	if (req->is_update)
+		success = _batch_update (self, req, &error);
+	else
+		success = _batch_add (self, req, &paths, &error);
+	g_object_thaw_notify (G_OBJECT (self));
+
+	if (!success) {
+		g_variant_builder_clear (&paths);
+		g_dbus_method_invocation_return_gerror (context, error);
 		return;
 	}
 
-	nm_assert (g_variant_is_of_type (args, G_VARIANT_TYPE ("a{sv}")));
+	g_variant_builder_init (&result, G_VARIANT_TYPE_VARDICT);
+	if (req->is_update) {
+		g_variant_builder_clear (&paths);
+		g_dbus_method_invocation_return_value (context,
+		                                       g_variant_new ("(a{sv})", &result));
+	} else {
+		g_dbus_method_invocation_return_value (context,
+		                                       g_variant_new ("(aoa{sv})", &paths, &result));
+	}
+}
 
-	g_variant_iter_init (&iter, args);
-	while (g_variant_iter_next (&iter, "{&sv}", &args_name, NULL)) {
-		g_dbus_method_invocation_take_error (invocation,
-		                                     g_error_new (NM_SETTINGS_ERROR,
-		                                                  NM_SETTINGS_ERROR_INVALID_ARGUMENTS,
-		                                                  "Unsupported argument '%s'", args_name));
+static void
+_batch_request_start (NMSettings *self,
+                      GDBusMethodInvocation *context,
+                      BatchRequest *req)
+{
+	NMSettingsPrivate *priv = NM_SETTINGS_GET_PRIVATE (self);
+	NMAuthChain *chain;
+
+	nm_assert (req->need_modify_own || req->need_modify_system);
+
+	/* authorize the entire batch at once. */
+	chain = nm_auth_chain_new_subject (req->subject, context, pk_batch_cb, self);
+	if (!chain) {
+		_batch_request_free (req);
+		g_dbus_method_invocation_return_error_literal (context,
+		                                               NM_SETTINGS_ERROR,
+		                                               NM_SETTINGS_ERROR_PERMISSION_DENIED,
+		                                               NM_UTILS_ERROR_MSG_REQ_AUTH_FAILED);
 		return;
 	}
 
-	settings_add_connection_helper (self, invocation, TRUE, settings, flags);
+	c_list_link_tail (&priv->auth_lst_head, nm_auth_chain_parent_lst_list (chain));
+
+	nm_auth_chain_set_data (chain, "request", req, _batch_request_free);
+	if (req->need_modify_own)
+		nm_auth_chain_add_call_unsafe (chain, NM_AUTH_PERMISSION_SETTINGS_MODIFY_OWN, TRUE);
+	if (req->need_modify_system)
+		nm_auth_chain_add_call_unsafe (chain, NM_AUTH_PERMISSION_SETTINGS_MODIFY_SYSTEM, TRUE);
+}
+
+static void
+impl_settings_add_connections (NMDBusObject *obj,
+                               const NMDBusInterfaceInfoExtended *interface_info,
+                               const NMDBusMethodInfoExtended *method_info,
+                               GDBusConnection *connection,
+                               const char *sender,
+                               GDBusMethodInvocation *invocation,
+                               GVariant *parameters)
+{
+	NMSettings *self = NM_SETTINGS (obj);
+	gs_unref_variant GVariant *settings_list = NULL;
+	gs_unref_variant GVariant *args = NULL;
+	gs_unref_object NMAuthSubject *subject = NULL;
+	BatchRequest *req;
+	GError *error = NULL;
+	guint32 flags_u;
+	gsize n;
+	gsize i;
+
+	g_variant_get (parameters, "(@aa{sa{sv}}u@a{sv})", &settings_list, &flags_u, &args);
+
+	if (   !_add_connection2_check_flags (flags_u, &error)
+	    || !_check_no_args (args, &error)) {
+		g_dbus_method_invocation_take_error (invocation, error);
+		return;
+	}
+
+	n = g_variant_n_children (settings_list);
+	if (n == 0) {
+		GVariantBuilder result;
+
+		g_variant_builder_init (&result, G_VARIANT_TYPE_VARDICT);
+		g_dbus_method_invocation_return_value (invocation,
+		                                       g_variant_new ("(@aoa{sv})",
+		                                                      g_variant_new_array (G_VARIANT_TYPE_OBJECT_PATH, NULL, 0),
+		                                                      &result));
+		return;
+	}
+
+	subject = nm_auth_subject_new_unix_process_from_context (invocation);
+	if (!subject) {
+		g_dbus_method_invocation_return_error_literal (invocation,
+		                                               NM_SETTINGS_ERROR,
+		                                               NM_SETTINGS_ERROR_PERMISSION_DENIED,
+		                                               NM_UTILS_ERROR_MSG_REQ_UID_UKNOWN);
+		return;
+	}
+
+	req = _batch_request_new (subject, FALSE, flags_u);
+
+	/* validate all profiles before touching anything. */
+	for (i = 0; i < n; i++) {
+		gs_unref_variant GVariant *settings = NULL;
+		gs_unref_object NMConnection *new_connection = NULL;
+		NMSettingConnection *s_con;
+
+		settings = g_variant_get_child_value (settings_list, i);
+
+		new_connection = _nm_simple_connection_new_from_dbus (settings,
+		                                                        NM_SETTING_PARSE_FLAGS_STRICT
+		                                                      | NM_SETTING_PARSE_FLAGS_NORMALIZE,
+		                                                      &error);
+		if (   !new_connection
+		    || !nm_connection_verify_secrets (new_connection, &error)
+		    || !nm_auth_is_subject_in_acl_set_error (new_connection,
+		                                             subject,
+		                                             NM_SETTINGS_ERROR,
+		                                             NM_SETTINGS_ERROR_PERMISSION_DENIED,
+		                                             &error)) {
+			g_prefix_error (&error, "profile #%u: ", (guint) i);
+			_batch_request_free (req);
+			g_dbus_method_invocation_take_error (invocation, error);
+			return;
+		}
+
+		/* If the caller is the only user in the connection's permissions, then
+		 * we use the 'modify.own' permission instead of 'modify.system'. */
+		s_con = nm_connection_get_setting_connection (new_connection);
+		_batch_request_add_permission (req,
+		                                 nm_setting_connection_get_num_permissions (s_con) == 1
+		                               ? NM_AUTH_PERMISSION_SETTINGS_MODIFY_OWN
+		                               : NM_AUTH_PERMISSION_SETTINGS_MODIFY_SYSTEM);
+
+		g_ptr_array_add (req->connections, g_steal_pointer (&new_connection));
+	}
+
+	_batch_request_start (self, invocation, req);
+}
+
+static void
+impl_settings_update_connections (NMDBusObject *obj,
+                                  const NMDBusInterfaceInfoExtended *interface_info,
+                                  const NMDBusMethodInfoExtended *method_info,
+                                  GDBusConnection *connection,
+                                  const char *sender,
+                                  GDBusMethodInvocation *invocation,
+                                  GVariant *parameters)
+{
+	NMSettings *self = NM_SETTINGS (obj);
+	gs_unref_variant GVariant *updates = NULL;
+	gs_unref_variant GVariant *args = NULL;
+	gs_unref_object NMAuthSubject *subject = NULL;
+	gs_unref_hashtable GHashTable *seen = NULL;
+	BatchRequest *req;
+	GError *error = NULL;
+	guint32 flags_u;
+	gsize n;
+	gsize i;
+
+	g_variant_get (parameters, "(@a(oa{sa{sv}})u@a{sv})", &updates, &flags_u, &args);
+
+	if (   !nm_settings_connection_check_update2_flags (flags_u, &error)
+	    || !_check_no_args (args, &error)) {
+		g_dbus_method_invocation_take_error (invocation, error);
+		return;
+	}
+
+	n = g_variant_n_children (updates);
+	if (n == 0) {
+		GVariantBuilder result;
+
+		g_variant_builder_init (&result, G_VARIANT_TYPE_VARDICT);
+		g_dbus_method_invocation_return_value (invocation,
+		                                       g_variant_new ("(a{sv})", &result));
+		return;
+	}
+
+	subject = nm_auth_subject_new_unix_process_from_context (invocation);
+	if (!subject) {
+		g_dbus_method_invocation_return_error_literal (invocation,
+		                                               NM_SETTINGS_ERROR,
+		                                               NM_SETTINGS_ERROR_PERMISSION_DENIED,
+		                                               NM_UTILS_ERROR_MSG_REQ_UID_UKNOWN);
+		return;
+	}
+
+	req = _batch_request_new (subject, TRUE, flags_u);
+	seen = g_hash_table_new (nm_direct_hash, NULL);
+
+	/* validate all updates before touching anything. */
+	for (i = 0; i < n; i++) {
+		gs_unref_variant GVariant *settings = NULL;
+		gs_unref_object NMConnection *new_connection = NULL;
+		NMSettingsConnection *sett_conn;
+		NMConnection *old_connection;
+		const char *path;
+
+		g_variant_get_child (updates, i, "(&o@a{sa{sv}})", &path, &settings);
+
+		sett_conn = nm_settings_get_connection_by_path (self, path);
+		if (!sett_conn) {
+			error = g_error_new (NM_SETTINGS_ERROR,
+			                     NM_SETTINGS_ERROR_INVALID_ARGUMENTS,
+			                     "unknown profile %s", path);
+			goto fail;
+		}
+		if (!g_hash_table_add (seen, sett_conn)) {
+			error = g_error_new (NM_SETTINGS_ERROR,
+			                     NM_SETTINGS_ERROR_INVALID_ARGUMENTS,
+			                     "profile %s is updated more than once", path);
+			goto fail;
+		}
+
+		old_connection = nm_settings_connection_get_connection (sett_conn);
+
+		if (g_variant_n_children (settings) > 0) {
+			new_connection = _nm_simple_connection_new_from_dbus (settings,
+			                                                        NM_SETTING_PARSE_FLAGS_STRICT
+			                                                      | NM_SETTING_PARSE_FLAGS_NORMALIZE,
+			                                                      &error);
+			if (   !new_connection
+			    || !nm_connection_verify_secrets (new_connection, &error))
+				goto fail;
+		}
+
+		/* The caller must be allowed to see the existing profile (like
+		 * for Update2()) and you can't make a connection invisible to
+		 * yourself. */
+		if (   !nm_auth_is_subject_in_acl_set_error (old_connection,
+		                                             subject,
+		                                             NM_SETTINGS_ERROR,
+		                                             NM_SETTINGS_ERROR_PERMISSION_DENIED,
+		                                             &error)
+		    || (   new_connection
+		        && !nm_auth_is_subject_in_acl_set_error (new_connection,
+		                                                 subject,
+		                                                 NM_SETTINGS_ERROR,
+		                                                 NM_SETTINGS_ERROR_PERMISSION_DENIED,
+		                                                 &error)))
+			goto fail;
+
+		_batch_request_add_permission (req,
+		                               nm_settings_connection_get_update_modify_permission (old_connection,
+		                                                                                    new_connection ?: old_connection));
+
+		g_ptr_array_add (req->sett_conns, g_object_ref (sett_conn));
+		g_ptr_array_add (req->connections, g_steal_pointer (&new_connection));
+	}
+
+	_batch_request_start (self, invocation, req);
+	return;
+
+fail:
+	g_prefix_error (&error, "profile #%u: ", (guint) i);
+	_batch_request_free (req);
+	g_dbus_method_invocation_take_error (invocation, error);
 }
 
 /*****************************************************************************/
@@ -3797,6 +4383,8 @@ nm_settings_init (NMSettings *self)
 	priv->sce_idx = g_hash_table_new_full (nm_pstr_hash, nm_pstr_equal,
 	                                       NULL, (GDestroyNotify) _sett_conn_entry_free);
 
+	nm_sett_util_autoconnect_idx_init (&priv->autoconnect_idx);
+
 	priv->config = g_object_ref (nm_config_get ());
 
 	priv->agent_mgr = g_object_ref (nm_agent_manager_get ());
@@ -3867,6 +4455,8 @@ finalize (GObject *object)
 
 	nm_clear_pointer (&priv->sce_idx, g_hash_table_destroy);
 
+	nm_sett_util_autoconnect_idx_clear (&priv->autoconnect_idx);
+
 	g_slist_free_full (priv->unmanaged_specs, g_free);
 	g_slist_free_full (priv->unrecognized_specs, g_free);
 
@@ -3973,6 +4563,35 @@ static const NMDBusInterfaceInfoExtended interface_info_settings = {
 				),
 				.handle = impl_settings_add_connection2,
 			),
+			NM_DEFINE_DBUS_METHOD_INFO_EXTENDED (
+				NM_DEFINE_GDBUS_METHOD_INFO_INIT (
+					"AddConnections",
+					.in_args = NM_DEFINE_GDBUS_ARG_INFOS (
+						NM_DEFINE_GDBUS_ARG_INFO ("settings", "aa{sa{sv}}"),
+						NM_DEFINE_GDBUS_ARG_INFO ("flags",    "u"),
+						NM_DEFINE_GDBUS_ARG_INFO ("args",     "a{sv}"),
+					),
+					.out_args = NM_DEFINE_GDBUS_ARG_INFOS (
+						NM_DEFINE_GDBUS_ARG_INFO ("paths",  "ao"),
+						NM_DEFINE_GDBUS_ARG_INFO ("result", "a{sv}"),
+					),
+				),
+				.handle = impl_settings_add_connections,
+			),
+			NM_DEFINE_DBUS_METHOD_INFO_EXTENDED (
+				NM_DEFINE_GDBUS_METHOD_INFO_INIT (
+					"UpdateConnections",
+					.in_args = NM_DEFINE_GDBUS_ARG_INFOS (
+						NM_DEFINE_GDBUS_ARG_INFO ("updates", "a(oa{sa{sv}})"),
+						NM_DEFINE_GDBUS_ARG_INFO ("flags",   "u"),
+						NM_DEFINE_GDBUS_ARG_INFO ("args",    "a{sv}"),
+					),
+					.out_args = NM_DEFINE_GDBUS_ARG_INFOS (
+						NM_DEFINE_GDBUS_ARG_INFO ("result", "a{sv}"),
+					),
+				),
+				.handle = impl_settings_update_connections,
+			),
 			NM_DEFINE_DBUS_METHOD_INFO_EXTENDED (
 				NM_DEFINE_GDBUS_METHOD_INFO_INIT (
 					"LoadConnections",
@@ -41,19 +41,40 @@ struct _shvarLine {
 	 * 3) like 2, but if the value was deleted via svSetValue(), the entry is not removed,
 	 *   but only marked for deletion. That is done by clearing @line but preserving
 	 *   @key/@key_with_prefix.
+	 *
+	 * For lines that were read from file, @line and @key_with_prefix point into the
+	 * arena of the shvarFile and are not allocated separately. Use _str_free()
+	 * to release them.
 	 * */
 	char *line;
 	const char *key;
 	char *key_with_prefix;
+
+	/* if unescaping @line requires to allocate a new string, the result
+	 * is cached here by svGetValue(). It is cleared whenever @line changes. */
+	char *line_unescaped;
 };
 
 typedef struct _shvarLine shvarLine;
 
 struct _shvarFile {
 	char      *fileName;
+
+	/* the file content as read by svOpenFile(). The lines are split
+	 * in place and the shvarLine instances point into this buffer. */
+	char      *arena;
+	gsize      arena_len;
+
+	/* index of the lines with a key. For each key, it contains
+	 * the last line in @lst_head, which is the one that matters. */
+	GHashTable *lst_idx;
+
 	int        fd;
 	CList      lst_head;
 	gboolean   modified;
+
+	/* whether a key is assigned on more than one line. */
+	bool       has_duplicate_keys:1;
 };
 
 /*****************************************************************************/
@@ -603,18 +624,61 @@ out_error:
 
 /*****************************************************************************/
 
+static guint
+_line_key_hash (gconstpointer ptr)
+{
+	return nm_str_hash (((const shvarLine *) ptr)->key);
+}
+
+static gboolean
+_line_key_equal (gconstpointer a, gconstpointer b)
+{
+	return nm_streq (((const shvarLine *) a)->key,
+	                 ((const shvarLine *) b)->key);
+}
+
 static shvarFile *
-svFile_new (const char *name)
+svFile_new (const char *name, char *arena_take, gsize arena_len)
 {
 	shvarFile *s;
 
 	s = g_slice_new0 (shvarFile);
 	s->fd = -1;
 	s->fileName = g_strdup (name);
+	s->arena = arena_take;
+	s->arena_len = arena_len;
+	s->lst_idx = g_hash_table_new (_line_key_hash, _line_key_equal);
 	c_list_init (&s->lst_head);
 	return s;
 }
 
+static void
+_str_free (const shvarFile *s, char *str)
+{
+	/* strings that point into the arena are owned by the arena. Note that
+	 * the trailing NUL of the arena is a valid (empty) string too. */
+	if (   str
+	    && (   !s->arena
+	        || (uintptr_t) str <  (uintptr_t) s->arena
+	        || (uintptr_t) str >  (uintptr_t) &s->arena[s->arena_len]))
+		g_free (str);
+}
+
+static void
+_lst_idx_add (shvarFile *s, shvarLine *line)
+{
+	nm_assert (line->key);
+
+	if (!g_hash_table_add (s->lst_idx, line))
+		s->has_duplicate_keys = TRUE;
+}
+
+static shvarLine *
+_lst_idx_lookup (shvarFile *s, const char *key)
+{
+	return g_hash_table_lookup (s->lst_idx, &((const shvarLine) { .key = key }));
+}
+
 const char *
 svFileGetName (const shvarFile *s)
 {
@@ -664,12 +728,15 @@ ASSERT_shvarLine (const shvarLine *line)
 }
 
 static shvarLine *
-line_new_parse (const char *value, gsize len)
+line_new_parse (char *value, gsize len)
 {
 	shvarLine *line;
 	gsize k, e;
 
+	/* @value points into the arena and is terminated at @len. The
+	 * line is split in place, so that no strings need to be cloned. */
 	nm_assert (value);
+	nm_assert (value[len] == '\0');
 
 	line = g_slice_new0 (shvarLine);
 	c_list_init (&line->lst);
@@ -683,8 +750,9 @@ line_new_parse (const char *value, gsize len)
 			for (e = k + 1; e < len; e++) {
 				if (value[e] == '=') {
 					nm_assert (_shell_is_name (&value[k], e - k));
-					line->line = g_strndup (&value[e + 1], len - e - 1);
-					line->key_with_prefix = g_strndup (value, e);
+					value[e] = '\0';
+					line->line = &value[e + 1];
+					line->key_with_prefix = value;
 					line->key = &line->key_with_prefix[k];
 					ASSERT_shvarLine (line);
 					return line;
@@ -696,7 +764,7 @@ line_new_parse (const char *value, gsize len)
 		}
 		break;
 	}
-	line->line = g_strndup (value, len);
+	line->line = value;
 	ASSERT_shvarLine (line);
 	return line;
 }
@@ -719,10 +787,21 @@ line_new_build (const char *key, const char *value)
 }
 
 static gboolean
-line_set (shvarLine *line, const char *value)
+line_clear_value (const shvarFile *s, shvarLine *line)
+{
+	nm_clear_g_free (&line->line_unescaped);
+	if (!line->line)
+		return FALSE;
+	_str_free (s, g_steal_pointer (&line->line));
+	return TRUE;
+}
+
+static gboolean
+line_set (const shvarFile *s, shvarLine *line, const char *value)
 {
 	char *value_escaped = NULL;
 	gboolean changed = FALSE;
+	char *line_new;
 
 	ASSERT_shvarLine (line);
 	nm_assert (line->key);
@@ -736,25 +815,27 @@ line_set (shvarLine *line, const char *value)
 
 	value = svEscape (value, &value_escaped);
 
-	if (line->line) {
-		if (nm_streq (value, line->line)) {
-			g_free (value_escaped);
-			return changed;
-		}
-		g_free (line->line);
+	if (   line->line
+	    && nm_streq (value, line->line)) {
+		g_free (value_escaped);
+		return changed;
 	}
 
-	line->line = value_escaped ?: g_strdup (value);
+	/* @value might be the cached line_unescaped. Clone it before
+	 * clearing the old value. */
+	line_new = value_escaped ?: g_strdup (value);
+	line_clear_value (s, line);
+	line->line = line_new;
 	ASSERT_shvarLine (line);
 	return TRUE;
 }
 
 static void
-line_free (shvarLine *line)
+line_free (const shvarFile *s, shvarLine *line)
 {
 	ASSERT_shvarLine (line);
-	g_free (line->line);
-	g_free (line->key_with_prefix);
+	line_clear_value (s, line);
+	_str_free (s, line->key_with_prefix);
 	c_list_unlink_stale (&line->lst);
 	g_slice_free (shvarLine, line);
 }
@@ -772,7 +853,8 @@ svOpenFileInternal (const char *name, gboolean create, GError **error)
 	gboolean closefd = FALSE;
 	int errsv = 0;
 	gs_free char *arena = NULL;
-	const char *p, *q;
+	gsize arena_len;
+	char *p, *q;
 	gs_free_error GError *local = NULL;
 	nm_auto_close int fd = -1;
 
@@ -789,7 +871,7 @@ svOpenFileInternal (const char *name, gboolean create, GError **error)
 
 	if (fd < 0) {
 		if (create)
-			return svFile_new (name);
+			return svFile_new (name, NULL, 0);
 
 		g_set_error (error, G_FILE_ERROR, g_file_error_from_errno (errsv),
 		             "Could not read file '%s': %s",
@@ -802,11 +884,11 @@ svOpenFileInternal (const char *name, gboolean create, GError **error)
 	                               10 * 1024 * 1024,
 	                               NM_UTILS_FILE_GET_CONTENTS_FLAG_NONE,
 	                               &arena,
-	                               NULL,
+	                               &arena_len,
 	                               NULL,
 	                               &local)) {
 		if (create)
-			return svFile_new (name);
+			return svFile_new (name, NULL, 0);
 
 		g_set_error (error, G_FILE_ERROR,
 		             local->domain == G_FILE_ERROR ? local->code : G_FILE_ERROR_FAILED,
@@ -815,12 +897,22 @@ svOpenFileInternal (const char *name, gboolean create, GError **error)
 		return NULL;
 	}
 
-	s = svFile_new (name);
+	s = svFile_new (name, g_steal_pointer (&arena), arena_len);
+
+	for (p = s->arena; p; p = q) {
+		shvarLine *line;
+
+		q = strchr (p, '\n');
+		if (q)
+			*(q++) = '\0';
+		else if (!p[0])
+			break;
 
-	for (p = arena; (q = strchr (p, '\n')) != NULL; p = q + 1)
-		c_list_link_tail (&s->lst_head, &line_new_parse (p, q - p)->lst);
-	if (p[0])
-		c_list_link_tail (&s->lst_head, &line_new_parse (p, strlen (p))->lst);
+		line = line_new_parse (p, strlen (p));
+		c_list_link_tail (&s->lst_head, &line->lst);
+		if (line->key)
+			_lst_idx_add (s, line);
+	}
 
 	/* closefd is set if we opened the file read-only, so go ahead and
 	 * close it, because we can't write to it anyway */
@@ -1023,24 +1115,22 @@ svFindFirstKeyWithPrefix (shvarFile *s, const char *key_prefix)
 /*****************************************************************************/
 
 static const char *
-_svGetValue (shvarFile *s, const char *key, char **to_free)
+_svGetValue (shvarFile *s, const char *key, gboolean cache_unescaped, char **to_free)
 {
-	CList *current;
-	const shvarLine *line, *l;
+	shvarLine *line;
 	const char *v;
 
 	nm_assert (s);
 	nm_assert (_shell_is_name (key, -1));
 	nm_assert (to_free);
 
-	line = NULL;
-	c_list_for_each (current, &s->lst_head) {
-		l = c_list_entry (current, shvarLine, lst);
-		if (l->key && nm_streq (l->key, key))
-			line = l;
-	}
+	line = _lst_idx_lookup (s, key);
 
 	if (line && line->line) {
+		if (line->line_unescaped) {
+			*to_free = NULL;
+			return line->line_unescaped;
+		}
 		v = svUnescape (line->line, to_free);
 		if (!v) {
 			/* a wrongly quoted value is treated like the empty string.
@@ -1049,6 +1139,12 @@ _svGetValue (shvarFile *s, const char *key, char **to_free)
 			nm_assert (!*to_free);
 			return "";
 		}
+		if (   cache_unescaped
+		    && *to_free) {
+			/* the reader looks up the same keys repeatedly. Keep the
+			 * unescaped value, which is owned by @s from now on. */
+			line->line_unescaped = g_steal_pointer (to_free);
+		}
 		return v;
 	}
 	*to_free = NULL;
@@ -1068,7 +1164,7 @@ svGetValue (shvarFile *s, const char *key, char **to_free)
 	g_return_val_if_fail (key, NULL);
 	g_return_val_if_fail (to_free, NULL);
 
-	return _svGetValue (s, key, to_free);
+	return _svGetValue (s, key, TRUE, to_free);
 }
 
 /* Returns the value for key. The value is either owned by @s
@@ -1086,7 +1182,7 @@ svGetValueStr (shvarFile *s, const char *key, char **to_free)
 	g_return_val_if_fail (key, NULL);
 	g_return_val_if_fail (to_free, NULL);
 
-	value = _svGetValue (s, key, to_free);
+	value = _svGetValue (s, key, TRUE, to_free);
 	if (!value || !value[0]) {
 		nm_assert (!*to_free);
 		return NULL;
@@ -1109,7 +1205,7 @@ svGetValue_cp (shvarFile *s, const char *key)
 	g_return_val_if_fail (s, NULL);
 	g_return_val_if_fail (key, NULL);
 
-	value = _svGetValue (s, key, &to_free);
+	value = _svGetValue (s, key, FALSE, &to_free);
 	if (!value) {
 		nm_assert (!to_free);
 		return NULL;
@@ -1133,7 +1229,7 @@ svGetValueStr_cp (shvarFile *s, const char *key)
 	g_return_val_if_fail (s, NULL);
 	g_return_val_if_fail (key, NULL);
 
-	value = _svGetValue (s, key, &to_free);
+	value = _svGetValue (s, key, FALSE, &to_free);
 	if (!value || !value[0]) {
 		nm_assert (!to_free);
 		return NULL;
@@ -1156,7 +1252,7 @@ svGetValueBoolean (shvarFile *s, const char *key, int fallback)
 	gs_free char *to_free = NULL;
 	const char *value;
 
-	value = _svGetValue (s, key, &to_free);
+	value = _svGetValue (s, key, FALSE, &to_free);
 	return svParseBoolean (value, fallback);
 }
 
@@ -1178,7 +1274,7 @@ svGetValueInt64 (shvarFile *s, const char *key, guint base, gint64 min, gint64 m
 	gint64 result;
 	int errsv;
 
-	value = _svGetValue (s, key, &to_free);
+	value = _svGetValue (s, key, FALSE, &to_free);
 	if (!value) {
 		nm_assert (!to_free);
 		/* indicate that the key does not exist (or has a syntax error
@@ -1206,7 +1302,7 @@ svGetValueEnum (shvarFile *s, const char *key,
 	gs_free char *err_token = NULL;
 	int value;
 
-	svalue = _svGetValue (s, key, &to_free);
+	svalue = _svGetValue (s, key, FALSE, &to_free);
 	if (!svalue) {
 		/* don't touch out_value. The caller is supposed
 		 * to initialize it with the default value. */
@@ -1242,7 +1338,7 @@ svUnsetAll (shvarFile *s, SvKeyType match_key_type)
 			continue;
 
 		if (_svKeyMatchesType (line->key, match_key_type)) {
-			if (nm_clear_g_free (&line->line)) {
+			if (line_clear_value (s, line)) {
 				ASSERT_shvarLine (line);
 				changed = TRUE;
 			}
@@ -1268,32 +1364,39 @@ svSetValue (shvarFile *s, const char *key, const char *value)
 
 	nm_assert (_shell_is_name (key, -1));
 
-	line = NULL;
-	c_list_for_each (current, &s->lst_head) {
-		l = c_list_entry (current, shvarLine, lst);
-		if (l->key && nm_streq (l->key, key)) {
-			if (line) {
+	line = _lst_idx_lookup (s, key);
+
+	if (   line
+	    && s->has_duplicate_keys) {
+		CList *safe;
+
+		c_list_for_each_safe (current, safe, &s->lst_head) {
+			l = c_list_entry (current, shvarLine, lst);
+			if (l == line)
+				break;
+			if (l->key && nm_streq (l->key, key)) {
 				/* if we find multiple entries for the same key, we can
-				 * delete all but the last. */
-				line_free (line);
+				 * delete all but the last. Only the last one is indexed. */
+				line_free (s, l);
 				changed = TRUE;
 			}
-			line = l;
 		}
 	}
 
 	if (!value) {
 		if (line) {
-			if (nm_clear_g_free (&line->line)) {
+			if (line_clear_value (s, line)) {
 				changed = TRUE;
 			}
 		}
 	} else {
 		if (!line) {
-			c_list_link_tail (&s->lst_head, &line_new_build (key, value)->lst);
+			line = line_new_build (key, value);
+			c_list_link_tail (&s->lst_head, &line->lst);
+			_lst_idx_add (s, line);
 			changed = TRUE;
 		} else {
-			if (line_set (line, value))
+			if (line_set (s, line, value))
 				changed = TRUE;
 		}
 	}
@@ -1443,7 +1546,9 @@ svCloseFile (shvarFile *s)
 	if (s->fd >= 0)
 		nm_close (s->fd);
 	g_free (s->fileName);
+	g_hash_table_destroy (s->lst_idx);
 	c_list_for_each_safe (current, safe, &s->lst_head)
-		line_free (c_list_entry (current, shvarLine, lst));
+		line_free (s, c_list_entry (current, shvarLine, lst));
+	g_free (s->arena);
 	g_slice_free (shvarFile, s);
 }
@@ -0,0 +1,141 @@
+// SPDX-License-Identifier: GPL-2.0+
+
+/* Benchmark for parsing ifcfg files.
+ *
+ * This is not a unit test. It repeatedly opens all ifcfg files from the
+ * test directory with svOpenFile() and looks up every key, the way the
+ * reader does when loading profiles. */
+
+#include "nm-default.h"
+
+#include "settings/plugins/ifcfg-rh/shvar.h"
+
+#include "nm-test-utils-core.h"
+
+#define TEST_IFCFG_DIR NM_BUILD_SRCDIR"/src/settings/plugins/ifcfg-rh/tests/network-scripts"
+
+NMTST_DEFINE ();
+
+static struct {
+	int iterations;
+} global_opt = {
+	.iterations = 200,
+};
+
+/*****************************************************************************/
+
+static GPtrArray *
+_collect_files (void)
+{
+	gs_free_error GError *error = NULL;
+	GPtrArray *filenames;
+	GDir *dir;
+	const char *item;
+
+	dir = g_dir_open (TEST_IFCFG_DIR, 0, &error);
+	g_assert_no_error (error);
+
+	filenames = g_ptr_array_new_with_free_func (g_free);
+	while ((item = g_dir_read_name (dir))) {
+		if (!g_str_has_prefix (item, "ifcfg-"))
+			continue;
+		if (g_str_has_suffix (item, ".cexpected"))
+			continue;
+		g_ptr_array_add (filenames, g_build_filename (TEST_IFCFG_DIR, item, NULL));
+	}
+	g_dir_close (dir);
+	return filenames;
+}
+
+static void
+bench_parse (const char *name, GPtrArray *filenames, guint iterations)
+{
+	gint64 ns;
+	guint n_keys = 0;
+	guint n_files = 0;
+	guint iter;
+	guint i;
+
+	ns = nm_utils_clock_gettime_ns (CLOCK_MONOTONIC);
+	for (iter = 0; iter < iterations; iter++) {
+		for (i = 0; i < filenames->len; i++) {
+			gs_unref_hashtable GHashTable *keys = NULL;
+			shvarFile *s;
+			GHashTableIter h_iter;
+			const char *key;
+
+			s = svOpenFile (filenames->pdata[i], NULL);
+			if (!s)
+				continue;
+
+			n_files++;
+			keys = svGetKeys (s, SV_KEY_TYPE_ANY);
+			if (keys) {
+				g_hash_table_iter_init (&h_iter, keys);
+				while (g_hash_table_iter_next (&h_iter, (gpointer *) &key, NULL)) {
+					gs_free char *to_free = NULL;
+
+					/* the reader usually looks up a key more than once
+					 * (for example via svGetValueBoolean() and svGetValueStr()). */
+					svGetValue (s, key, &to_free);
+					nm_clear_g_free (&to_free);
+					svGetValueStr (s, key, &to_free);
+					n_keys++;
+				}
+			}
+			svCloseFile (s);
+		}
+	}
+	ns = nm_utils_clock_gettime_ns (CLOCK_MONOTONIC) - ns;
+
+	g_print ("%-32s %8u files %8u keys %10.3f ms %12.1f files/s\n",
+	         name,
+	         n_files,
+	         n_keys,
+	         ns / 1000000.0,
+	         ns > 0 ? n_files * (1000000000.0 / ns) : 0.0);
+}
+
+/*****************************************************************************/
+
+static gboolean
+read_argv (int *argc, char ***argv)
+{
+	GOptionContext *context;
+	GOptionEntry options[] = {
+		{ "iterations", 'i', 0, G_OPTION_ARG_INT, &global_opt.iterations, "Number of iterations over all files (default: 200)", "N" },
+		{ 0 },
+	};
+	gs_free_error GError *error = NULL;
+
+	context = g_option_context_new (NULL);
+	g_option_context_set_summary (context, "Benchmark parsing ifcfg files.");
+	g_option_context_add_main_entries (context, options, NULL);
+
+	if (!g_option_context_parse (context, argc, argv, &error)) {
+		g_warning ("Error parsing command line arguments: %s", error->message);
+		g_option_context_free (context);
+		return FALSE;
+	}
+
+	g_option_context_free (context);
+	return TRUE;
+}
+
+int
+main (int argc, char **argv)
+{
+	gs_unref_ptrarray GPtrArray *filenames = NULL;
+
+	nmtst_init_with_logging (&argc, &argv, "WARN", "ALL");
+
+	if (!read_argv (&argc, &argv))
+		return 2;
+
+	filenames = _collect_files ();
+
+	bench_parse ("shvar: warm-up", filenames, 1);
+	bench_parse ("shvar: open and lookup", filenames, NM_MAX (global_opt.iterations, 0));
+
+	return EXIT_SUCCESS;
+}
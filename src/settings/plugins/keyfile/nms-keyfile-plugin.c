@@ -284,6 +284,7 @@ _load_file (NMSKeyfilePlugin *self,
 {
 	NMSKeyfilePluginPrivate *priv;
 	gs_unref_object NMConnection *connection = NULL;
+	NMSKeyfileStorage *storage;
 	NMTernary is_volatile_opt;
 	NMTernary is_nm_generated_opt;
 	NMTernary shadowed_owned_opt;
@@ -361,15 +362,17 @@ _load_file (NMSKeyfilePlugin *self,
 		return NULL;
 	}
 
-	return nms_keyfile_storage_new_connection (self,
-	                                           g_steal_pointer (&connection),
-	                                           full_filename,
-	                                           storage_type,
-	                                           is_nm_generated_opt,
-	                                           is_volatile_opt,
-	                                           shadowed_storage,
-	                                           shadowed_owned_opt,
-	                                           &st.st_mtim);
+	storage = nms_keyfile_storage_new_connection (self,
+	                                              g_steal_pointer (&connection),
+	                                              full_filename,
+	                                              storage_type,
+	                                              is_nm_generated_opt,
+	                                              is_volatile_opt,
+	                                              shadowed_storage,
+	                                              shadowed_owned_opt,
+	                                              &st.st_mtim);
+	nms_keyfile_storage_set_stat_id (storage, &st);
+	return storage;
 }
 
 static NMSKeyfileStorage *
@@ -394,11 +397,37 @@ _load_file_from_path (NMSKeyfilePlugin *self,
 	                   error);
 }
 
+typedef struct {
+	const char *dirname;
+	char *filename;
+	char *full_filename;
+	NMSKeyfileStorageType storage_type;
+
+	/* index into the array of files that are read by
+	 * nms_keyfile_reader_from_files(), or G_MAXUINT. */
+	guint file_data_idx;
+
+	/* nmmeta files are handled by _load_file(). */
+	bool is_nmmeta:1;
+
+	/* whether the file is unchanged since it was last loaded,
+	 * and the existing storage is kept. */
+	bool unchanged:1;
+} LoadDirEntry;
+
+static void
+_load_dir_entry_clear (gpointer data)
+{
+	LoadDirEntry *entry = data;
+
+	g_free (entry->filename);
+	g_free (entry->full_filename);
+}
+
 static void
-_load_dir (NMSKeyfilePlugin *self,
-           NMSKeyfileStorageType storage_type,
-           const char *dirname,
-           NMSettUtilStorages *storages)
+_load_dir_collect (NMSKeyfileStorageType storage_type,
+                   const char *dirname,
+                   GArray *entries)
 {
 	const char *filename;
 	GDir *dir;
@@ -408,27 +437,185 @@ _load_dir (NMSKeyfilePlugin *self,
 	if (!dir)
 		return;
 
-	dupl_filenames = g_hash_table_new_full (nm_str_hash, g_str_equal, NULL, g_free);
+	dupl_filenames = g_hash_table_new (nm_str_hash, g_str_equal);
 
 	while ((filename = g_dir_read_name (dir))) {
-		gs_unref_object NMSKeyfileStorage *storage = NULL;
+		LoadDirEntry *entry;
 
-		filename = g_strdup (filename);
-		if (!g_hash_table_add (dupl_filenames, (char *) filename))
+		if (g_hash_table_contains (dupl_filenames, filename))
 			continue;
 
-		storage = _load_file (self,
-		                      dirname,
-		                      filename,
-		                      storage_type,
-		                      NULL);
-		if (!storage)
+		g_array_set_size (entries, entries->len + 1);
+		entry = &g_array_index (entries, LoadDirEntry, entries->len - 1);
+		entry->dirname = dirname;
+		entry->filename = g_strdup (filename);
+		entry->storage_type = storage_type;
+		entry->file_data_idx = G_MAXUINT;
+
+		g_hash_table_add (dupl_filenames, entry->filename);
+
+		if (_ignore_filename (storage_type, filename)) {
+			entry->is_nmmeta = TRUE;
 			continue;
+		}
 
-		nm_sett_util_storages_add_take (storages, g_steal_pointer (&storage));
+		entry->full_filename = g_build_filename (dirname, filename, NULL);
 	}
 
 	g_dir_close (dir);
+}
+
+static void
+_load_dirs (NMSKeyfilePlugin *self,
+            NMSettUtilStorages *storages,
+            GHashTable *storages_unchanged)
+{
+	NMSKeyfilePluginPrivate *priv = NMS_KEYFILE_PLUGIN_GET_PRIVATE (self);
+	gs_unref_array GArray *entries = NULL;
+	gs_free NMSKeyfileReaderFileData *file_datas = NULL;
+	nm_auto_free_sett_util_profile_cache NMSettUtilProfileCache *cache = NULL;
+	gs_free char *cache_key = NULL;
+	guint n_file_datas = 0;
+	guint n_unchanged = 0;
+	guint n_cached = 0;
+	guint i;
+
+	entries = g_array_new (FALSE, TRUE, sizeof (LoadDirEntry));
+	g_array_set_clear_func (entries, _load_dir_entry_clear);
+
+	_load_dir_collect (NMS_KEYFILE_STORAGE_TYPE_RUN, priv->dirname_run, entries);
+	if (priv->dirname_etc)
+		_load_dir_collect (NMS_KEYFILE_STORAGE_TYPE_ETC, priv->dirname_etc, entries);
+	for (i = 0; priv->dirname_libs[i]; i++)
+		_load_dir_collect (NMS_KEYFILE_STORAGE_TYPE_LIB (i), priv->dirname_libs[i], entries);
+
+	/* The profile cache is for speeding up the start. Later reloads
+	 * only parse the files that changed compared to the existing storages,
+	 * and reading (and rewriting) the entire cache is not worth it.
+	 *
+	 * The result of parsing a keyfile depends on the profile directory
+	 * (for generating a UUID) and on the version of NetworkManager.
+	 *
+	 * The cache is persisted to NMSTATEDIR, so it must not contain profiles
+	 * from /run, which are gone after reboot. Also, it contains no secrets,
+	 * which means profiles with secrets are always parsed. */
+	if (c_list_is_empty (&priv->storages._storage_lst_head)) {
+		cache_key = g_strdup_printf ("%s,%s", VERSION, _get_plugin_dir (priv));
+		cache = nm_sett_util_profile_cache_load (NMS_KEYFILE_PROFILE_CACHE_FILE, cache_key);
+	}
+
+	/* Reading and parsing the profiles is the expensive part and is
+	 * independent of the plugin state. Skip files that didn't change
+	 * since they were loaded, and restore the profiles from the cache
+	 * or parse the files in parallel. Afterwards, create the storages in
+	 * directory order, exactly like loading the files one by one would. */
+	file_datas = g_new0 (NMSKeyfileReaderFileData, entries->len);
+	for (i = 0; i < entries->len; i++) {
+		LoadDirEntry *entry = &g_array_index (entries, LoadDirEntry, i);
+		NMSKeyfileReaderFileData *file_data;
+		NMSKeyfileStorage *storage_old;
+		struct stat st;
+		gboolean stat_valid;
+
+		if (entry->is_nmmeta)
+			continue;
+
+		/* if this fails, let the reader fail with a proper error message. */
+		stat_valid = nms_keyfile_utils_check_file_permissions (NMS_KEYFILE_FILETYPE_KEYFILE,
+		                                                       entry->full_filename,
+		                                                       &st,
+		                                                       NULL);
+
+		if (stat_valid) {
+			storage_old = nm_sett_util_storages_lookup_by_filename (&priv->storages, entry->full_filename);
+			if (   storage_old
+			    && nms_keyfile_storage_stat_id_unchanged (storage_old, &st)) {
+				/* the file is the same as when it was loaded or written
+				 * the last time. There is no need to read it again. */
+				g_hash_table_add (storages_unchanged, storage_old);
+				entry->unchanged = TRUE;
+				n_unchanged++;
+				continue;
+			}
+		}
+
+		entry->file_data_idx = n_file_datas++;
+		file_data = &file_datas[entry->file_data_idx];
+		file_data->full_filename = entry->full_filename;
+
+		if (   stat_valid
+		    && cache
+		    && entry->storage_type != NMS_KEYFILE_STORAGE_TYPE_RUN) {
+			file_data->st = st;
+			file_data->cache_entry = nm_sett_util_profile_cache_lookup_entry (cache, entry->full_filename, &st);
+			file_data->cache_add = TRUE;
+		}
+	}
+
+	nms_keyfile_reader_from_files (file_datas,
+	                               n_file_datas,
+	                               _get_plugin_dir (priv),
+	                               0);
+
+	for (i = 0; i < entries->len; i++) {
+		const LoadDirEntry *entry = &g_array_index (entries, LoadDirEntry, i);
+		NMSKeyfileReaderFileData *file_data;
+		NMSKeyfileStorage *storage;
+
+		if (entry->unchanged)
+			continue;
+
+		if (entry->is_nmmeta) {
+			storage = _load_file (self,
+			                      entry->dirname,
+			                      entry->filename,
+			                      entry->storage_type,
+			                      NULL);
+			if (storage)
+				nm_sett_util_storages_add_take (storages, storage);
+			continue;
+		}
+
+		file_data = &file_datas[entry->file_data_idx];
+
+		if (!file_data->connection) {
+			_LOGW ("load: \"%s\": failed to load connection: %s", entry->full_filename, file_data->error->message);
+			continue;
+		}
+
+		nm_assert (_nm_connection_verify (file_data->connection, NULL) == NM_SETTING_VERIFY_SUCCESS);
+		nm_assert (nm_utils_is_uuid (nm_connection_get_uuid (file_data->connection)));
+
+		if (file_data->from_cache) {
+			nm_sett_util_profile_cache_keep_entry (cache, file_data->cache_entry);
+			n_cached++;
+		} else if (file_data->cache_entry_new)
+			nm_sett_util_profile_cache_add_entry (cache, g_steal_pointer (&file_data->cache_entry_new));
+
+		storage = nms_keyfile_storage_new_connection (self,
+		                                              g_steal_pointer (&file_data->connection),
+		                                              entry->full_filename,
+		                                              entry->storage_type,
+		                                              file_data->is_nm_generated,
+		                                              file_data->is_volatile,
+		                                              file_data->shadowed_storage,
+		                                              file_data->shadowed_owned,
+		                                              &file_data->st.st_mtim);
+		nms_keyfile_storage_set_stat_id (storage, &file_data->st);
+		nm_sett_util_storages_add_take (storages, storage);
+	}
+
+	for (i = 0; i < n_file_datas; i++)
+		nms_keyfile_reader_file_data_clear (&file_datas[i]);
+
+	if (cache)
+		nm_sett_util_profile_cache_save (cache);
+
+	_LOGD ("load: %u files, %u parsed, %u from cache, %u unchanged",
+	       entries->len,
+	       n_file_datas - n_cached,
+	       n_cached,
+	       n_unchanged);
 
 #if NM_MORE_ASSERTS
 	{
@@ -447,6 +634,7 @@ _storages_consolidate (NMSKeyfilePlugin *self,
                        NMSettUtilStorages *storages_new,
                        gboolean replace_all,
                        GHashTable *storages_replaced,
+                       GHashTable *storages_unchanged,
                        NMSettingsPluginConnectionLoadCallback callback,
                        gpointer user_data)
 {
@@ -464,7 +652,8 @@ _storages_consolidate (NMSKeyfilePlugin *self,
 	c_list_init (&storages_deleted);
 
 	c_list_for_each_entry (storage_old, &priv->storages._storage_lst_head, parent._storage_lst)
-		storage_old->is_dirty = TRUE;
+		storage_old->is_dirty = !(   storages_unchanged
+		                          && g_hash_table_contains (storages_unchanged, storage_old));
 
 	c_list_for_each_entry_safe (storage_new, storage_safe, &storages_new->_storage_lst_head, parent._storage_lst) {
 		storage_old = nm_sett_util_storages_lookup_by_filename (&priv->storages, nms_keyfile_storage_get_filename (storage_new));
@@ -552,20 +741,21 @@ reload_connections (NMSettingsPlugin *plugin,
                     gpointer user_data)
 {
 	NMSKeyfilePlugin *self = NMS_KEYFILE_PLUGIN (plugin);
-	NMSKeyfilePluginPrivate *priv = NMS_KEYFILE_PLUGIN_GET_PRIVATE (self);
 	nm_auto_clear_sett_util_storages NMSettUtilStorages storages_new = NM_SETT_UTIL_STORAGES_INIT (storages_new, nms_keyfile_storage_destroy);
-	int i;
+	gs_unref_hashtable GHashTable *storages_unchanged = NULL;
 
-	_load_dir (self, NMS_KEYFILE_STORAGE_TYPE_RUN, priv->dirname_run, &storages_new);
-	if (priv->dirname_etc)
-		_load_dir (self, NMS_KEYFILE_STORAGE_TYPE_ETC, priv->dirname_etc, &storages_new);
-	for (i = 0; priv->dirname_libs[i]; i++)
-		_load_dir (self, NMS_KEYFILE_STORAGE_TYPE_LIB (i), priv->dirname_libs[i], &storages_new);
+	storages_unchanged = g_hash_table_new (nm_direct_hash, NULL);
+
+	/* only files that changed since they were last loaded are read again.
+	 * The storages of unchanged files are kept as they are, and no
+	 * events are emitted for them. */
+	_load_dirs (self, &storages_new, storages_unchanged);
 
 	_storages_consolidate (self,
 	                       &storages_new,
 	                       TRUE,
 	                       NULL,
+	                       storages_unchanged,
 	                       callback,
 	                       user_data);
 }
@@ -722,6 +912,7 @@ load_connections (NMSettingsPlugin *plugin,
 	                       &storages_new,
 	                       FALSE,
 	                       storages_replaced,
+	                       NULL,
 	                       callback,
 	                       user_data);
 }
@@ -819,6 +1010,7 @@ nms_keyfile_plugin_add_connection (NMSKeyfilePlugin *self,
 	                                              shadowed_storage,
 	                                              shadowed_owned ? NM_TERNARY_TRUE : NM_TERNARY_FALSE,
 	                                              nm_sett_util_stat_mtime (full_filename, FALSE, &mtime));
+	nms_keyfile_storage_update_stat_id (storage);
 
 	nm_sett_util_storages_add_take (&priv->storages, g_object_ref (storage));
 
@@ -940,6 +1132,7 @@ nms_keyfile_plugin_update_connection (NMSKeyfilePlugin *self,
 	storage->u.conn_data.is_volatile     = is_volatile;
 	storage->u.conn_data.stat_mtime      = *nm_sett_util_stat_mtime (full_filename, FALSE, &mtime);
 	storage->u.conn_data.shadowed_owned  = shadowed_owned;
+	nms_keyfile_storage_update_stat_id (storage);
 
 	*out_storage = g_object_ref (NM_SETTINGS_STORAGE (storage));
 	*out_connection = g_steal_pointer (&reread);
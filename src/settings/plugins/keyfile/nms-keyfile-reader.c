@@ -12,8 +12,15 @@
 #include "nm-keyfile-internal.h"
 
 #include "NetworkManagerUtils.h"
+#include "settings/nm-settings-utils.h"
 #include "nms-keyfile-utils.h"
 
+/* nms_keyfile_reader_from_files() reads profiles on worker threads. Hence,
+ * logging in this file may not assume to run on the main-thread. Indicate
+ * that by setting NM_THREAD_SAFE_ON_MAIN_THREAD to zero. */
+#undef NM_THREAD_SAFE_ON_MAIN_THREAD
+#define NM_THREAD_SAFE_ON_MAIN_THREAD 0
+
 /*****************************************************************************/
 
 static const char *
@@ -211,3 +218,167 @@ nms_keyfile_reader_from_file (const char *full_filename,
 	return connection;
 }
 
+/*****************************************************************************/
+
+/* below this number of files, starting threads is not worth it. */
+#define FROM_FILES_PARALLEL_MIN 32
+
+#define FROM_FILES_MAX_THREADS 8
+
+/* the plugin data of the keyfile entries in the profile cache. */
+#define FROM_FILES_CACHE_PLUGIN_DATA_TYPE_STR "(iimsi)"
+
+static gboolean
+_from_files_restore (NMSKeyfileReaderFileData *file_data)
+{
+	gs_unref_variant GVariant *plugin_data = NULL;
+	gs_unref_object NMConnection *connection = NULL;
+	gint32 is_nm_generated;
+	gint32 is_volatile;
+	gint32 shadowed_owned;
+
+	connection = nm_sett_util_profile_cache_entry_restore (file_data->cache_entry,
+	                                                       &plugin_data,
+	                                                       NULL);
+	if (!connection)
+		return FALSE;
+
+	if (!g_variant_is_of_type (plugin_data, G_VARIANT_TYPE (FROM_FILES_CACHE_PLUGIN_DATA_TYPE_STR)))
+		return FALSE;
+
+	g_variant_get (plugin_data,
+	               FROM_FILES_CACHE_PLUGIN_DATA_TYPE_STR,
+	               &is_nm_generated,
+	               &is_volatile,
+	               &file_data->shadowed_storage,
+	               &shadowed_owned);
+	file_data->connection = g_steal_pointer (&connection);
+	file_data->is_nm_generated = is_nm_generated;
+	file_data->is_volatile = is_volatile;
+	file_data->shadowed_owned = shadowed_owned;
+	file_data->from_cache = TRUE;
+	return TRUE;
+}
+
+static void
+_from_files_read (NMSKeyfileReaderFileData *file_data,
+                  const char *profile_dir)
+{
+	nm_assert (file_data->full_filename && file_data->full_filename[0] == '/');
+	nm_assert (!file_data->connection);
+	nm_assert (!file_data->error);
+	nm_assert (!file_data->cache_entry_new);
+
+	if (   file_data->cache_entry
+	    && _from_files_restore (file_data))
+		return;
+
+	file_data->connection = nms_keyfile_reader_from_file (file_data->full_filename,
+	                                                      profile_dir,
+	                                                      &file_data->st,
+	                                                      &file_data->is_nm_generated,
+	                                                      &file_data->is_volatile,
+	                                                      &file_data->shadowed_storage,
+	                                                      &file_data->shadowed_owned,
+	                                                      &file_data->error);
+	nm_assert ((!!file_data->connection) != (!!file_data->error));
+
+	if (   file_data->connection
+	    && file_data->cache_add) {
+		file_data->cache_entry_new = nm_sett_util_profile_cache_entry_new (file_data->full_filename,
+		                                                                   &file_data->st,
+		                                                                   file_data->connection,
+		                                                                   g_variant_new (FROM_FILES_CACHE_PLUGIN_DATA_TYPE_STR,
+		                                                                                  (gint32) file_data->is_nm_generated,
+		                                                                                  (gint32) file_data->is_volatile,
+		                                                                                  file_data->shadowed_storage,
+		                                                                                  (gint32) file_data->shadowed_owned));
+	}
+}
+
+static void
+_from_files_thread_func (gpointer data, gpointer user_data)
+{
+	_from_files_read (data, user_data);
+}
+
+/**
+ * nms_keyfile_reader_from_files:
+ * @file_datas: the files to read.
+ * @n_file_datas: the number of files.
+ * @profile_dir: see nms_keyfile_reader_from_file().
+ * @max_threads: the maximum number of worker threads. 0 selects a suitable
+ *   number based on the number of CPUs. 1 reads all files on the calling
+ *   thread.
+ *
+ * Reads all files like nms_keyfile_reader_from_file() and sets the output
+ * fields of each @file_datas entry. Entries that already have a connection
+ * are skipped. Profiles are restored from their profile cache entry
+ * instead of reading the file, if possible, and new cache entries are
+ * created as requested. Reading, parsing and normalizing the profiles
+ * (and converting them from and to cache entries) is independent of any
+ * global state, so with many files the work is distributed to a pool of
+ * threads. The function only returns
+ * after all files are read. The returned connections are not shared with
+ * the worker threads anymore.
+ */
+void
+nms_keyfile_reader_from_files (NMSKeyfileReaderFileData *file_datas,
+                               guint n_file_datas,
+                               const char *profile_dir,
+                               guint max_threads)
+{
+	GThreadPool *pool;
+	guint n_todo;
+	guint i;
+
+	nm_assert (file_datas || n_file_datas == 0);
+
+	if (max_threads == 0)
+		max_threads = NM_CLAMP (g_get_num_processors (), 1u, (guint) FROM_FILES_MAX_THREADS);
+
+	for (i = 0, n_todo = 0; i < n_file_datas; i++) {
+		if (!file_datas[i].connection)
+			n_todo++;
+	}
+
+	if (   max_threads <= 1
+	    || n_todo < FROM_FILES_PARALLEL_MIN) {
+		for (i = 0; i < n_file_datas; i++) {
+			if (!file_datas[i].connection)
+				_from_files_read (&file_datas[i], profile_dir);
+		}
+		return;
+	}
+
+	pool = g_thread_pool_new (_from_files_thread_func,
+	                          (gpointer) profile_dir,
+	                          max_threads,
+	                          TRUE,
+	                          NULL);
+	if (!pool) {
+		/* failing to create an exclusive pool is not fatal. */
+		for (i = 0; i < n_file_datas; i++) {
+			if (!file_datas[i].connection)
+				_from_files_read (&file_datas[i], profile_dir);
+		}
+		return;
+	}
+
+	for (i = 0; i < n_file_datas; i++) {
+		if (!file_datas[i].connection)
+			g_thread_pool_push (pool, &file_datas[i], NULL);
+	}
+
+	/* wait for all queued files to be read. */
+	g_thread_pool_free (pool, FALSE, TRUE);
+}
+
+void
+nms_keyfile_reader_file_data_clear (NMSKeyfileReaderFileData *file_data)
+{
+	g_clear_object (&file_data->connection);
+	g_clear_error (&file_data->error);
+	nm_clear_g_free (&file_data->shadowed_storage);
+	nm_clear_pointer (&file_data->cache_entry_new, g_variant_unref);
+}
@@ -7,6 +7,8 @@
 #ifndef __NMS_KEYFILE_READER_H__
 #define __NMS_KEYFILE_READER_H__
 
+#include <sys/stat.h>
+
 #include "nm-connection.h"
 
 NMConnection *nms_keyfile_reader_from_keyfile (GKeyFile *key_file,
@@ -16,8 +18,6 @@ NMConnection *nms_keyfile_reader_from_keyfile (GKeyFile *key_file,
                                                gboolean verbose,
                                                GError **error);
 
-struct stat;
-
 NMConnection *nms_keyfile_reader_from_file (const char *full_filename,
                                             const char *profile_dir,
                                             struct stat *out_stat,
@@ -27,4 +27,41 @@ NMConnection *nms_keyfile_reader_from_file (const char *full_filename,
                                             NMTernary *out_shadowed_owned,
                                             GError **error);
 
+typedef struct {
+	/* input */
+	const char *full_filename;
+
+	/* input (optional): the entry of the profile cache that matches the
+	 * current @st, see nm_sett_util_profile_cache_lookup_entry(). If the
+	 * profile can be restored from it, the file is not read. */
+	GVariant *cache_entry;
+
+	/* input: whether to create @cache_entry_new for a profile
+	 * that was read from file. */
+	bool cache_add:1;
+
+	/* output: whether the profile was restored from @cache_entry. */
+	bool from_cache:1;
+
+	/* output, see nms_keyfile_reader_from_file(). */
+	NMConnection *connection;
+	GError *error;
+	struct stat st;
+	NMTernary is_nm_generated;
+	NMTernary is_volatile;
+	char *shadowed_storage;
+	NMTernary shadowed_owned;
+
+	/* output: the new cache entry, if @cache_add was requested and
+	 * the profile can be cached. See nm_sett_util_profile_cache_add_entry(). */
+	GVariant *cache_entry_new;
+} NMSKeyfileReaderFileData;
+
+void nms_keyfile_reader_from_files (NMSKeyfileReaderFileData *file_datas,
+                                    guint n_file_datas,
+                                    const char *profile_dir,
+                                    guint max_threads);
+
+void nms_keyfile_reader_file_data_clear (NMSKeyfileReaderFileData *file_data);
+
 #endif /* __NMS_KEYFILE_READER_H__ */
@@ -62,6 +62,55 @@ nms_keyfile_storage_steal_connection (NMSKeyfileStorage *self)
 	       : g_steal_pointer (&self->u.conn_data.connection);
 }
 
+void
+nms_keyfile_storage_set_stat_id (NMSKeyfileStorage *self,
+                                 const struct stat *st)
+{
+	nm_assert (NMS_IS_KEYFILE_STORAGE (self));
+	nm_assert (!self->is_meta_data);
+
+	if (!st) {
+		self->u.conn_data.stat_id_valid = FALSE;
+		return;
+	}
+
+	self->u.conn_data.stat_id.dev   = st->st_dev;
+	self->u.conn_data.stat_id.ino   = st->st_ino;
+	self->u.conn_data.stat_id.size  = st->st_size;
+	self->u.conn_data.stat_id.mtime = st->st_mtim;
+	self->u.conn_data.stat_id.ctime = st->st_ctim;
+	self->u.conn_data.stat_id_valid = TRUE;
+}
+
+void
+nms_keyfile_storage_update_stat_id (NMSKeyfileStorage *self)
+{
+	struct stat st;
+
+	nms_keyfile_storage_set_stat_id (self,
+	                                 stat (nms_keyfile_storage_get_filename (self), &st) == 0
+	                                 ? &st
+	                                 : NULL);
+}
+
+gboolean
+nms_keyfile_storage_stat_id_unchanged (const NMSKeyfileStorage *self,
+                                       const struct stat *st)
+{
+	nm_assert (NMS_IS_KEYFILE_STORAGE (self));
+	nm_assert (st);
+
+	return    !self->is_meta_data
+	       && self->u.conn_data.stat_id_valid
+	       && self->u.conn_data.stat_id.dev           == st->st_dev
+	       && self->u.conn_data.stat_id.ino           == st->st_ino
+	       && self->u.conn_data.stat_id.size          == st->st_size
+	       && self->u.conn_data.stat_id.mtime.tv_sec  == st->st_mtim.tv_sec
+	       && self->u.conn_data.stat_id.mtime.tv_nsec == st->st_mtim.tv_nsec
+	       && self->u.conn_data.stat_id.ctime.tv_sec  == st->st_ctim.tv_sec
+	       && self->u.conn_data.stat_id.ctime.tv_nsec == st->st_ctim.tv_nsec;
+}
+
 /*****************************************************************************/
 
 static int
@@ -6,6 +6,8 @@
 #ifndef __NMS_KEYFILE_STORAGE_H__
 #define __NMS_KEYFILE_STORAGE_H__
 
+#include <sys/stat.h>
+
 #include "c-list/src/c-list.h"
 #include "settings/nm-settings-storage.h"
 #include "nms-keyfile-utils.h"
@@ -56,6 +58,17 @@ typedef struct {
 			 * multiple files with the same UUID, then the newer file gets preferred. */
 			struct timespec stat_mtime;
 
+			/* the identity of the file (from stat()), when it was last read or
+			 * written. On reload, files that didn't change according to these
+			 * fields are not read again. Only valid if stat_id_valid is set. */
+			struct {
+				dev_t dev;
+				ino_t ino;
+				off_t size;
+				struct timespec mtime;
+				struct timespec ctime;
+			} stat_id;
+
 			/* these flags are only relevant for storages with %NMS_KEYFILE_STORAGE_TYPE_RUN
 			 * (and non-metadata). This is to persist and reload these settings flags to
 			 * /run.
@@ -71,6 +84,8 @@ typedef struct {
 			 * shadowing profile: a owned profile will also be deleted. */
 			bool shadowed_owned:1;
 
+			bool stat_id_valid:1;
+
 		} conn_data;
 
 		/* the content from the .nmmeta file. Note that the nmmeta file has the UUID
@@ -125,6 +140,14 @@ void nms_keyfile_storage_copy_content (NMSKeyfileStorage *dst,
 
 NMConnection *nms_keyfile_storage_steal_connection (NMSKeyfileStorage *storage);
 
+void nms_keyfile_storage_set_stat_id (NMSKeyfileStorage *self,
+                                      const struct stat *st);
+
+void nms_keyfile_storage_update_stat_id (NMSKeyfileStorage *self);
+
+gboolean nms_keyfile_storage_stat_id_unchanged (const NMSKeyfileStorage *self,
+                                                const struct stat *st);
+
 /*****************************************************************************/
 
 static inline const char *
@@ -8,6 +8,9 @@
 
 #include "NetworkManagerUtils.h"
 
+/* the cache of parsed profiles, see nm_sett_util_profile_cache_load(). */
+#define NMS_KEYFILE_PROFILE_CACHE_FILE NMSTATEDIR "/keyfile-profile-cache"
+
 typedef enum {
 	NMS_KEYFILE_FILETYPE_KEYFILE,
 	NMS_KEYFILE_FILETYPE_NMMETA,
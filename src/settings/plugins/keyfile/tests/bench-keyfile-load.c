@@ -0,0 +1,260 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Copyright (C) 2019 Red Hat, Inc.
+ */
+
+/* Benchmark for loading many keyfiles at startup.
+ *
+ * This is not a unit test. It writes a large number of synthetic keyfile
+ * profiles to a temporary directory and measures how long it takes to read
+ * and parse them with nms_keyfile_reader_from_files(), once on the calling
+ * thread and once with the worker pool.
+ *
+ * Then it does the same with the profile cache, like the keyfile plugin at
+ * startup: first with an empty cache, which parses all files and writes the
+ * cache, then with the written cache. These runs include loading and saving
+ * the cache file and the stat() of each file. Compare the run with the
+ * written cache to the parallel run without cache. */
+
+#include "nm-default.h"
+
+#include <unistd.h>
+
+#include "nm-core-internal.h"
+
+#include "settings/nm-settings-utils.h"
+#include "settings/plugins/keyfile/nms-keyfile-reader.h"
+
+#include "nm-test-utils-core.h"
+
+NMTST_DEFINE ();
+
+static struct {
+	int files;
+	int threads;
+} global_opt = {
+	.files = 10000,
+};
+
+/*****************************************************************************/
+
+static char *
+_write_profiles (guint n, char ***out_filenames)
+{
+	gs_free_error GError *error = NULL;
+	char **filenames;
+	char *dirname;
+	guint i;
+
+	dirname = g_dir_make_tmp ("nm-bench-keyfile-XXXXXX", &error);
+	g_assert_no_error (error);
+
+	filenames = g_new0 (char *, n + 1);
+	for (i = 0; i < n; i++) {
+		char uuid[37];
+		gs_free char *contents = NULL;
+		char *filename;
+
+		nm_sprintf_buf (uuid, "%08x-0000-4000-8000-%012x", i, i);
+
+		/* make every other profile a bit more involved, so that not only
+		 * the trivial path of the parser is exercised. */
+		contents = g_strdup_printf ("[connection]\n"
+		                            "id=bench-%u\n"
+		                            "uuid=%s\n"
+		                            "type=ethernet\n"
+		                            "interface-name=eth%u\n"
+		                            "autoconnect=false\n"
+		                            "\n"
+		                            "[ethernet]\n"
+		                            "mac-address=02:00:00:%02X:%02X:%02X\n"
+		                            "\n"
+		                            "[ipv4]\n"
+		                            "%s"
+		                            "\n"
+		                            "[ipv6]\n"
+		                            "method=ignore\n",
+		                            i,
+		                            uuid,
+		                            i % 64,
+		                            (i >> 16) & 0xFF,
+		                            (i >> 8) & 0xFF,
+		                            i & 0xFF,
+		                            (i % 2)
+		                              ? "method=auto\n"
+		                              : "method=manual\n"
+		                                "address1=192.168.1.5/24,192.168.1.1\n"
+		                                "address2=10.0.0.5/8\n"
+		                                "dns=8.8.8.8;1.1.1.1;\n"
+		                                "route1=10.1.0.0/16,192.168.1.1,100\n");
+
+		filename = g_strdup_printf ("%s/bench-%u.nmconnection", dirname, i);
+		if (!g_file_set_contents (filename, contents, -1, &error))
+			g_error ("failure to write %s: %s", filename, error->message);
+		if (chmod (filename, 0600) != 0)
+			g_error ("failure to chmod %s", filename);
+		filenames[i] = filename;
+	}
+
+	*out_filenames = filenames;
+	return dirname;
+}
+
+static void
+_remove_profiles (const char *dirname, char **filenames)
+{
+	guint i;
+
+	for (i = 0; filenames[i]; i++)
+		unlink (filenames[i]);
+	rmdir (dirname);
+}
+
+static void
+bench_load (const char *name, char **filenames, guint n, guint max_threads)
+{
+	gs_free NMSKeyfileReaderFileData *file_datas = NULL;
+	gint64 ns;
+	guint n_failed = 0;
+	guint i;
+
+	file_datas = g_new0 (NMSKeyfileReaderFileData, n);
+	for (i = 0; i < n; i++)
+		file_datas[i].full_filename = filenames[i];
+
+	ns = nm_utils_clock_gettime_ns (CLOCK_MONOTONIC);
+	nms_keyfile_reader_from_files (file_datas, n, "/etc/NetworkManager/system-connections", max_threads);
+	ns = nm_utils_clock_gettime_ns (CLOCK_MONOTONIC) - ns;
+
+	for (i = 0; i < n; i++) {
+		if (!file_datas[i].connection)
+			n_failed++;
+		nms_keyfile_reader_file_data_clear (&file_datas[i]);
+	}
+
+	g_print ("%-32s %8u files %10.3f ms %10.1f us/file %6u failed\n",
+	         name,
+	         n,
+	         ns / 1000000.0,
+	         n > 0 ? (ns / 1000.0) / n : 0.0,
+	         n_failed);
+	g_assert_cmpint (n_failed, ==, 0);
+}
+
+static void
+bench_load_cache (const char *name, const char *cache_filename, char **filenames, guint n, guint max_threads)
+{
+	nm_auto_free_sett_util_profile_cache NMSettUtilProfileCache *cache = NULL;
+	gs_free NMSKeyfileReaderFileData *file_datas = NULL;
+	gint64 ns;
+	guint n_failed = 0;
+	guint n_cached = 0;
+	guint i;
+
+	file_datas = g_new0 (NMSKeyfileReaderFileData, n);
+	for (i = 0; i < n; i++)
+		file_datas[i].full_filename = filenames[i];
+
+	ns = nm_utils_clock_gettime_ns (CLOCK_MONOTONIC);
+
+	cache = nm_sett_util_profile_cache_load (cache_filename, "bench");
+	for (i = 0; i < n; i++) {
+		NMSKeyfileReaderFileData *file_data = &file_datas[i];
+
+		if (stat (file_data->full_filename, &file_data->st) != 0)
+			g_error ("failure to stat %s", file_data->full_filename);
+		file_data->cache_entry = nm_sett_util_profile_cache_lookup_entry (cache, file_data->full_filename, &file_data->st);
+		file_data->cache_add = TRUE;
+	}
+
+	nms_keyfile_reader_from_files (file_datas, n, "/etc/NetworkManager/system-connections", max_threads);
+
+	for (i = 0; i < n; i++) {
+		NMSKeyfileReaderFileData *file_data = &file_datas[i];
+
+		if (file_data->from_cache) {
+			nm_sett_util_profile_cache_keep_entry (cache, file_data->cache_entry);
+			n_cached++;
+		} else if (file_data->cache_entry_new)
+			nm_sett_util_profile_cache_add_entry (cache, g_steal_pointer (&file_data->cache_entry_new));
+	}
+	nm_sett_util_profile_cache_save (cache);
+
+	ns = nm_utils_clock_gettime_ns (CLOCK_MONOTONIC) - ns;
+
+	for (i = 0; i < n; i++) {
+		if (!file_datas[i].connection)
+			n_failed++;
+		nms_keyfile_reader_file_data_clear (&file_datas[i]);
+	}
+
+	g_print ("%-32s %8u files %10.3f ms %10.1f us/file %6u failed %8u cached\n",
+	         name,
+	         n,
+	         ns / 1000000.0,
+	         n > 0 ? (ns / 1000.0) / n : 0.0,
+	         n_failed,
+	         n_cached);
+	g_assert_cmpint (n_failed, ==, 0);
+}
+
+/*****************************************************************************/
+
+static gboolean
+read_argv (int *argc, char ***argv)
+{
+	GOptionContext *context;
+	GOptionEntry options[] = {
+		{ "files", 'f', 0, G_OPTION_ARG_INT, &global_opt.files, "Number of keyfiles (default: 10000)", "N" },
+		{ "threads", 't', 0, G_OPTION_ARG_INT, &global_opt.threads, "Number of worker threads (default: 0, for automatic)", "N" },
+		{ 0 },
+	};
+	gs_free_error GError *error = NULL;
+
+	context = g_option_context_new (NULL);
+	g_option_context_set_summary (context, "Benchmark loading keyfile profiles.");
+	g_option_context_add_main_entries (context, options, NULL);
+
+	if (!g_option_context_parse (context, argc, argv, &error)) {
+		g_warning ("Error parsing command line arguments: %s", error->message);
+		g_option_context_free (context);
+		return FALSE;
+	}
+
+	g_option_context_free (context);
+	return TRUE;
+}
+
+int
+main (int argc, char **argv)
+{
+	gs_strfreev char **filenames = NULL;
+	gs_free char *dirname = NULL;
+	gs_free char *cache_filename = NULL;
+	guint n;
+
+	nmtst_init_with_logging (&argc, &argv, "WARN", "ALL");
+
+	if (!read_argv (&argc, &argv))
+		return 2;
+
+	_nm_utils_set_testing (NM_UTILS_TEST_NO_KEYFILE_OWNER_CHECK);
+
+	n = NM_MAX (global_opt.files, 0);
+	dirname = _write_profiles (n, &filenames);
+
+	/* the first run also pays for initializing the GType classes of the
+	 * settings. Do a warm-up round, so that both runs are comparable. */
+	bench_load ("keyfile: warm-up", filenames, NM_MIN (n, 100u), 1);
+
+	bench_load ("keyfile: load (serial)", filenames, n, 1);
+	bench_load ("keyfile: load (parallel)", filenames, n, NM_MAX (global_opt.threads, 0));
+
+	cache_filename = g_build_filename (dirname, "profile-cache", NULL);
+	bench_load_cache ("keyfile: load (empty cache)", cache_filename, filenames, n, NM_MAX (global_opt.threads, 0));
+	bench_load_cache ("keyfile: load (written cache)", cache_filename, filenames, n, NM_MAX (global_opt.threads, 0));
+	unlink (cache_filename);
+
+	_remove_profiles (dirname, filenames);
+	return EXIT_SUCCESS;
+}
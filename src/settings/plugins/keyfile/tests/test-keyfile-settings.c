@@ -18,6 +18,7 @@
 #include "settings/plugins/keyfile/nms-keyfile-reader.h"
 #include "settings/plugins/keyfile/nms-keyfile-writer.h"
 #include "settings/plugins/keyfile/nms-keyfile-utils.h"
+#include "settings/nm-settings-utils.h"
 
 #include "nm-test-utils-core.h"
 
@@ -2599,6 +2600,123 @@ test_nmmeta (void)
 
 /*****************************************************************************/
 
+static void
+test_profile_cache (void)
+{
+	const char *const cache_filename = TEST_SCRATCH_DIR"/profile-cache";
+	const char *const filename = TEST_KEYFILES_DIR"/Test_Wired_Connection_IP6";
+	gs_unref_object NMConnection *connection = NULL;
+	gs_unref_object NMConnection *connection2 = NULL;
+	gs_unref_variant GVariant *plugin_data = NULL;
+	NMSettUtilProfileCache *cache;
+	struct stat st;
+	struct stat st2;
+
+	(void) unlink (cache_filename);
+
+	connection = nms_keyfile_reader_from_file (filename, NULL, &st, NULL, NULL, NULL, NULL, NULL);
+	g_assert (connection);
+
+	cache = nm_sett_util_profile_cache_load (cache_filename, "key1");
+	g_assert (!nm_sett_util_profile_cache_lookup (cache, filename, &st, NULL));
+	nm_sett_util_profile_cache_add (cache, filename, &st, connection, g_variant_new_string ("data"));
+	nm_sett_util_profile_cache_save (cache);
+	nm_sett_util_profile_cache_free (cache);
+
+	g_assert (g_file_test (cache_filename, G_FILE_TEST_IS_REGULAR));
+
+	cache = nm_sett_util_profile_cache_load (cache_filename, "key1");
+	connection2 = nm_sett_util_profile_cache_lookup (cache, filename, &st, &plugin_data);
+	nmtst_assert_connection_equals (connection, FALSE, connection2, FALSE);
+	g_assert_cmpstr (g_variant_get_string (plugin_data, NULL), ==, "data");
+
+	/* a modified file is not taken from the cache. */
+	st2 = st;
+	st2.st_mtim.tv_nsec = (st2.st_mtim.tv_nsec + 1) % NM_UTILS_NS_PER_SECOND;
+	g_assert (!nm_sett_util_profile_cache_lookup (cache, filename, &st2, NULL));
+	st2 = st;
+	st2.st_size++;
+	g_assert (!nm_sett_util_profile_cache_lookup (cache, filename, &st2, NULL));
+	nm_sett_util_profile_cache_free (cache);
+
+	/* a different key invalidates the entire cache. */
+	cache = nm_sett_util_profile_cache_load (cache_filename, "key2");
+	g_assert (!nm_sett_util_profile_cache_lookup (cache, filename, &st, NULL));
+	nm_sett_util_profile_cache_free (cache);
+
+	/* profiles with secrets are not cached. */
+	g_clear_object (&connection);
+	connection = nms_keyfile_reader_from_file (TEST_KEYFILES_DIR"/Test_New_Wireless_Group_Names", NULL, &st, NULL, NULL, NULL, NULL, NULL);
+	g_assert (connection);
+	g_assert (!nm_sett_util_profile_cache_entry_new (TEST_KEYFILES_DIR"/Test_New_Wireless_Group_Names", &st, connection, g_variant_new_string ("data")));
+
+	(void) unlink (cache_filename);
+}
+
+static void
+test_read_from_files_parallel (void)
+{
+	const char *const dirname = TEST_SCRATCH_DIR"/parallel";
+	const guint N = 64;
+	gs_strfreev char **filenames = NULL;
+	gs_free NMSKeyfileReaderFileData *serial = NULL;
+	gs_free NMSKeyfileReaderFileData *parallel = NULL;
+	guint i;
+
+	/* enough files so that the worker pool is used. */
+	g_assert (g_mkdir_with_parents (dirname, 0755) == 0);
+
+	filenames = g_new0 (char *, N + 1);
+	for (i = 0; i < N; i++) {
+		gs_free char *contents = NULL;
+
+		contents = g_strdup_printf ("[connection]\n"
+		                            "id=parallel-%u\n"
+		                            "uuid=%08x-0000-4000-8000-%012x\n"
+		                            "type=ethernet\n"
+		                            "interface-name=eth%u\n"
+		                            "\n"
+		                            "[ipv4]\n"
+		                            "method=manual\n"
+		                            "address1=192.168.%u.5/24\n"
+		                            "\n"
+		                            "[ipv6]\n"
+		                            "method=ignore\n",
+		                            i, i, i, i, i);
+		filenames[i] = g_strdup_printf ("%s/parallel-%u.nmconnection", dirname, i);
+		nmtst_file_set_contents (filenames[i], contents);
+		g_assert (chmod (filenames[i], 0600) == 0);
+	}
+
+	serial = g_new0 (NMSKeyfileReaderFileData, N);
+	parallel = g_new0 (NMSKeyfileReaderFileData, N);
+	for (i = 0; i < N; i++) {
+		serial[i].full_filename = filenames[i];
+		parallel[i].full_filename = filenames[i];
+	}
+
+	nms_keyfile_reader_from_files (serial, N, dirname, 1);
+	nms_keyfile_reader_from_files (parallel, N, dirname, 4);
+
+	for (i = 0; i < N; i++) {
+		g_assert_no_error (serial[i].error);
+		g_assert_no_error (parallel[i].error);
+		g_assert (serial[i].connection);
+		nmtst_assert_connection_equals (serial[i].connection, FALSE, parallel[i].connection, FALSE);
+		g_assert_cmpint (serial[i].st.st_ino, ==, parallel[i].st.st_ino);
+		g_assert_cmpint (serial[i].is_nm_generated, ==, parallel[i].is_nm_generated);
+		g_assert_cmpint (serial[i].is_volatile, ==, parallel[i].is_volatile);
+		g_assert_cmpstr (serial[i].shadowed_storage, ==, parallel[i].shadowed_storage);
+		g_assert_cmpint (serial[i].shadowed_owned, ==, parallel[i].shadowed_owned);
+		nms_keyfile_reader_file_data_clear (&serial[i]);
+		nms_keyfile_reader_file_data_clear (&parallel[i]);
+		(void) unlink (filenames[i]);
+	}
+	(void) rmdir (dirname);
+}
+
+/*****************************************************************************/
+
 NMTST_DEFINE ();
 
 int main (int argc, char **argv)
@@ -2687,6 +2805,8 @@ int main (int argc, char **argv)
 	g_test_add_func ("/keyfile/test_nm_keyfile_plugin_utils_escape_filename", test_nm_keyfile_plugin_utils_escape_filename);
 
 	g_test_add_func ("/keyfile/test_nmmeta", test_nmmeta);
+	g_test_add_func ("/keyfile/test_profile_cache", test_profile_cache);
+	g_test_add_func ("/keyfile/test_read_from_files_parallel", test_read_from_files_parallel);
 
 	return g_test_run ();
 }
@@ -0,0 +1,171 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Copyright (C) 2019 Red Hat, Inc.
+ */
+
+#include "nm-default.h"
+
+#include "nm-core-internal.h"
+
+#include "nm-core-utils.h"
+#include "settings/nm-settings-utils.h"
+
+#include "nm-test-utils-core.h"
+
+/*****************************************************************************/
+
+typedef struct {
+	NMConnection *connection;
+} Item;
+
+static void
+_item_set (Item *item,
+           const char *type,
+           const char *ifname,
+           gboolean autoconnect,
+           int autoconnect_priority)
+{
+	NMSettingConnection *s_con;
+	gs_free char *uuid = NULL;
+
+	if (item->connection)
+		uuid = g_strdup (nm_connection_get_uuid (item->connection));
+	g_clear_object (&item->connection);
+
+	item->connection = nmtst_create_minimal_connection ("test", uuid, type, &s_con);
+	g_object_set (s_con,
+	              NM_SETTING_CONNECTION_INTERFACE_NAME, ifname,
+	              NM_SETTING_CONNECTION_AUTOCONNECT, autoconnect,
+	              NM_SETTING_CONNECTION_AUTOCONNECT_PRIORITY, autoconnect_priority,
+	              NULL);
+}
+
+static int
+_item_cmp (gconstpointer pa, gconstpointer pb, gpointer user_data)
+{
+	const Item *a = *((const Item *const*) pa);
+	const Item *b = *((const Item *const*) pb);
+
+	NM_CMP_RETURN (nm_utils_cmp_connection_by_autoconnect_priority (a->connection, b->connection));
+	NM_CMP_DIRECT_STRCMP (nm_connection_get_uuid (a->connection), nm_connection_get_uuid (b->connection));
+	return 0;
+}
+
+static void
+_idx_update (NMSettUtilAutoconnectIdx *idx, Item *item)
+{
+	nm_sett_util_autoconnect_idx_update (idx, item, item->connection);
+}
+
+#define _assert_candidates(idx, connection_type, ifname, ...) \
+	G_STMT_START { \
+		Item *const _expected[] = { __VA_ARGS__ }; \
+		gs_free gpointer *_list = NULL; \
+		guint _len; \
+		guint _i; \
+		\
+		_list = nm_sett_util_autoconnect_idx_get_candidates ((idx), (connection_type), (ifname), _item_cmp, NULL, 1, &_len); \
+		g_assert (_list); \
+		g_assert_cmpint (_len, ==, G_N_ELEMENTS (_expected) - 1); \
+		for (_i = 0; _i < _len; _i++) \
+			g_assert (_list[_i] == _expected[_i]); \
+		g_assert (!_list[_len]); \
+	} G_STMT_END
+
+static void
+test_autoconnect_idx (void)
+{
+	Item a_s = { }, b_s = { }, c_s = { }, d_s = { }, e_s = { };
+	Item *const a = &a_s, *const b = &b_s, *const c = &c_s, *const d = &d_s, *const e = &e_s;
+	NMSettUtilAutoconnectIdx idx;
+
+	_item_set (a, NM_SETTING_WIRED_SETTING_NAME,    NULL,   TRUE,  0);
+	_item_set (b, NM_SETTING_WIRED_SETTING_NAME,    "eth0", TRUE,  10);
+	_item_set (c, NM_SETTING_WIRELESS_SETTING_NAME, NULL,   TRUE,  5);
+	_item_set (d, NM_SETTING_WIRED_SETTING_NAME,    "eth1", TRUE,  1);
+	_item_set (e, NM_SETTING_WIRED_SETTING_NAME,    NULL,   FALSE, 20);
+
+	nm_sett_util_autoconnect_idx_init (&idx);
+
+	_assert_candidates (&idx, NM_SETTING_WIRED_SETTING_NAME, "eth0", NULL);
+	_assert_candidates (&idx, NULL, "eth0", NULL);
+
+	_idx_update (&idx, a);
+	_idx_update (&idx, b);
+	_idx_update (&idx, c);
+	_idx_update (&idx, d);
+	_idx_update (&idx, e);
+
+	/* profiles without autoconnect are not indexed. Profiles restricted to
+	 * another interface are not candidates. */
+	_assert_candidates (&idx, NM_SETTING_WIRED_SETTING_NAME, "eth0", b, a, NULL);
+	_assert_candidates (&idx, NM_SETTING_WIRED_SETTING_NAME, "eth1", d, a, NULL);
+	_assert_candidates (&idx, NM_SETTING_WIRED_SETTING_NAME, "eth2", a, NULL);
+	_assert_candidates (&idx, NM_SETTING_WIRED_SETTING_NAME, NULL, a, NULL);
+	_assert_candidates (&idx, NM_SETTING_WIRELESS_SETTING_NAME, "eth0", c, NULL);
+	_assert_candidates (&idx, NULL, "eth0", b, c, a, NULL);
+	_assert_candidates (&idx, NULL, "eth1", c, d, a, NULL);
+	_assert_candidates (&idx, NULL, NULL, c, a, NULL);
+
+	/* updating the same profile again doesn't duplicate it. */
+	_idx_update (&idx, b);
+	_assert_candidates (&idx, NULL, "eth0", b, c, a, NULL);
+
+	/* change the type of a profile. */
+	_item_set (a, NM_SETTING_WIRELESS_SETTING_NAME, NULL, TRUE, 0);
+	_idx_update (&idx, a);
+	_assert_candidates (&idx, NM_SETTING_WIRED_SETTING_NAME, "eth0", b, NULL);
+	_assert_candidates (&idx, NM_SETTING_WIRELESS_SETTING_NAME, "eth0", c, a, NULL);
+	_assert_candidates (&idx, NULL, "eth0", b, c, a, NULL);
+
+	/* change the interface name and the priority of a profile. */
+	_item_set (d, NM_SETTING_WIRED_SETTING_NAME, "eth0", TRUE, 30);
+	_idx_update (&idx, d);
+	_assert_candidates (&idx, NM_SETTING_WIRED_SETTING_NAME, "eth0", d, b, NULL);
+	_assert_candidates (&idx, NM_SETTING_WIRED_SETTING_NAME, "eth1", NULL);
+	_assert_candidates (&idx, NULL, "eth1", c, a, NULL);
+
+	/* enable autoconnect. */
+	_item_set (e, NM_SETTING_WIRED_SETTING_NAME, NULL, TRUE, 20);
+	_idx_update (&idx, e);
+	_assert_candidates (&idx, NM_SETTING_WIRED_SETTING_NAME, "eth0", d, e, b, NULL);
+
+	/* disable autoconnect. */
+	_item_set (b, NM_SETTING_WIRED_SETTING_NAME, "eth0", FALSE, 10);
+	_idx_update (&idx, b);
+	_assert_candidates (&idx, NM_SETTING_WIRED_SETTING_NAME, "eth0", d, e, NULL);
+
+	/* remove profiles. */
+	nm_sett_util_autoconnect_idx_remove (&idx, d);
+	nm_sett_util_autoconnect_idx_remove (&idx, d);
+	_assert_candidates (&idx, NULL, "eth0", e, c, a, NULL);
+	nm_sett_util_autoconnect_idx_remove (&idx, a);
+	nm_sett_util_autoconnect_idx_remove (&idx, c);
+	nm_sett_util_autoconnect_idx_remove (&idx, e);
+	_assert_candidates (&idx, NULL, "eth0", NULL);
+	g_assert_cmpint (g_hash_table_size (idx.buckets), ==, 0);
+	g_assert_cmpint (g_hash_table_size (idx.by_ifname), ==, 0);
+	g_assert_cmpint (idx.no_ifname->len, ==, 0);
+
+	nm_sett_util_autoconnect_idx_clear (&idx);
+
+	g_clear_object (&a->connection);
+	g_clear_object (&b->connection);
+	g_clear_object (&c->connection);
+	g_clear_object (&d->connection);
+	g_clear_object (&e->connection);
+}
+
+/*****************************************************************************/
+
+NMTST_DEFINE ();
+
+int
+main (int argc, char **argv)
+{
+	nmtst_init_assert_logging (&argc, &argv, "INFO", "DEFAULT");
+
+	g_test_add_func ("/settings/autoconnect-idx", test_autoconnect_idx);
+
+	return g_test_run ();
+}
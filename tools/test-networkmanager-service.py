@@ -23,6 +23,7 @@ import uuid
 import hashlib
 import socket
 import collections
+import pwd
 
 ###############################################################################
 
@@ -391,6 +392,9 @@ class BusErr:
     class InvalidHostnameException(dbus.DBusException):
         _dbus_error_name = IFACE_SETTINGS + '.InvalidHostname'
 
+    class InvalidArgumentsException(dbus.DBusException):
+        _dbus_error_name = IFACE_SETTINGS + '.InvalidArguments'
+
     class NoSecretsException(dbus.DBusException):
         _dbus_error_name = IFACE_AGENT_MANAGER + '.NoSecrets'
 
@@ -1828,6 +1832,93 @@ class Settings(ExportedObj):
 
         return con_inst.path
 
+    @staticmethod
+    def _check_acl(con_hash, sender):
+        # Like nm_auth_is_subject_in_acl(): a profile with permissions is only
+        # visible to the users listed there.
+        s_con = con_hash.get(NM.SETTING_CONNECTION_SETTING_NAME, {})
+        permissions = s_con.get(NM.SETTING_CONNECTION_PERMISSIONS, [])
+        if not permissions:
+            return
+        user = pwd.getpwuid(gl.bus.get_unix_user(sender)).pw_name
+        if ('user:%s:' % (user)) not in permissions:
+            raise BusErr.PermissionDeniedException('user \'%s\' not in profile permissions' % (user))
+
+    @dbus.service.method(dbus_interface=IFACE_SETTINGS,
+                         in_signature='aa{sa{sv}}ua{sv}', out_signature='aoa{sv}',
+                         sender_keyword='sender')
+    def AddConnections(self, con_hashes, flags, args, sender=None):
+        if args:
+            raise BusErr.InvalidArgumentsException('Unsupported arguments')
+
+        # validate all profiles before adding any of them.
+        for i, con_hash in enumerate(con_hashes):
+            try:
+                NmUtil.con_hash_verify(con_hash)
+                self._check_acl(con_hash, sender)
+            except dbus.DBusException as e:
+                raise dbus.DBusException('profile #%d: %s' % (i, e.get_dbus_message()), name = e.get_dbus_name())
+
+        # the batch is all-or-nothing. Delete again what we added so far.
+        paths = []
+        try:
+            for con_hash in con_hashes:
+                paths.append(self.add_connection(con_hash))
+        except dbus.DBusException as e:
+            for path in reversed(paths):
+                if path in self.connections:
+                    self.delete_connection(self.connections[path])
+            raise dbus.DBusException('failure to add profile #%d (%s): %s' % (len(paths),
+                                                                              NmUtil.con_hash_get_id(con_hashes[len(paths)]),
+                                                                              e.get_dbus_message()),
+                                     name = e.get_dbus_name())
+        return (paths, {})
+
+    @dbus.service.method(dbus_interface=IFACE_SETTINGS,
+                         in_signature='a(oa{sa{sv}})ua{sv}', out_signature='a{sv}',
+                         sender_keyword='sender')
+    def UpdateConnections(self, updates, flags, args, sender=None):
+        if args:
+            raise BusErr.InvalidArgumentsException('Unsupported arguments')
+
+        # validate all updates before modifying any profile. Like for Update2(),
+        # empty settings only change the persist mode, which we don't have.
+        seen = set()
+        for i, (path, con_hash) in enumerate(updates):
+            try:
+                if path not in self.connections:
+                    raise BusErr.InvalidArgumentsException('unknown profile %s' % (path))
+                if path in seen:
+                    raise BusErr.InvalidArgumentsException('profile %s is updated more than once' % (path))
+                seen.add(path)
+                self._check_acl(self.connections[path].con_hash, sender)
+                if con_hash:
+                    NmUtil.con_hash_verify(con_hash)
+                    self._check_acl(con_hash, sender)
+            except dbus.DBusException as e:
+                raise dbus.DBusException('profile #%d: %s' % (i, e.get_dbus_message()), name = e.get_dbus_name())
+
+        # the batch is all-or-nothing. Restore the profiles that we already updated.
+        old_con_hashes = []
+        try:
+            for path, con_hash in updates:
+                con_inst = self.connections[path]
+                old_con_hash = con_inst.con_hash
+                if con_hash:
+                    con_inst.update_connection(con_hash, True)
+                old_con_hashes.append(old_con_hash)
+        except dbus.DBusException as e:
+            n_updated = len(old_con_hashes)
+            for i in reversed(range(n_updated)):
+                path = updates[i][0]
+                if path in self.connections and updates[i][1]:
+                    self.connections[path].update_connection(old_con_hashes[i], False)
+            raise dbus.DBusException('failure to update profile #%d (%s): %s' % (n_updated,
+                                                                                 self.connections[updates[n_updated][0]].get_id(),
+                                                                                 e.get_dbus_message()),
+                                     name = e.get_dbus_name())
+        return {}
+
     def update_connection(self, con_hash, path=None, do_verify_strict=True):
         if path not in self.connections:
             raise BusErr.UnknownConnectionException('Connection not found')